@@ -14,12 +14,19 @@ PYBIND11_MODULE(scsga, m) {
         .def_readwrite("seed", &problem_specification_t::seed)
         .def_readwrite("distribution", &problem_specification_t::distribution)
         .def_readwrite("distribution_file_name", &problem_specification_t::distribution_file_name)
+        .def_readwrite("value_cache_budget", &problem_specification_t::value_cache_budget)
+        .def_readwrite("value_table_layout", &problem_specification_t::value_table_layout)
+        .def_readwrite("value_generation", &problem_specification_t::value_generation)
+        .def_readwrite("value_generation_threads", &problem_specification_t::value_generation_threads)
+        .def_readwrite("value_table_directory", &problem_specification_t::value_table_directory)
         .def(py::pickle(
             [](const problem_specification_t& spec) {
-                return py::make_tuple(spec.n_agents, spec.n_tasks, spec.seed, spec.distribution, spec.distribution_file_name);
+                return py::make_tuple(spec.n_agents, spec.n_tasks, spec.seed, spec.distribution, spec.distribution_file_name,
+                    spec.value_cache_budget, spec.value_table_layout, spec.value_generation, spec.value_generation_threads,
+                    spec.value_table_directory);
             },
             [](py::tuple t) {
-                if (t.size() != 5) {
+                if (t.size() < 5 || t.size() > 10) {
                     throw std::runtime_error("Invalid state");
                 }
                 problem_specification_t spec{};
@@ -28,6 +35,19 @@ PYBIND11_MODULE(scsga, m) {
                 spec.seed = t[2].cast<int>();
                 spec.distribution = t[3].cast<problem_specification_t::distribution_t>();
                 spec.distribution_file_name = t[4].cast<std::string>();
+                if (t.size() >= 6) {
+                    spec.value_cache_budget = t[5].cast<uint64_t>();
+                }
+                if (t.size() >= 7) {
+                    spec.value_table_layout = t[6].cast<value_table_layout_t>();
+                }
+                if (t.size() >= 9) {
+                    spec.value_generation = t[7].cast<value_generation_t>();
+                    spec.value_generation_threads = t[8].cast<uint32_t>();
+                }
+                if (t.size() >= 10) {
+                    spec.value_table_directory = t[9].cast<std::string>();
+                }
                 return spec;
             }
         ));
@@ -44,6 +64,12 @@ PYBIND11_MODULE(scsga, m) {
         .value("SUPD", problem_specification_t::distribution_t::SUPD)
         .value("TRAP", problem_specification_t::distribution_t::trap)
         .value("UPD", problem_specification_t::distribution_t::UPD);
+    py::enum_<value_table_layout_t>(m, "value_table_layout_t")
+        .value("TASK_MAJOR", value_table_layout_t::TASK_MAJOR)
+        .value("COALITION_MAJOR", value_table_layout_t::COALITION_MAJOR);
+    py::enum_<value_generation_t>(m, "value_generation_t")
+        .value("SEQUENTIAL", value_generation_t::SEQUENTIAL)
+        .value("COUNTER_BASED", value_generation_t::COUNTER_BASED);
 
     py::class_<problem_t> prob(m, "problem_t");
     prob.def(py::init<problem_specification_t>());
@@ -52,24 +78,50 @@ PYBIND11_MODULE(scsga, m) {
         .def(py::init<float, uint32_t>())
         .def_readwrite("time_limit_sec", &benchmark_specification_t::time_limit_sec)
         .def_readwrite("iterations", &benchmark_specification_t::iterations)
+        .def_readwrite("checkpoints_sec", &benchmark_specification_t::checkpoints_sec)
         .def(py::pickle(
             [](const benchmark_specification_t& spec) {
-                return py::make_tuple(spec.time_limit_sec, spec.iterations);
+                return py::make_tuple(spec.time_limit_sec, spec.iterations, spec.checkpoints_sec);
             },
             [](py::tuple t) {
-                if (t.size() != 2) {
+                if (t.size() != 3) {
                     throw std::runtime_error("Invalid state.");
                 }
                 benchmark_specification_t spec{};
                 spec.time_limit_sec = t[0].cast<float>();
                 spec.iterations = t[1].cast<uint32_t>();
+                spec.checkpoints_sec = t[2].cast<std::vector<float>>();
                 return spec;
             }
         ));
 
+    py::class_<value_cache_statistics_t>(m, "value_cache_statistics_t")
+        .def_readonly("size", &value_cache_statistics_t::size)
+        .def_readonly("capacity", &value_cache_statistics_t::capacity)
+        .def_readonly("load_factor", &value_cache_statistics_t::load_factor)
+        .def_readonly("memory_usage", &value_cache_statistics_t::memory_usage)
+        .def_readonly("memory_budget", &value_cache_statistics_t::memory_budget)
+        .def_readonly("hits", &value_cache_statistics_t::hits)
+        .def_readonly("misses", &value_cache_statistics_t::misses)
+        .def_readonly("evictions", &value_cache_statistics_t::evictions)
+        .def_readonly("lookups", &value_cache_statistics_t::lookups)
+        .def_readonly("total_probe_length", &value_cache_statistics_t::total_probe_length)
+        .def_readonly("max_probe_length", &value_cache_statistics_t::max_probe_length)
+        .def_readonly("mean_probe_length", &value_cache_statistics_t::mean_probe_length);
+
+    py::class_<incumbent_t>(m, "incumbent_t")
+        .def_readonly("elapsed_time", &incumbent_t::elapsed_time)
+        .def_readonly("n_evaluations", &incumbent_t::n_evaluations)
+        .def_readonly("value", &incumbent_t::value);
+
     py::class_<benchmark_result_t>(m, "benchmark_result_t")
         .def_readwrite("solution_values", &benchmark_result_t::solution_values)
         .def_readwrite("times_taken", &benchmark_result_t::times_taken)
+        .def_readwrite("allocations_per_second", &benchmark_result_t::allocations_per_second)
+        .def_readwrite("cache_misses", &benchmark_result_t::cache_misses)
+        .def_readwrite("value_cache", &benchmark_result_t::value_cache)
+        .def_readwrite("checkpoint_values", &benchmark_result_t::checkpoint_values)
+        .def_readwrite("incumbents", &benchmark_result_t::incumbents)
         .def_readwrite("value_mean", &benchmark_result_t::value_mean)
         .def_readwrite("value_standard_error", &benchmark_result_t::value_standard_error)
         .def_readwrite("value_variance", &benchmark_result_t::value_variance)
@@ -77,8 +129,30 @@ PYBIND11_MODULE(scsga, m) {
         .def_readwrite("time_standard_error", &benchmark_result_t::time_standard_error)
         .def_readwrite("time_variance", &benchmark_result_t::time_variance);
 
+    py::enum_<utility::bits::subset_enumeration_t>(m, "subset_enumeration_t")
+        .value("SOFTWARE_PDEP", utility::bits::subset_enumeration_t::SOFTWARE_PDEP)
+        .value("PDEP", utility::bits::subset_enumeration_t::PDEP)
+        .value("SUBMASK", utility::bits::subset_enumeration_t::SUBMASK);
+
+    py::enum_<dp_memory_t>(m, "dp_memory_t")
+        .value("FULL", dp_memory_t::FULL)
+        .value("ROLLING", dp_memory_t::ROLLING)
+        .value("RECOMPUTE", dp_memory_t::RECOMPUTE)
+        .value("OUT_OF_CORE", dp_memory_t::OUT_OF_CORE);
+    py::enum_<max_plus_kernel_t>(m, "max_plus_kernel_t")
+        .value("SCALAR", max_plus_kernel_t::SCALAR)
+        .value("AVX2", max_plus_kernel_t::AVX2)
+        .value("AVX512", max_plus_kernel_t::AVX512);
+
     py::register_exception<BenchmarkError>(m, "BenchmarkError");
 
+    m.def("get_allocation_count", &get_allocation_count);
+    m.def("get_best_max_plus_kernel", &max_plus::get_best_kernel);
+    m.def("is_max_plus_kernel_supported", &max_plus::is_supported, "kernel"_a);
+    m.def("has_hardware_pdep", &utility::bits::has_hardware_parallel_bits_deposit);
+    m.def("convert_problem_file_to_binary", &coalitional_values_generator_file::convert_to_binary,
+        "text_file_name"_a, "binary_file_name"_a, "layout"_a = value_table_layout_t::TASK_MAJOR);
+
     m.def("run_mcts_benchmark", &run_mcts_benchmark, "problem"_a, "benchmark"_a,
         "exploration_weight"_a = -0.18, "variance_weight"_a = 0.33, "dnn_weight"_a = 1.0,
         "use_hillclimb"_a = false);
@@ -93,12 +167,20 @@ PYBIND11_MODULE(scsga, m) {
     m.def("run_local_evaluation", &run_local_evaluation, "problem"_a, "partial_agent_assignment"_a,
         "time_limit"_a = -1, "use_hillclimb"_a = true, "solver_seed"_a = -1);
     
-    m.def("run_mp_benchmark", &run_mp_benchmark, "problem"_a, "benchmark"_a, "greedy_init"_a = false);
+    m.def("run_mp_benchmark", &run_mp_benchmark, "problem"_a, "benchmark"_a, "greedy_init"_a = false, "n_threads"_a = 1);
     m.def("run_annealing_benchmark", &run_annealing_benchmark, "problem"_a, "benchmark"_a, "use_hillclimb"_a = false);
-    m.def("run_brute_benchmark", &run_brute_benchmark, "problem"_a, "benchmark"_a);
-    m.def("run_task_greedy_benchmark", &run_task_greedy_benchmark, "problem"_a, "benchmark"_a);
-    m.def("run_dp_benchmark", &run_dp_benchmark, "problem"_a, "benchmark"_a);
-    m.def("run_hybrid_benchmark", &run_hybrid_benchmark, "problem"_a, "benchmark"_a);
+    m.def("run_brute_benchmark", &run_brute_benchmark, "problem"_a, "benchmark"_a, "n_threads"_a = 1);
+    m.def("run_branch_and_bound_benchmark", &run_branch_and_bound_benchmark, "problem"_a, "benchmark"_a);
+    m.def("run_task_greedy_benchmark", &run_task_greedy_benchmark, "problem"_a, "benchmark"_a,
+        "subset_enumeration"_a = utility::bits::subset_enumeration_t::SUBMASK);
+    m.def("run_dp_benchmark", &run_dp_benchmark, "problem"_a, "benchmark"_a,
+        "subset_enumeration"_a = utility::bits::subset_enumeration_t::SUBMASK, "n_threads"_a = 1, "memory"_a = dp_memory_t::FULL,
+        "use_max_plus_kernel"_a = false, "max_plus_kernel"_a = max_plus::get_best_kernel(), "tile_bits"_a = 0, "out_of_core_directory"_a = "");
+    m.def("run_hybrid_benchmark", &run_hybrid_benchmark, "problem"_a, "benchmark"_a, "n_threads"_a = 1);
     m.def("run_genetic_benchmark", &run_genetic_benchmark, "problem"_a, "benchmark"_a);
     m.def("run_mcts_flat_benchmark", &run_mcts_flat_benchmark, "problem"_a, "benchmark"_a);
+    m.def("run_problem_loading_benchmark", &run_problem_loading_benchmark, "specification"_a, "benchmark"_a,
+        "read_all_values"_a = true);
+    m.def("run_dp_batch_benchmark", &run_dp_batch_benchmark, "specification"_a, "n_problems"_a, "benchmark"_a,
+        "batched"_a = true, "n_threads"_a = 1, "max_plus_kernel"_a = max_plus::get_best_kernel());
 }
\ No newline at end of file
@@ -1,5 +1,168 @@
 #include "benchmark.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef BENCHMARK_COUNT_ALLOCATIONS
+namespace
+{
+	std::atomic<uint64_t> allocation_count{ 0 };
+}
+
+/*
+	Replaces the global allocation functions so that heap allocations can be counted
+	during benchmarks. Array and nothrow versions forward to these by default.
+*/
+void* operator new(std::size_t size)
+{
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	if (void* memory = std::malloc(size > 0 ? size : 1))
+	{
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+uint64_t get_allocation_count()
+{
+	return allocation_count.load(std::memory_order_relaxed);
+}
+#else
+uint64_t get_allocation_count()
+{
+	return 0;
+}
+#endif
+
+namespace
+{
+	// Incumbents reserved before timing benchmarks with checkpoints, about 1.5 MB. Solvers report far fewer per solve.
+	constexpr size_t INCUMBENTS_TO_RESERVE{ 1 << 16 };
+
+	/*
+		Counts the cache misses of the process, including threads started while counting,
+		with the hardware performance counters of Linux. The count is -1 where these are
+		unavailable, e.g. on other systems, in virtual machines without a virtual PMU or
+		when perf_event_paranoid forbids it.
+	*/
+	class cache_miss_counter
+	{
+	public:
+		cache_miss_counter()
+		{
+#ifdef __linux__
+			perf_event_attr attributes{};
+			attributes.size = sizeof(attributes);
+			attributes.type = PERF_TYPE_HARDWARE;
+			attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+			attributes.disabled = 1;
+			attributes.inherit = 1;
+			attributes.exclude_kernel = 1;
+			attributes.exclude_hv = 1;
+			file_descriptor = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#endif
+		}
+
+		~cache_miss_counter()
+		{
+#ifdef __linux__
+			if (file_descriptor >= 0)
+			{
+				close(file_descriptor);
+			}
+#endif
+		}
+
+		cache_miss_counter(const cache_miss_counter&) = delete;
+		cache_miss_counter& operator=(const cache_miss_counter&) = delete;
+
+		void start()
+		{
+#ifdef __linux__
+			if (file_descriptor >= 0)
+			{
+				ioctl(file_descriptor, PERF_EVENT_IOC_RESET, 0);
+				ioctl(file_descriptor, PERF_EVENT_IOC_ENABLE, 0);
+			}
+#endif
+		}
+
+		// The misses since start, or -1 if they cannot be counted.
+		int64_t stop()
+		{
+#ifdef __linux__
+			uint64_t count{};
+			if (file_descriptor >= 0)
+			{
+				ioctl(file_descriptor, PERF_EVENT_IOC_DISABLE, 0);
+				if (read(file_descriptor, &count, sizeof(count)) == sizeof(count))
+				{
+					return static_cast<int64_t>(count);
+				}
+			}
+#endif
+			return -1;
+		}
+
+	private:
+		int file_descriptor{ -1 };
+	};
+
+	/*
+		Returns the best value found by each checkpoint, or NaN if none was found by then. The
+		solution that the solver returned after elapsed_time seconds is the best one found by the
+		time limit, and its value replaces those of the incumbents, which may be accumulated
+		incrementally by the solver.
+	*/
+	std::vector<coalition::value_t> sample_checkpoints(
+		const std::vector<incumbent_t>& incumbents,
+		const coalition::value_t final_value,
+		const double elapsed_time,
+		const std::vector<float>& checkpoints_sec
+	)
+	{
+		const double time_limit{ *std::max_element(checkpoints_sec.begin(), checkpoints_sec.end()) };
+		const double final_time{ std::min(elapsed_time, time_limit) };
+		std::vector<coalition::value_t> values(checkpoints_sec.size(), std::numeric_limits<coalition::value_t>::quiet_NaN());
+		for (size_t checkpoint{}; checkpoint < checkpoints_sec.size(); ++checkpoint)
+		{
+			if (final_time <= checkpoints_sec[checkpoint])
+			{
+				values[checkpoint] = final_value;
+				continue;
+			}
+			for (const incumbent_t& incumbent : incumbents)
+			{
+				if (incumbent.elapsed_time <= checkpoints_sec[checkpoint] && !(incumbent.value <= values[checkpoint]))
+				{
+					values[checkpoint] = incumbent.value;
+				}
+			}
+		}
+		return values;
+	}
+}
+
 /*
 	Performs some basic checks that the solution is valid. Throws BenchmarkError
 	if these checks failed.
@@ -72,7 +235,8 @@ void assert_valid(
 						the benchmark specification. The same solver is used for all
 						benchmarks, i.e. no re-seeding or similar is performed before
 						or between benchmarks. The solver is not deallocated by this
-						function.
+						function. With checkpoints, its incumbent observer is used
+						during the benchmark and cleared afterwards.
 
 	returns				A vector of benchmark results.
 	throws				BenchmarkError if an error occurred during benchmark.
@@ -91,23 +255,49 @@ benchmark_result_t run_benchmark_with_solver(
 
 	std::vector<coalition::value_t> solution_values;
 
-	solver->set_time_limit(benchmark.time_limit_sec);
+	const bool has_checkpoints{ !benchmark.checkpoints_sec.empty() };
+	std::vector<incumbent_t> incumbents;
+	if (has_checkpoints)
+	{
+		solver->set_time_limit(*std::max_element(benchmark.checkpoints_sec.begin(), benchmark.checkpoints_sec.end()));
+		// Reserved here, so that the observer neither allocates nor copies while solves are timed and their allocations counted.
+		incumbents.reserve(INCUMBENTS_TO_RESERVE);
+		solver->set_incumbent_observer([&incumbents](const incumbent_t& incumbent) { incumbents.push_back(incumbent); });
+	}
+	else
+	{
+		solver->set_time_limit(benchmark.time_limit_sec);
+	}
+	cache_miss_counter cache_misses{};
 
 	for (uint32_t iteration{}; iteration < benchmark.iterations; ++iteration)
 	{
 		utility::date_and_time::timer timer{};
+		incumbents.clear();
+		const uint64_t allocations_before{ get_allocation_count() };
+		cache_misses.start();
 		timer.start();
 		instance_solution solution = solver->solve(problem.generator);
 		const float elapsed_time{ timer.stop() };
+		result.cache_misses.push_back(cache_misses.stop());
+		const uint64_t allocations{ get_allocation_count() - allocations_before };
 
 		solution.recalculate_value(problem.generator);
 		assert_valid(solution, problem);
 
 		result.times_taken.push_back(elapsed_time);
 		result.solution_values.push_back(solution.value);
+		result.allocations_per_second.push_back(elapsed_time > 0 ? allocations / elapsed_time : 0.0f);
+		if (has_checkpoints)
+		{
+			result.checkpoint_values.push_back(sample_checkpoints(incumbents, solution.value, elapsed_time, benchmark.checkpoints_sec));
+			result.incumbents.push_back(incumbents);
+		}
 	}
+	solver->set_incumbent_observer(nullptr);
 
 	result.calculate_statistics();
+	result.value_cache = problem.generator->get_value_cache_statistics();
 
 	double total_time = 0.0;
 	for (auto f : result.times_taken)
@@ -207,17 +397,22 @@ benchmark_result_t run_random_search_benchmark(
 benchmark_result_t run_mp_benchmark(
 	problem_t& problem,
 	const benchmark_specification_t benchmark,
-	const bool greedy_init
+	const bool greedy_init,
+	const uint32_t n_threads
 )
 {
 	solver* solver{ };
 	if (greedy_init)
 	{
-		solver = new solver_mp_AGI();
+		solver_mp_AGI* mp_solver{ new solver_mp_AGI() };
+		mp_solver->_nThreads = n_threads;
+		solver = mp_solver;
 	}
 	else
 	{
-		solver = new solver_mp_anytime();
+		solver_mp_anytime* mp_solver{ new solver_mp_anytime() };
+		mp_solver->_nThreads = n_threads;
+		solver = mp_solver;
 	}
 	
 	benchmark_result_t result{
@@ -229,10 +424,12 @@ benchmark_result_t run_mp_benchmark(
 
 benchmark_result_t run_brute_benchmark(
 	problem_t& problem,
-	const benchmark_specification_t benchmark
+	const benchmark_specification_t benchmark,
+	const uint32_t n_threads
 )
 {
 	solver_brute_force* solver{ new solver_brute_force() };
+	solver->_nThreads = n_threads;
 	benchmark_result_t result{
 		run_benchmark_with_solver(problem, benchmark, solver)
 	};
@@ -240,12 +437,27 @@ benchmark_result_t run_brute_benchmark(
 	return result;
 }
 
-benchmark_result_t run_task_greedy_benchmark(
+benchmark_result_t run_branch_and_bound_benchmark(
 	problem_t& problem,
 	const benchmark_specification_t benchmark
 )
+{
+	solver_branch_and_bound* solver{ new solver_branch_and_bound() };
+	benchmark_result_t result{
+		run_benchmark_with_solver(problem, benchmark, solver)
+	};
+	delete solver;
+	return result;
+}
+
+benchmark_result_t run_task_greedy_benchmark(
+	problem_t& problem,
+	const benchmark_specification_t benchmark,
+	const utility::bits::subset_enumeration_t subset_enumeration
+)
 {
 	solver_task_greed* solver{ new solver_task_greed() };
+	solver->_SubsetEnumeration = subset_enumeration;
 	benchmark_result_t result{
 		run_benchmark_with_solver(problem, benchmark, solver)
 	};
@@ -255,10 +467,24 @@ benchmark_result_t run_task_greedy_benchmark(
 
 benchmark_result_t run_dp_benchmark(
 	problem_t& problem,
-	const benchmark_specification_t benchmark
+	const benchmark_specification_t benchmark,
+	const utility::bits::subset_enumeration_t subset_enumeration,
+	const uint32_t n_threads,
+	const dp_memory_t memory,
+	const bool use_max_plus_kernel,
+	const max_plus_kernel_t max_plus_kernel,
+	const uint32_t tile_bits,
+	const std::string& out_of_core_directory
 )
 {
 	solver_dp* solver{ new solver_dp() };
+	solver->_SubsetEnumeration = subset_enumeration;
+	solver->_nThreads = n_threads;
+	solver->_MemoryMode = memory;
+	solver->_UseMaxPlusKernel = use_max_plus_kernel;
+	solver->_MaxPlusKernel = max_plus_kernel;
+	solver->_nTileBits = tile_bits;
+	solver->_OutOfCoreDirectory = out_of_core_directory;
 	benchmark_result_t result{
 		run_benchmark_with_solver(problem, benchmark, solver)
 	};
@@ -268,10 +494,12 @@ benchmark_result_t run_dp_benchmark(
 
 benchmark_result_t run_hybrid_benchmark(
 	problem_t& problem,
-	const benchmark_specification_t benchmark
+	const benchmark_specification_t benchmark,
+	const uint32_t n_threads
 )
 {
 	solver_mp_hybrid* solver{ new solver_mp_hybrid() };
+	solver->_nThreads = n_threads;
 	benchmark_result_t result{
 		run_benchmark_with_solver(problem, benchmark, solver)
 	};
@@ -305,6 +533,100 @@ benchmark_result_t run_mcts_flat_benchmark(
 	return result;
 }
 
+benchmark_result_t run_problem_loading_benchmark(
+	const problem_specification_t& specification,
+	const benchmark_specification_t benchmark,
+	const bool read_all_values
+)
+{
+	benchmark_result_t result{};
+	for (uint32_t iteration{}; iteration < benchmark.iterations; ++iteration)
+	{
+		utility::date_and_time::timer timer{};
+		const uint64_t allocations_before{ get_allocation_count() };
+		timer.start();
+		problem_t problem{ specification };
+		problem.allocate();
+		double value_sum{};
+		if (read_all_values)
+		{
+			const coalition_value_table& values{ problem.generator->get_data() };
+			for (uint64_t index{}; index < values.size(); ++index)
+			{
+				value_sum += values.data()[index];
+			}
+		}
+		const float elapsed_time{ timer.stop() };
+		const uint64_t allocations{ get_allocation_count() - allocations_before };
+
+		result.times_taken.push_back(elapsed_time);
+		result.solution_values.push_back(static_cast<coalition::value_t>(value_sum));
+		result.allocations_per_second.push_back(elapsed_time > 0 ? allocations / elapsed_time : 0.0f);
+	}
+	result.calculate_statistics();
+	return result;
+}
+
+benchmark_result_t run_dp_batch_benchmark(
+	const problem_specification_t& specification,
+	const uint32_t n_problems,
+	const benchmark_specification_t benchmark,
+	const bool batched,
+	const uint32_t n_threads,
+	const max_plus_kernel_t max_plus_kernel
+)
+{
+	std::vector<problem_t> problems;
+	std::vector<coalitional_values_generator*> generators;
+	problems.reserve(n_problems);
+	for (uint32_t n_problem{}; n_problem < n_problems; ++n_problem)
+	{
+		problem_specification_t problem_specification{ specification };
+		problem_specification.seed = specification.seed + static_cast<int>(n_problem);
+		problems.emplace_back(problem_specification);
+		problems.back().allocate();
+		generators.push_back(problems.back().generator);
+	}
+
+	solver_dp_batch batch_solver{};
+	batch_solver._nThreads = n_threads;
+	batch_solver._MaxPlusKernel = max_plus_kernel;
+	benchmark_result_t result{};
+	for (uint32_t iteration{}; iteration < benchmark.iterations; ++iteration)
+	{
+		utility::date_and_time::timer timer{};
+		const uint64_t allocations_before{ get_allocation_count() };
+		timer.start();
+		std::vector<instance_solution> solutions;
+		if (batched)
+		{
+			solutions = batch_solver.solve(generators);
+		}
+		else
+		{
+			for (coalitional_values_generator* generator : generators)
+			{
+				solver_dp solver{};
+				solutions.push_back(solver.solve(generator));
+			}
+		}
+		const float elapsed_time{ timer.stop() };
+		const uint64_t allocations{ get_allocation_count() - allocations_before };
+
+		double value_sum{};
+		for (uint32_t n_problem{}; n_problem < n_problems; ++n_problem)
+		{
+			assert_valid(solutions[n_problem], problems[n_problem]);
+			value_sum += solutions[n_problem].value;
+		}
+		result.times_taken.push_back(elapsed_time);
+		result.solution_values.push_back(n_problems > 0 ? static_cast<coalition::value_t>(value_sum / n_problems) : 0.0f);
+		result.allocations_per_second.push_back(elapsed_time > 0 ? allocations / elapsed_time : 0.0f);
+	}
+	result.calculate_statistics();
+	return result;
+}
+
 benchmark_result_t run_annealing_benchmark(
 	problem_t& problem,
 	const benchmark_specification_t benchmark,
@@ -19,6 +19,7 @@
 #include "../SCSGA/coalitional_values_generator.h"
 
 #include "../SCSGA/solver_brute_force.h"
+#include "../SCSGA/solver_branch_and_bound.h"
 #include "../SCSGA/solver_annealing.h"
 #include "../SCSGA/solver_mp_anytime.h"
 #include "../SCSGA/solver_agent_greed.h"
@@ -27,6 +28,7 @@
 #include "../SCSGA/solver_pure_random_search.h"
 #include "../SCSGA/solver_swap_random_search.h"
 #include "../SCSGA/solver_dp.h"
+#include "../SCSGA/solver_dp_batch.h"
 #include "../SCSGA/solver_mp_hybrid.h"
 #include "../SCSGA/solver_genetic.h"
 #include "../SCSGA/solver_mcts_flat.h"
@@ -40,11 +42,24 @@
 struct benchmark_specification_t {
 	float time_limit_sec;
 	uint32_t iterations;
+	/*
+		If not empty, time_limit_sec is ignored and every iteration runs until the largest
+		checkpoint instead, recording the best value found by each checkpoint. One run thus
+		samples the anytime curve at all of them, at the cost that solvers whose schedule
+		depends on the time limit, such as the temperature of simulated annealing, follow
+		the one of the largest checkpoint.
+	*/
+	std::vector<float> checkpoints_sec{};
 };
 
 struct benchmark_result_t {
 	std::vector<coalition::value_t> solution_values;
 	std::vector<float> times_taken;
+	std::vector<float> allocations_per_second; // Heap allocations per second and iteration. Only recorded when built with BENCHMARK_COUNT_ALLOCATIONS.
+	std::vector<int64_t> cache_misses; // Hardware cache misses of the solver per iteration, -1 where they cannot be counted.
+	value_cache_statistics_t value_cache; // Lazy value cache after the last iteration. Only used for problems with more than 32 agents.
+	std::vector<std::vector<coalition::value_t>> checkpoint_values; // [iteration][checkpoint], NaN before the first solution. Only recorded with checkpoints.
+	std::vector<std::vector<incumbent_t>> incumbents; // The incumbents reported by the solver in each iteration. Only recorded with checkpoints.
 	coalition::value_t value_mean, value_standard_error, value_variance;
 	float time_mean, time_standard_error, time_variance;
 
@@ -59,6 +74,12 @@ struct benchmark_result_t {
 	}
 };
 
+/*
+	Returns the number of heap allocations made by the library so far. Always
+	returns 0 unless it was built with BENCHMARK_COUNT_ALLOCATIONS defined.
+*/
+uint64_t get_allocation_count();
+
 class BenchmarkError : public std::exception
 {
 public:
@@ -160,7 +181,8 @@ benchmark_result_t run_random_search_benchmark(
 benchmark_result_t run_mp_benchmark(
 	problem_t& problem,
 	const benchmark_specification_t benchmark,
-	const bool greedy_init = false
+	const bool greedy_init = false,
+	const uint32_t n_threads = 1
 );
 benchmark_result_t run_annealing_benchmark(
 	problem_t& problem,
@@ -168,20 +190,45 @@ benchmark_result_t run_annealing_benchmark(
 	const bool use_hillclimb = false
 );
 benchmark_result_t run_brute_benchmark(
+	problem_t& problem,
+	const benchmark_specification_t benchmark,
+	const uint32_t n_threads = 1
+);
+/*
+	Runs a set of benchmarks using the branch and bound solver, which is exact unless it runs
+	out of time.
+
+	problem				The problem to benchmark on. Problems with more than 32 agents must
+						use a distribution that provides value bounds, e.g. NSD or NSRD.
+	benchmark			A benchmark specification.
+
+	returns				A vector of benchmark results.
+	throws				BenchmarkError if an error occured during the benchmark.
+*/
+benchmark_result_t run_branch_and_bound_benchmark(
 	problem_t& problem,
 	const benchmark_specification_t benchmark
 );
 benchmark_result_t run_task_greedy_benchmark(
 	problem_t& problem,
-	const benchmark_specification_t benchmark
+	const benchmark_specification_t benchmark,
+	const utility::bits::subset_enumeration_t subset_enumeration = utility::bits::subset_enumeration_t::SUBMASK
 );
 benchmark_result_t run_dp_benchmark(
 	problem_t& problem,
-	const benchmark_specification_t benchmark
+	const benchmark_specification_t benchmark,
+	const utility::bits::subset_enumeration_t subset_enumeration = utility::bits::subset_enumeration_t::SUBMASK,
+	const uint32_t n_threads = 1,
+	const dp_memory_t memory = dp_memory_t::FULL,
+	const bool use_max_plus_kernel = false,
+	const max_plus_kernel_t max_plus_kernel = max_plus::get_best_kernel(),
+	const uint32_t tile_bits = 0,
+	const std::string& out_of_core_directory = ""
 );
 benchmark_result_t run_hybrid_benchmark(
 	problem_t& problem,
-	const benchmark_specification_t benchmark
+	const benchmark_specification_t benchmark,
+	const uint32_t n_threads = 1
 );
 benchmark_result_t run_genetic_benchmark(
 	problem_t& problem,
@@ -192,6 +239,53 @@ benchmark_result_t run_mcts_flat_benchmark(
 	const benchmark_specification_t benchmark
 );
 
+/*
+	Measures how long it takes to load a problem, e.g. to compare text and binary
+	problem files. Every iteration constructs and allocates a new problem from the
+	specification.
+
+	specification		The problem to load.
+	benchmark			A benchmark specification. The time limit is not used.
+	read_all_values		True if every value should be read once after loading, which
+						includes paging in the values of memory-mapped problems in the
+						time taken. The sum of the values is recorded as the solution
+						value of the iteration.
+
+	returns				A vector of benchmark results.
+	throws				BenchmarkError if an error occured during the benchmark.
+*/
+benchmark_result_t run_problem_loading_benchmark(
+	const problem_specification_t& specification,
+	const benchmark_specification_t benchmark,
+	const bool read_all_values = true
+);
+
+/*
+	Measures the throughput of solving many small problems optimally, with the batched DP
+	solver or with the DP solver one problem at a time. The time taken divided by n_problems
+	is the time per solved problem.
+
+	specification		The problems to solve. Problem i uses the seed specification.seed + i,
+						and all problems are generated before the first iteration.
+	n_problems			The number of problems solved in every iteration.
+	benchmark			A benchmark specification. The time limit is not used.
+	batched				True to use solver_dp_batch, false to use solver_dp.
+	n_threads			Threads of the batched solver, 0 for one per hardware thread.
+	max_plus_kernel		Batch kernel of the batched solver.
+
+	returns				A vector of benchmark results, whose solution values are the mean
+						value of the solutions.
+	throws				BenchmarkError if an error occured during the benchmark.
+*/
+benchmark_result_t run_dp_batch_benchmark(
+	const problem_specification_t& specification,
+	const uint32_t n_problems,
+	const benchmark_specification_t benchmark,
+	const bool batched = true,
+	const uint32_t n_threads = 1,
+	const max_plus_kernel_t max_plus_kernel = max_plus::get_best_kernel()
+);
+
 /*
 	Evaluates a set of partial solutions using the agent greedy solver.
 
@@ -79,20 +79,84 @@ def get_distribution(desc):
     elif name == "upd":
         return ProblemSpecifiation.distribution_t.UPD
 
+def get_subset_enumeration(desc, prefix):
+    valid_enumerations = ["software_pdep", "pdep", "submask"]
+    name = desc.get(prefix + "subset_enumeration", "submask").lower()
+    if not name in valid_enumerations:
+        raise Exception(f"Invalid subset enumeration: {name}. Must be one of {', '.join(valid_enumerations)}")
+    if name == "software_pdep":
+        return scsga.subset_enumeration_t.SOFTWARE_PDEP
+    elif name == "pdep":
+        return scsga.subset_enumeration_t.PDEP
+    elif name == "submask":
+        return scsga.subset_enumeration_t.SUBMASK
+
+def get_value_table_layout(desc, prefix):
+    """The layout of an algorithm falls back on the layout of the experiment, which defaults to task major."""
+    valid_layouts = ["task_major", "coalition_major"]
+    name = desc.get(prefix + "value_table_layout", desc.get("value_table_layout", "task_major")).lower()
+    if not name in valid_layouts:
+        raise Exception(f"Invalid value table layout: {name}. Must be one of {', '.join(valid_layouts)}")
+    if name == "task_major":
+        return scsga.value_table_layout_t.TASK_MAJOR
+    elif name == "coalition_major":
+        return scsga.value_table_layout_t.COALITION_MAJOR
+
+def get_value_generation(desc):
+    valid_generations = ["sequential", "counter_based"]
+    name = desc.get("value_generation", "sequential").lower()
+    if not name in valid_generations:
+        raise Exception(f"Invalid value generation: {name}. Must be one of {', '.join(valid_generations)}")
+    if name == "sequential":
+        return scsga.value_generation_t.SEQUENTIAL
+    elif name == "counter_based":
+        return scsga.value_generation_t.COUNTER_BASED
+
+def get_dp_memory(desc, prefix):
+    valid_modes = ["full", "rolling", "recompute", "out_of_core"]
+    name = desc.get(prefix + "memory", "full").lower()
+    if not name in valid_modes:
+        raise Exception(f"Invalid DP memory mode: {name}. Must be one of {', '.join(valid_modes)}")
+    if name == "full":
+        return scsga.dp_memory_t.FULL
+    elif name == "rolling":
+        return scsga.dp_memory_t.ROLLING
+    elif name == "recompute":
+        return scsga.dp_memory_t.RECOMPUTE
+    elif name == "out_of_core":
+        return scsga.dp_memory_t.OUT_OF_CORE
+
+def get_max_plus_kernel(desc, prefix):
+    """Returns whether the DP uses a max-plus kernel and which one. "auto" picks the fastest kernel the CPU supports."""
+    valid_kernels = ["none", "auto", "scalar", "avx2", "avx512"]
+    name = desc.get(prefix + "max_plus_kernel", "none").lower()
+    if not name in valid_kernels:
+        raise Exception(f"Invalid max-plus kernel: {name}. Must be one of {', '.join(valid_kernels)}")
+    if name == "none":
+        return False, scsga.get_best_max_plus_kernel()
+    elif name == "auto":
+        return True, scsga.get_best_max_plus_kernel()
+    kernel = getattr(scsga.max_plus_kernel_t, name.upper())
+    if not scsga.is_max_plus_kernel_supported(kernel):
+        raise Exception(f"The max-plus kernel {name} is not supported by this CPU")
+    return True, kernel
+
 def ensure_directory_exists(directory_name):
     """Creates a directory if it doesn't already exist."""
     if not os.path.exists(directory_name):
         os.mkdir(directory_name)
 
 def setup_benchmark_function(desc, prefix):
-    valid_algorithms = ["brute_force", "mp", "agent_greedy", "task_greedy", "pure_random_search", "dp", "hybrid", "genetic", "mcts_flat", "spmcts", "annealing"]
+    valid_algorithms = ["brute_force", "mp", "agent_greedy", "task_greedy", "pure_random_search", "dp", "hybrid", "genetic", "mcts_flat", "spmcts", "annealing", "branch_and_bound"]
     assert_in(desc, prefix + "name", valid_algorithms)
     name = desc.get(prefix + "name").lower()
     if name == "brute_force":
-        function = scsga.run_brute_benchmark
+        solver_threads = desc.get(prefix + "solver_threads", 1)
+        function = lambda problem, benchmark : scsga.run_brute_benchmark(problem, benchmark, solver_threads)
     elif name == "mp":
         greedy_init = desc.get(prefix + "greedy_init", False)
-        function = lambda problem, benchmark : scsga.run_mp_benchmark(problem, benchmark, greedy_init)
+        solver_threads = desc.get(prefix + "solver_threads", 1)
+        function = lambda problem, benchmark : scsga.run_mp_benchmark(problem, benchmark, greedy_init, solver_threads)
     elif name == "agent_greedy":
         shuffle_agents = desc.get(prefix + "shuffle_agents", True)
         random_start = desc.get(prefix + "random_start", False)
@@ -100,15 +164,24 @@ def setup_benchmark_function(desc, prefix):
         solver_seed = desc.get(prefix + "solver_seed", -1)
         function = lambda problem, benchmark : scsga.run_agent_greedy_benchmark(problem, benchmark, shuffle_agents, random_start, use_hillclimb, solver_seed)
     elif name == "task_greedy":
-        function = scsga.run_task_greedy_benchmark
+        subset_enumeration = get_subset_enumeration(desc, prefix)
+        function = lambda problem, benchmark : scsga.run_task_greedy_benchmark(problem, benchmark, subset_enumeration)
     elif name == "pure_random_search":
         use_hillclimb = desc.get(prefix + "use_hillclimb", False)
         solver_seed = desc.get(prefix + "solver_seed", -1)
         function = lambda problem, benchmark : scsga.run_random_search_benchmark(problem, benchmark, use_hillclimb, solver_seed)
     elif name == "dp":
-        function = scsga.run_dp_benchmark
+        subset_enumeration = get_subset_enumeration(desc, prefix)
+        solver_threads = desc.get(prefix + "solver_threads", 1)
+        memory = get_dp_memory(desc, prefix)
+        use_max_plus_kernel, max_plus_kernel = get_max_plus_kernel(desc, prefix)
+        tile_bits = desc.get(prefix + "tile_bits", 0)
+        out_of_core_directory = desc.get(prefix + "out_of_core_directory", "")
+        function = lambda problem, benchmark : scsga.run_dp_benchmark(problem, benchmark, subset_enumeration, solver_threads, memory,
+            use_max_plus_kernel, max_plus_kernel, tile_bits, out_of_core_directory)
     elif name == "hybrid":
-        function = scsga.run_hybrid_benchmark
+        solver_threads = desc.get(prefix + "solver_threads", 1)
+        function = lambda problem, benchmark : scsga.run_hybrid_benchmark(problem, benchmark, solver_threads)
     elif name == "genetic":
         function = scsga.run_genetic_benchmark
     elif name == "mcts_flat":
@@ -121,12 +194,15 @@ def setup_benchmark_function(desc, prefix):
         function = lambda problem, benchmark : scsga.run_mcts_benchmark(problem, benchmark, exploration_weight, variance_weight, dnn_weight, use_hillclimb)
     elif name == "annealing":
         function = scsga.run_annealing_benchmark
+    elif name == "branch_and_bound":
+        function = scsga.run_branch_and_bound_benchmark
         
     return function
 
 def run(data):
     problem_specification, benchmark, algorithm_index, desc = data
     function = setup_benchmark_function(desc, f"algorithms/{algorithm_index}/")
+    problem_specification.value_table_layout = get_value_table_layout(desc, f"algorithms/{algorithm_index}/")
     problem = Problem(problem_specification)
     display_name = desc.get(f'algorithms/{algorithm_index}/display_name')
     
@@ -137,14 +213,18 @@ def run(data):
 
     result = function(problem, benchmark)
     
-    msg = "Solved n = {0:4d}, m = {1:4d}, seed = {2} using algorithm {3:>5}. Got result {4:5.2f} after {5:6.0f} ms." \
+    # Cache misses are -1 where the hardware counters are unavailable.
+    cache_misses = result.cache_misses[0]
+    msg = "Solved n = {0:4d}, m = {1:4d}, seed = {2} using algorithm {3:>5}. Got result {4:5.2f} after {5:6.0f} ms ({6} cache misses)." \
         .format(problem_specification.n_agents, problem_specification.n_tasks, problem_specification.seed,
-                display_name, result.solution_values[0], result.times_taken[0]*1000)
+                display_name, result.solution_values[0], result.times_taken[0]*1000,
+                cache_misses if cache_misses >= 0 else "unknown")
     logger.info(msg)
 
     del problem # They get quite large, delete ASAP
 
-    return (result.solution_values[0], result.times_taken[0])
+    checkpoint_values = list(result.checkpoint_values[0]) if result.checkpoint_values else []
+    return (result.solution_values[0], result.times_taken[0], cache_misses, checkpoint_values)
 
 def calculate_optimum(problem_specification):
     problem = Problem(problem_specification)
@@ -163,6 +243,8 @@ def run_benchmarks(desc):
     # Setup problem specifications
     problems = []
     distribution = get_distribution(desc)
+    value_generation = get_value_generation(desc)
+    value_table_directory = desc.get("value_table_directory", "")
     if desc.get("problem_file_names", []):
         for file_name in desc.get("problem_file_names"):
             specification = ProblemSpecifiation(0, 0, 0, distribution)
@@ -179,15 +261,27 @@ def run_benchmarks(desc):
                         seed = start_seed + iteration
                     specification = ProblemSpecifiation(n_agents, n_tasks, seed, distribution)
                     specification.distribution_file_name = ""
+                    specification.value_generation = value_generation
+                    specification.value_table_directory = value_table_directory
                     problems.append(specification)
 
-    # Setup benchmarks
-    benchmarks = [BenchmarkSpecification(time_limit, 1) for time_limit in desc.get("time_limits")]
+    # Setup benchmarks. Sampling the time limits from one run needs a single run until the largest
+    # one, rather than one run per time limit, but the schedules of solvers that depend on the time
+    # limit, such as the temperature of simulated annealing, follow the largest one.
+    time_limits = desc.get("time_limits")
+    sample_time_limits_from_one_run = desc.get("sample_time_limits_from_one_run", False)
+    if sample_time_limits_from_one_run:
+        benchmark = BenchmarkSpecification(max(time_limits), 1)
+        benchmark.checkpoints_sec = time_limits
+        benchmarks = [benchmark]
+    else:
+        benchmarks = [BenchmarkSpecification(time_limit, 1) for time_limit in time_limits]
 
     # Establish algorithm parameters
     n_algorithms = len(desc.get("algorithms"))
     for i in range(n_algorithms):
         setup_benchmark_function(desc, f"algorithms/{i}/")
+        get_value_table_layout(desc, f"algorithms/{i}/")
 
     # Run benchmarks using all available threads
     calc_optimum = desc.get("present/compare_to_optimum", False)
@@ -217,11 +311,25 @@ def run_benchmarks(desc):
         for benchmark_index, benchmark in enumerate(benchmarks):
             for algorithm_index in range(n_algorithms):
                 result_index = algorithm_index + n_algorithms * benchmark_index + n_algorithms * len(benchmarks) * problem_index
+                value, time_taken, cache_misses, checkpoint_values = results[result_index]
+                if sample_time_limits_from_one_run:
+                    # The cache misses are those of the whole run.
+                    for time_limit, checkpoint_value in zip(time_limits, checkpoint_values):
+                        result_entry = {
+                            "algorithm" : algorithm_index,
+                            "time_limit" : time_limit,
+                            "value" : checkpoint_value,
+                            "time_taken" : min(time_limit, time_taken),
+                            "cache_misses" : cache_misses
+                        }
+                        problem_entry["benchmarks"].append(result_entry)
+                    continue
                 result_entry = {
                     "algorithm" : algorithm_index,
                     "time_limit" : benchmark.time_limit_sec,
-                    "value" : results[result_index][0],
-                    "time_taken" : results[result_index][1]
+                    "value" : value,
+                    "time_taken" : time_taken,
+                    "cache_misses" : cache_misses
                 }
                 problem_entry["benchmarks"].append(result_entry)
         desc.get("results").append(problem_entry)
@@ -266,7 +374,7 @@ def create_presentation(desc):
     compare_to_optimum = desc.get("present/compare_to_optimum")
     assert_in(desc, "present/x_axis", ["n_agents", "n_tasks", "time_taken", "time_limit"])
     x_axis = desc.get("present/x_axis")
-    assert_in(desc, "present/y_axis", ["value", "time_taken"])
+    assert_in(desc, "present/y_axis", ["value", "time_taken", "cache_misses"])
     y_axis = desc.get("present/y_axis")
 
     # Dela upp i serier
@@ -299,6 +407,8 @@ def create_presentation(desc):
                 raw_values = [result["value"] for result in series_results]
             elif y_axis == "time_taken":
                 raw_values = [result["time_taken"] for result in series_results]
+            elif y_axis == "cache_misses":
+                raw_values = [result.get("cache_misses", -1) for result in series_results]
             y_value = numpy.mean(raw_values)
             y_confdiff = 1.96 * std_err(raw_values)
             if x_axis == "time_taken":
@@ -351,6 +461,8 @@ def main():
     parser.add_argument('--n_threads', type=int, required=True, help='Number of threads available to run benchmarks.')
     parser.add_argument('--log_to_console', type=bool, default=False, required=False, help='Enable logging to console')
     parser.add_argument('--log_file', type=str, default='log.txt', required=False, help='File where the complete log is saved')
+    parser.add_argument('--specifications', type=str, nargs='+', required=False,
+        help='Only run these specification files (e.g. specifications/subsets_dp_npd.json) instead of the article benchmarks')
     args = parser.parse_args()
 
     if args.log_to_console:
@@ -367,9 +479,12 @@ def main():
     ensure_directory_exists('results')
 
     file_names = []
-    for type in TYPES:
-        for distr in DISTRIBUTIONS:
-            file_names.append(f'specifications/{type}_{distr}.json')
+    if args.specifications:
+        file_names = args.specifications
+    else:
+        for type in TYPES:
+            for distr in DISTRIBUTIONS:
+                file_names.append(f'specifications/{type}_{distr}.json')
     
     with tqdm.tqdm(iterable=file_names, total=len(file_names), position=0, leave=False) as pbar:
         for file_name in pbar:
@@ -380,7 +495,8 @@ def main():
             run_benchmarks(desc)
             create_presentation(desc)
             desc.save(f'results/{get_unique_name(desc)}_result')
-    create_complete_latex_file()
+    if not args.specifications:
+        create_complete_latex_file()
 
 if __name__ == '__main__':
     main()
@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+
+import argparse
+import itertools
+
+import sys
+# TODO: What's the path on Windows? Append both or have an if-statement
+sys.path.append('../build/PYTHON-API')
+
+import scsga
+from scsga import problem_t as Problem
+from scsga import problem_specification_t as ProblemSpecifiation
+from scsga import benchmark_specification_t as BenchmarkSpecification
+
+DISTRIBUTIONS = ["MPD", "NDCS", "NPD", "NRD", "NSD", "NSRD", "SIMPLE", "UPD"]
+
+# The MP solvers, which prune with bounds shared between threads, that are checked against the DP, by display name.
+SOLVERS = {
+    "MP" : lambda problem, benchmark: scsga.run_mp_benchmark(problem, benchmark),
+    "MP 2 threads" : lambda problem, benchmark: scsga.run_mp_benchmark(problem, benchmark, n_threads=2),
+    "MP+AG" : lambda problem, benchmark: scsga.run_mp_benchmark(problem, benchmark, greedy_init=True),
+    "MPH" : lambda problem, benchmark: scsga.run_hybrid_benchmark(problem, benchmark),
+    "MPH 2 threads" : lambda problem, benchmark: scsga.run_hybrid_benchmark(problem, benchmark, n_threads=2),
+}
+
+# The MP solvers prune subspaces within this tolerance of the best solution.
+TOLERANCE = 0.001
+
+def solve(function, specification):
+    problem = Problem(specification)
+    return function(problem, BenchmarkSpecification(-1, 1)).solution_values[0]
+
+def main():
+    parser = argparse.ArgumentParser(description='Check that the MP solvers find the optimum of the DP on small problems.',
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument('--max_agents', type=int, default=10, help='Largest number of agents to check.')
+    parser.add_argument('--seeds', type=int, default=3, help='Problems to check of every size and distribution.')
+    args = parser.parse_args()
+
+    n_checks = 0
+    mismatches = []
+    for distribution_name, n_agents, n_tasks, seed in itertools.product(
+            DISTRIBUTIONS, range(2, args.max_agents + 1, 2), [1, 2, 3, 5, 8], range(1, args.seeds + 1)):
+        distribution = getattr(ProblemSpecifiation.distribution_t, distribution_name)
+        specification = ProblemSpecifiation(n_agents, n_tasks, seed, distribution)
+        optimum = solve(lambda problem, benchmark: scsga.run_dp_benchmark(problem, benchmark), specification)
+        for name, function in SOLVERS.items():
+            n_checks += 1
+            value = solve(function, specification)
+            if abs(value - optimum) > TOLERANCE:
+                mismatches.append(f"{name} on {distribution_name}, n = {n_agents}, m = {n_tasks}, seed = {seed}: got {value}, DP got {optimum}")
+
+    for mismatch in mismatches:
+        print(mismatch)
+    print(f"{n_checks - len(mismatches)} of {n_checks} solutions match the DP.")
+    sys.exit(1 if mismatches else 0)
+
+if __name__ == '__main__':
+    main()
@@ -3,38 +3,111 @@
 #define LARGE_COALITIONS
 
 #include <cassert>
+#include <cstdint>
+#include <limits>
+#include <array>
+#include <iterator>
 #include <unordered_set>
 #include <algorithm>
 #include <vector>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// The largest number of agents a coalition can hold. Agents are stored as bits in inline 64-bit
+// words, so this decides the size of every coalition_t (COALITION_MAX_AGENTS / 8 bytes), though not
+// what copying one costs. Builds for smaller problems can lower it with the CMake cache variable.
+#ifndef COALITION_MAX_AGENTS
+#define COALITION_MAX_AGENTS 1024
+#endif
+
 namespace coalition {
 
 #ifdef LARGE_COALITIONS
-	class coalition_t
+	/*
+		A coalition over at most 64 * N_WORDS agents. The agent bits are stored inline, so
+		constructing, copying and assigning a coalition never allocates. Only the first
+		get_n_words() words, one per 64 agents, are active, and the words beyond them are never
+		read. Copies, comparisons and counts thus cost as many words as the problem needs, one
+		for at most 64 agents, whereas a coalition still takes the memory of all N_WORDS words.
+	*/
+	template<uint32_t N_WORDS>
+	class basic_coalition_t
 	{
 	public:
-		coalition_t();
-		explicit coalition_t(const uint32_t n_agents);
+		using word_t = uint64_t;
+		static constexpr uint32_t BITS_PER_WORD{ 64 };
+		static constexpr uint32_t CAPACITY{ N_WORDS * BITS_PER_WORD };
+
+		/*
+			Forward iterator over the agents in a coalition, in increasing order. Each step
+			clears the lowest set bit and finds the next one with count-trailing-zeros, so a
+			full pass costs O(agents in coalition + words) and never allocates.
+		*/
+		class agent_iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = uint32_t;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const uint32_t*;
+			using reference = uint32_t;
+
+			agent_iterator(const word_t* words, const uint32_t n_words, const uint32_t word_index);
+
+			uint32_t operator*() const;
+			agent_iterator& operator++();
+			bool operator==(const agent_iterator& other) const;
+			bool operator!=(const agent_iterator& other) const;
+
+		private:
+			const word_t* words;
+			uint32_t n_words;
+			uint32_t word_index;
+			word_t remaining_bits;
+
+			void skip_empty_words();
+		};
+
+		struct agent_range
+		{
+			agent_iterator first, last;
+			agent_iterator begin() const { return first; }
+			agent_iterator end() const { return last; }
+		};
+
+		basic_coalition_t();
+		explicit basic_coalition_t(const uint32_t n_agents);
+		basic_coalition_t(const basic_coalition_t& other); // Copies the active words only.
+		basic_coalition_t& operator=(const basic_coalition_t& other);
 
 		void reset(const uint32_t n_agents);
 		void add_agent(const uint32_t agent);
 		void remove_agent(const uint32_t agent);
 
 		bool is_agent_in_coalition(const uint32_t agent) const;
+		agent_range agents() const; // Iterates the agents in the coalition without allocating.
 		std::vector<uint32_t> get_all_agents() const;
 		uint32_t count_agents_in_coalition() const;
 		uint32_t get_n_agents() const;
+		uint32_t get_n_words() const;
+		word_t get_word(const uint32_t word_index) const;
+		void set_word(const uint32_t word_index, const word_t word);
 
 		uint32_t get_agent_mask() const; // Requires n_agents <= 32
 		void set_value(const std::vector<uint32_t> agent_bitset);
 		void set_value(const uint32_t agent_mask); // Requires n_agents <= 32
 
-		bool operator==(const coalition_t& other) const;
+		bool operator==(const basic_coalition_t& other) const;
 
 	private:
 		uint32_t n_agents;
-		std::vector<uint32_t> agent_bitset;
+		uint32_t n_words;
+		std::array<word_t, N_WORDS> agent_bitset;
 	};
+
+	using coalition_t = basic_coalition_t<(COALITION_MAX_AGENTS + 63) / 64>;
 #else
 	class coalition_t
 	{
@@ -66,6 +139,236 @@ namespace coalition {
 	constexpr value_t NEG_INF = std::numeric_limits<value_t>::lowest();
 	constexpr value_t POS_INF = std::numeric_limits<value_t>::max();
 	constexpr uint32_t MAX_AGENTS = 32;
+
+#ifdef LARGE_COALITIONS
+	namespace
+	{
+		inline uint32_t bit_count_64bit(const uint64_t n_value)
+		{
+#if defined(__GNUG__)
+			return __builtin_popcountll(n_value);
+#elif defined(_MSC_VER)
+			return static_cast<uint32_t>(__popcnt64(n_value));
+#endif
+		}
+
+		inline uint32_t trailing_zeros_64bit(const uint64_t n_value) // Requires n_value != 0
+		{
+#if defined(__GNUG__)
+			return __builtin_ctzll(n_value);
+#elif defined(_MSC_VER)
+			unsigned long n_index;
+			_BitScanForward64(&n_index, n_value);
+			return n_index;
+#endif
+		}
+	}
+
+	template<uint32_t N_WORDS>
+	inline basic_coalition_t<N_WORDS>::agent_iterator::agent_iterator(const word_t* words, const uint32_t n_words, const uint32_t word_index)
+		: words{ words }, n_words{ n_words }, word_index{ word_index }, remaining_bits{ word_index < n_words ? words[word_index] : 0 }
+	{
+		skip_empty_words();
+	}
+
+	template<uint32_t N_WORDS>
+	inline uint32_t basic_coalition_t<N_WORDS>::agent_iterator::operator*() const
+	{
+		return word_index * BITS_PER_WORD + trailing_zeros_64bit(remaining_bits);
+	}
+
+	template<uint32_t N_WORDS>
+	inline typename basic_coalition_t<N_WORDS>::agent_iterator& basic_coalition_t<N_WORDS>::agent_iterator::operator++()
+	{
+		remaining_bits &= remaining_bits - 1; // Clear the lowest set bit.
+		skip_empty_words();
+		return *this;
+	}
+
+	template<uint32_t N_WORDS>
+	inline bool basic_coalition_t<N_WORDS>::agent_iterator::operator==(const agent_iterator& other) const
+	{
+		return word_index == other.word_index && remaining_bits == other.remaining_bits;
+	}
+
+	template<uint32_t N_WORDS>
+	inline bool basic_coalition_t<N_WORDS>::agent_iterator::operator!=(const agent_iterator& other) const
+	{
+		return !(*this == other);
+	}
+
+	template<uint32_t N_WORDS>
+	inline void basic_coalition_t<N_WORDS>::agent_iterator::skip_empty_words()
+	{
+		while (remaining_bits == 0 && word_index < n_words)
+		{
+			++word_index;
+			remaining_bits = word_index < n_words ? words[word_index] : 0;
+		}
+	}
+
+	template<uint32_t N_WORDS>
+	basic_coalition_t<N_WORDS>::basic_coalition_t()
+		: n_agents{}, n_words{ 1 }
+	{
+		agent_bitset[0] = 0;
+	}
+
+	template<uint32_t N_WORDS>
+	basic_coalition_t<N_WORDS>::basic_coalition_t(const uint32_t n_agents)
+		: n_agents{}, n_words{ 1 }
+	{
+		reset(n_agents);
+	}
+
+	template<uint32_t N_WORDS>
+	inline basic_coalition_t<N_WORDS>::basic_coalition_t(const basic_coalition_t& other)
+		: n_agents{ other.n_agents }, n_words{ other.n_words }
+	{
+		std::copy_n(other.agent_bitset.begin(), n_words, agent_bitset.begin());
+	}
+
+	template<uint32_t N_WORDS>
+	inline basic_coalition_t<N_WORDS>& basic_coalition_t<N_WORDS>::operator=(const basic_coalition_t& other)
+	{
+		n_agents = other.n_agents;
+		n_words = other.n_words;
+		std::copy_n(other.agent_bitset.begin(), n_words, agent_bitset.begin());
+		return *this;
+	}
+
+	template<uint32_t N_WORDS>
+	void basic_coalition_t<N_WORDS>::reset(const uint32_t n_agents)
+	{
+		assert(n_agents <= CAPACITY);
+
+		n_words = std::max<uint32_t>(1U, (n_agents + BITS_PER_WORD - 1) / BITS_PER_WORD);
+		std::fill_n(agent_bitset.begin(), n_words, word_t{});
+		this->n_agents = n_agents;
+	}
+
+	template<uint32_t N_WORDS>
+	inline void basic_coalition_t<N_WORDS>::add_agent(const uint32_t agent)
+	{
+		// The agent is found at word index agent // 64 and bit index agent % 64.
+		assert(agent < n_words * BITS_PER_WORD);
+		agent_bitset[agent >> 6] |= word_t{ 1 } << (agent & 63);
+	}
+
+	template<uint32_t N_WORDS>
+	inline void basic_coalition_t<N_WORDS>::remove_agent(const uint32_t agent)
+	{
+		assert(agent < n_words * BITS_PER_WORD);
+		agent_bitset[agent >> 6] &= ~(word_t{ 1 } << (agent & 63));
+	}
+
+	template<uint32_t N_WORDS>
+	inline bool basic_coalition_t<N_WORDS>::is_agent_in_coalition(const uint32_t agent) const
+	{
+		assert(agent < n_words * BITS_PER_WORD);
+		return (agent_bitset[agent >> 6] & (word_t{ 1 } << (agent & 63))) != 0;
+	}
+
+	template<uint32_t N_WORDS>
+	inline typename basic_coalition_t<N_WORDS>::agent_range basic_coalition_t<N_WORDS>::agents() const
+	{
+		return agent_range{
+			agent_iterator(agent_bitset.data(), n_words, 0),
+			agent_iterator(agent_bitset.data(), n_words, n_words)
+		};
+	}
+
+	template<uint32_t N_WORDS>
+	std::vector<uint32_t> basic_coalition_t<N_WORDS>::get_all_agents() const
+	{
+		std::vector<uint32_t> all_agents;
+		all_agents.reserve(count_agents_in_coalition());
+		for (const uint32_t agent : agents())
+		{
+			all_agents.push_back(agent);
+		}
+		return all_agents;
+	}
+
+	template<uint32_t N_WORDS>
+	inline uint32_t basic_coalition_t<N_WORDS>::count_agents_in_coalition() const
+	{
+		uint32_t agents_in_coalition{};
+		for (uint32_t word_index{}; word_index < n_words; ++word_index)
+		{
+			agents_in_coalition += bit_count_64bit(agent_bitset[word_index]);
+		}
+		return agents_in_coalition;
+	}
+
+	template<uint32_t N_WORDS>
+	inline uint32_t basic_coalition_t<N_WORDS>::get_n_agents() const
+	{
+		return n_agents;
+	}
+
+	template<uint32_t N_WORDS>
+	inline uint32_t basic_coalition_t<N_WORDS>::get_n_words() const
+	{
+		return n_words;
+	}
+
+	template<uint32_t N_WORDS>
+	inline typename basic_coalition_t<N_WORDS>::word_t basic_coalition_t<N_WORDS>::get_word(const uint32_t word_index) const
+	{
+		assert(word_index < n_words);
+		return agent_bitset[word_index];
+	}
+
+	template<uint32_t N_WORDS>
+	inline void basic_coalition_t<N_WORDS>::set_word(const uint32_t word_index, const word_t word)
+	{
+		assert(word_index < n_words);
+		agent_bitset[word_index] = word;
+	}
+
+	template<uint32_t N_WORDS>
+	inline uint32_t basic_coalition_t<N_WORDS>::get_agent_mask() const
+	{
+		/*
+		The purpose of this method is to provide backwards compatibility with algorithms using a single uint32_t
+		as coalition_t. As such, it is only meant to be used when n_agents in at most 32.
+		*/
+		assert(n_agents <= 32);
+		return static_cast<uint32_t>(agent_bitset[0]);
+	}
+
+	template<uint32_t N_WORDS>
+	void basic_coalition_t<N_WORDS>::set_value(const std::vector<uint32_t> agent_bitset)
+	{
+		// The bitset is given as 32-bit words, i.e. two of them make up one of our words.
+		assert((agent_bitset.size() + 1) / 2 == n_words);
+		for (uint32_t word_index{}; word_index < n_words; ++word_index)
+		{
+			const uint32_t low_index{ 2 * word_index }, high_index{ 2 * word_index + 1 };
+			const word_t low{ low_index < agent_bitset.size() ? agent_bitset[low_index] : 0U };
+			const word_t high{ high_index < agent_bitset.size() ? agent_bitset[high_index] : 0U };
+			this->agent_bitset[word_index] = low | (high << 32);
+		}
+	}
+
+	template<uint32_t N_WORDS>
+	inline void basic_coalition_t<N_WORDS>::set_value(const uint32_t agent_mask)
+	{
+		assert(n_agents <= 32);
+		agent_bitset[0] = agent_mask;
+	}
+
+	template<uint32_t N_WORDS>
+	inline bool basic_coalition_t<N_WORDS>::operator==(const basic_coalition_t& other) const
+	{
+		// Words beyond the active ones are not read, so the other active words of the longer coalition must be empty.
+		const uint32_t n_common_words{ std::min(n_words, other.n_words) };
+		const basic_coalition_t& longer{ n_words > other.n_words ? *this : other };
+		return std::equal(agent_bitset.begin(), agent_bitset.begin() + n_common_words, other.agent_bitset.begin())
+			&& std::all_of(longer.agent_bitset.begin() + n_common_words, longer.agent_bitset.begin() + longer.n_words, [](const word_t word) { return word == 0; });
+	}
+#endif
 }
 
 namespace std {
@@ -74,8 +377,7 @@ namespace std {
 		std::size_t operator()(const coalition::coalition_t& coalition) const noexcept
 		{
 			std::size_t h{ 5381 };
-			std::vector<uint32_t> agents_in_coalition(coalition.get_all_agents());
-			for (const uint32_t& agent : agents_in_coalition)
+			for (const uint32_t agent : coalition.agents())
 			{
 				h = (h << 5) + h + agent;
 			}
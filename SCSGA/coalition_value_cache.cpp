@@ -0,0 +1,306 @@
+#include "coalition_value_cache.h"
+
+#include <algorithm>
+#include <limits>
+
+void coalition_value_cache::reset(const uint32_t n_agents)
+{
+	clear();
+	this->n_agents = n_agents;
+	n_words = coalition::coalition_t(n_agents).get_n_words();
+	slot_words = n_words + 1;
+}
+
+void coalition_value_cache::clear()
+{
+	// Memory is released and only allocated again on the first insertion.
+	std::vector<word_t>().swap(slots);
+	n_slots = 0;
+	n_entries = 0;
+	clock_hand = 0;
+	reset_statistics();
+}
+
+void coalition_value_cache::set_memory_budget(const uint64_t budget)
+{
+	memory_budget = budget;
+	if (n_slots > get_max_capacity())
+	{
+		clear();
+	}
+}
+
+bool coalition_value_cache::find(const coalition::coalition_t& coalition, const uint32_t task, coalition::value_t& value)
+{
+	assert(coalition.get_n_words() == n_words);
+	if (n_slots == 0)
+	{
+		++misses;
+		return false;
+	}
+
+	const auto word_at = [&coalition](const uint32_t word_index) { return coalition.get_word(word_index); };
+	const uint64_t slot_mask{ n_slots - 1 };
+	const word_t task_tag{ word_t{ task + 1 } };
+	uint64_t slot{ hash(word_at, n_words, task) & slot_mask };
+	uint32_t probe_length{ 1 };
+	bool found{ false };
+	while (true)
+	{
+		word_t* entry{ &slots[slot * slot_words] };
+		const word_t tag{ entry[n_words] };
+		if (tag == 0)
+		{
+			break;
+		}
+		if (((tag >> 32) & TASK_MASK) == task_tag)
+		{
+			uint32_t word_index{};
+			while (word_index < n_words && entry[word_index] == word_at(word_index))
+			{
+				++word_index;
+			}
+			if (word_index == n_words)
+			{
+				entry[n_words] = tag | REFERENCED_BIT;
+				value = unpack_value(tag);
+				found = true;
+				break;
+			}
+		}
+		slot = (slot + 1) & slot_mask;
+		++probe_length;
+	}
+
+	++lookups;
+	total_probe_length += probe_length;
+	max_probe_length = std::max(max_probe_length, probe_length);
+	found ? ++hits : ++misses;
+	return found;
+}
+
+void coalition_value_cache::insert(const coalition::coalition_t& coalition, const uint32_t task, const coalition::value_t value)
+{
+	assert(coalition.get_n_words() == n_words);
+	insert([&coalition](const uint32_t word_index) { return coalition.get_word(word_index); }, pack_tag(task, value));
+}
+
+void coalition_value_cache::reserve(const uint64_t n_entries)
+{
+	uint64_t new_n_slots{ std::max(n_slots, INITIAL_CAPACITY) };
+	while (n_entries > static_cast<uint64_t>(new_n_slots * MAX_LOAD_FACTOR))
+	{
+		new_n_slots *= 2;
+	}
+	new_n_slots = std::min(new_n_slots, get_max_capacity());
+	if (new_n_slots > n_slots)
+	{
+		grow(new_n_slots);
+	}
+}
+
+void coalition_value_cache::write_entries(std::ostream& output) const
+{
+	std::vector<word_t> chunk;
+	chunk.reserve(ENTRIES_PER_CHUNK * slot_words);
+	for (uint64_t slot{}; slot < n_slots; ++slot)
+	{
+		const word_t* entry{ &slots[slot * slot_words] };
+		if (entry[n_words] == 0)
+		{
+			continue;
+		}
+		chunk.insert(chunk.end(), entry, entry + slot_words);
+		chunk.back() &= ~REFERENCED_BIT;
+		if (chunk.size() == chunk.capacity())
+		{
+			output.write(reinterpret_cast<const char*>(chunk.data()), chunk.size() * sizeof(word_t));
+			chunk.clear();
+		}
+	}
+	output.write(reinterpret_cast<const char*>(chunk.data()), chunk.size() * sizeof(word_t));
+}
+
+bool coalition_value_cache::read_entries(std::istream& input, const uint64_t n_entries, const uint32_t n_tasks)
+{
+	assert(this->n_entries == 0);
+	reserve(n_entries);
+
+	// Bits of a coalition beyond the agents of the problem would never be looked up.
+	const uint32_t n_used_bits{ n_agents - (n_words - 1) * 64 };
+	const word_t last_word_mask{ n_used_bits == 64 ? ~word_t{} : (word_t{ 1 } << n_used_bits) - 1 };
+	std::vector<word_t> chunk(ENTRIES_PER_CHUNK * slot_words);
+	for (uint64_t n_read{}; n_read < n_entries; )
+	{
+		const uint64_t n_chunk_entries{ std::min(ENTRIES_PER_CHUNK, n_entries - n_read) };
+		input.read(reinterpret_cast<char*>(chunk.data()), n_chunk_entries * slot_words * sizeof(word_t));
+		if (!input)
+		{
+			return false;
+		}
+		for (uint64_t n_entry{}; n_entry < n_chunk_entries; ++n_entry)
+		{
+			const word_t* entry{ &chunk[n_entry * slot_words] };
+			const word_t tag{ entry[n_words] };
+			const auto word_at = [entry](const uint32_t word_index) { return entry[word_index]; };
+			if (tag == 0 || (tag & REFERENCED_BIT) != 0 || (entry[n_words - 1] & ~last_word_mask) != 0
+				|| unpack_task(tag) >= n_tasks || contains(word_at, unpack_task(tag)))
+			{
+				return false;
+			}
+			insert(word_at, tag);
+		}
+		n_read += n_chunk_entries;
+	}
+	return true;
+}
+
+uint64_t coalition_value_cache::size() const
+{
+	return n_entries;
+}
+
+uint64_t coalition_value_cache::capacity() const
+{
+	return n_slots;
+}
+
+float coalition_value_cache::load_factor() const
+{
+	return n_slots > 0 ? static_cast<float>(n_entries) / n_slots : 0.0f;
+}
+
+value_cache_statistics_t coalition_value_cache::get_statistics() const
+{
+	value_cache_statistics_t statistics{};
+	statistics.size = n_entries;
+	statistics.capacity = n_slots;
+	statistics.load_factor = load_factor();
+	statistics.memory_usage = slots.size() * sizeof(word_t);
+	statistics.memory_budget = memory_budget;
+	statistics.hits = hits;
+	statistics.misses = misses;
+	statistics.evictions = evictions;
+	statistics.lookups = lookups;
+	statistics.total_probe_length = total_probe_length;
+	statistics.max_probe_length = max_probe_length;
+	statistics.mean_probe_length = lookups > 0 ? static_cast<float>(total_probe_length) / lookups : 0.0f;
+	return statistics;
+}
+
+void coalition_value_cache::reset_statistics()
+{
+	hits = 0;
+	misses = 0;
+	evictions = 0;
+	lookups = 0;
+	total_probe_length = 0;
+	max_probe_length = 0;
+}
+
+uint64_t coalition_value_cache::get_max_capacity() const
+{
+	if (memory_budget == 0)
+	{
+		return std::numeric_limits<uint64_t>::max();
+	}
+
+	// The largest power of two number of slots that fits within the budget.
+	const uint64_t slots_in_budget{ memory_budget / (slot_words * sizeof(word_t)) };
+	uint64_t max_capacity{ MIN_CAPACITY };
+	while (2 * max_capacity <= slots_in_budget)
+	{
+		max_capacity *= 2;
+	}
+	return max_capacity;
+}
+
+uint64_t coalition_value_cache::get_home_slot(const word_t* entry) const
+{
+	const auto word_at = [entry](const uint32_t word_index) { return entry[word_index]; };
+	return hash(word_at, n_words, unpack_task(entry[n_words])) & (n_slots - 1);
+}
+
+void coalition_value_cache::grow(const uint64_t new_n_slots)
+{
+	const uint64_t new_slot_mask{ new_n_slots - 1 };
+	std::vector<word_t> new_slots(new_n_slots * slot_words, word_t{});
+
+	for (uint64_t slot{}; slot < n_slots; ++slot)
+	{
+		const word_t* entry{ &slots[slot * slot_words] };
+		if (entry[n_words] == 0)
+		{
+			continue;
+		}
+
+		const auto word_at = [entry](const uint32_t word_index) { return entry[word_index]; };
+		uint64_t new_slot{ hash(word_at, n_words, unpack_task(entry[n_words])) & new_slot_mask };
+		while (new_slots[new_slot * slot_words + n_words] != 0)
+		{
+			new_slot = (new_slot + 1) & new_slot_mask;
+		}
+		std::copy_n(entry, slot_words, &new_slots[new_slot * slot_words]);
+	}
+
+	slots.swap(new_slots);
+	n_slots = new_n_slots;
+	clock_hand = 0;
+}
+
+void coalition_value_cache::evict()
+{
+	// The hand visits the slots with an odd stride close to n_slots / golden ratio, which is
+	// coprime with the power of two capacity and hence still visits every slot once per sweep.
+	// Sweeping consecutive slots would evict whole runs of the table at once while insertions
+	// land anywhere, leaving the rest of the table nearly full and its probe sequences long.
+	// Terminates within two sweeps, as the first one clears every reference bit.
+	const uint64_t slot_mask{ n_slots - 1 };
+	const uint64_t stride{ static_cast<uint64_t>(n_slots * 0.6180339887) | 1 };
+	while (true)
+	{
+		word_t& tag{ slots[clock_hand * slot_words + n_words] };
+		if (tag != 0)
+		{
+			if ((tag & REFERENCED_BIT) == 0)
+			{
+				// The hand stays, as erasing may shift an entry it has not seen yet into this slot.
+				erase(clock_hand);
+				++evictions;
+				return;
+			}
+			tag &= ~REFERENCED_BIT;
+		}
+		clock_hand = (clock_hand + stride) & slot_mask;
+	}
+}
+
+void coalition_value_cache::erase(const uint64_t slot)
+{
+	// Backward-shift deletion: entries up to the next empty slot that may legally fill the hole
+	// are moved into it, so no tombstones are needed.
+	const uint64_t slot_mask{ n_slots - 1 };
+	uint64_t hole{ slot };
+	uint64_t next{ slot };
+	while (true)
+	{
+		next = (next + 1) & slot_mask;
+		const word_t* entry{ &slots[next * slot_words] };
+		if (entry[n_words] == 0)
+		{
+			break;
+		}
+
+		// The entry may fill the hole unless its home slot lies cyclically in (hole, next].
+		const uint64_t home{ get_home_slot(entry) };
+		const uint64_t distance_to_home{ (next - home) & slot_mask };
+		const uint64_t distance_to_hole{ (next - hole) & slot_mask };
+		if (distance_to_home >= distance_to_hole)
+		{
+			std::copy_n(entry, slot_words, &slots[hole * slot_words]);
+			hole = next;
+		}
+	}
+	std::fill_n(&slots[hole * slot_words], slot_words, word_t{});
+	--n_entries;
+}
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "coalition.h"
+
+/*
+	Statistics of a coalition_value_cache. Probe lengths count the slots inspected
+	per lookup, i.e. a lookup that hits its home slot has probe length 1. Memory is
+	given in bytes and a budget of 0 means that the cache is unbounded.
+*/
+struct value_cache_statistics_t
+{
+	uint64_t size{};
+	uint64_t capacity{};
+	float load_factor{};
+	uint64_t memory_usage{};
+	uint64_t memory_budget{};
+	uint64_t hits{};
+	uint64_t misses{};
+	uint64_t evictions{};
+	uint64_t lookups{};
+	uint64_t total_probe_length{};
+	uint32_t max_probe_length{};
+	float mean_probe_length{};
+};
+
+/*
+	Open-addressing (linear probing) hash table from (coalition, task) to value, used to
+	cache lazily generated values of problems with more than 32 agents.
+
+	Each slot stores the active words of the coalition bitset inline, followed by one word
+	holding task + 1 (0 marks an empty slot) and the value. Slots are therefore
+	get_n_words() + 1 words wide and live in a single flat vector, so a lookup touches one
+	contiguous run of memory and never allocates. Lookups take the coalition itself, so no
+	key has to be built to probe the table.
+
+	The table may be given a memory budget, in which case it stops growing once the next
+	doubling would exceed the budget and instead evicts entries using the CLOCK policy: a
+	hand sweeps the slots, clearing the reference bit of entries accessed since its last
+	pass and evicting the first entry whose bit is already clear. Evicting is only correct
+	if evicted values can be regenerated exactly, see
+	coalitional_values_generator::seed_value_generator.
+*/
+class coalition_value_cache
+{
+public:
+	using word_t = coalition::coalition_t::word_t;
+
+	// Removes all entries and prepares the table for coalitions over n_agents agents.
+	void reset(const uint32_t n_agents);
+	void clear();
+	// Limits the memory used by the slots to budget bytes, 0 for no limit. Clears the cache if it no longer fits.
+	void set_memory_budget(const uint64_t budget);
+
+	// Returns true and sets value if (coalition, task) is cached.
+	bool find(const coalition::coalition_t& coalition, const uint32_t task, coalition::value_t& value);
+	// Inserts (coalition, task), which must not already be cached.
+	void insert(const coalition::coalition_t& coalition, const uint32_t task, const coalition::value_t value);
+	// Grows the table at once to hold n_entries entries, as far as the memory budget allows.
+	void reserve(const uint64_t n_entries);
+
+	/*
+		Writes all entries to output as they are stored in the slots, without the reference bit:
+		the words of the coalition followed by the word holding the task and the value. Entries
+		are written in chunks, so that no per entry formatting or stream call is needed.
+	*/
+	void write_entries(std::ostream& output) const;
+	/*
+		Inserts n_entries entries written by write_entries for the same number of agents into an
+		empty cache, reading them in chunks. Entries beyond the memory budget evict older ones.
+		Returns false if the input ends early or holds an invalid entry, such as one of a task
+		not below n_tasks or one read before, in which case the cache keeps the entries read so far.
+	*/
+	bool read_entries(std::istream& input, const uint64_t n_entries, const uint32_t n_tasks);
+
+	uint64_t size() const;
+	uint64_t capacity() const;
+	float load_factor() const;
+	value_cache_statistics_t get_statistics() const;
+	void reset_statistics();
+
+	// Calls visitor(coalition, task, value) for every cached entry.
+	template<typename Visitor>
+	void for_each(Visitor&& visitor) const;
+
+private:
+	static constexpr uint64_t INITIAL_CAPACITY{ 1ULL << 16 };
+	static constexpr uint64_t MIN_CAPACITY{ 16 };
+	static constexpr float MAX_LOAD_FACTOR{ 0.75f };
+	static constexpr uint64_t ENTRIES_PER_CHUNK{ 1ULL << 12 }; // Entries per read or write of write_entries and read_entries.
+
+	// Layout of the last word of a slot: the CLOCK reference bit, then task + 1, then the value bits.
+	static constexpr uint64_t REFERENCED_BIT{ 1ULL << 63 };
+	static constexpr uint64_t TASK_MASK{ 0x7FFFFFFFULL };
+
+	uint32_t n_agents{};
+	uint32_t n_words{ 1 };
+	uint32_t slot_words{ 2 };
+	uint64_t n_slots{};
+	uint64_t n_entries{};
+	std::vector<word_t> slots;
+	uint64_t memory_budget{};
+	uint64_t clock_hand{};
+
+	uint64_t hits{};
+	uint64_t misses{};
+	uint64_t evictions{};
+	uint64_t lookups{};
+	uint64_t total_probe_length{};
+	uint32_t max_probe_length{};
+
+	template<typename WordAccessor>
+	static uint64_t hash(const WordAccessor& word_at, const uint32_t n_words, const uint32_t task);
+	static word_t pack_tag(const uint32_t task, const coalition::value_t value);
+	static uint32_t unpack_task(const word_t tag);
+	static coalition::value_t unpack_value(const word_t tag);
+
+	uint64_t get_max_capacity() const;
+	uint64_t get_home_slot(const word_t* entry) const;
+	template<typename WordAccessor>
+	bool contains(const WordAccessor& word_at, const uint32_t task) const;
+	template<typename WordAccessor>
+	void insert(const WordAccessor& word_at, const word_t tag);
+	void grow(const uint64_t new_n_slots);
+	void evict();
+	void erase(const uint64_t slot);
+};
+
+template<typename WordAccessor>
+inline uint64_t coalition_value_cache::hash(const WordAccessor& word_at, const uint32_t n_words, const uint32_t task)
+{
+	// Word-wise multiply-xorshift mixing, finalized as in MurmurHash3's fmix64.
+	uint64_t h{ (task + 1) * 0x9E3779B97F4A7C15ULL };
+	for (uint32_t word_index{}; word_index < n_words; ++word_index)
+	{
+		h = (h ^ word_at(word_index)) * 0xFF51AFD7ED558CCDULL;
+		h ^= h >> 32;
+	}
+	h ^= h >> 33;
+	h *= 0xC4CEB9FE1A85EC53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+inline coalition_value_cache::word_t coalition_value_cache::pack_tag(const uint32_t task, const coalition::value_t value)
+{
+	uint32_t value_bits;
+	std::memcpy(&value_bits, &value, sizeof(value_bits));
+	assert(task < TASK_MASK);
+	return (word_t{ task + 1 } << 32) | value_bits;
+}
+
+inline uint32_t coalition_value_cache::unpack_task(const word_t tag)
+{
+	return static_cast<uint32_t>((tag >> 32) & TASK_MASK) - 1;
+}
+
+inline coalition::value_t coalition_value_cache::unpack_value(const word_t tag)
+{
+	const uint32_t value_bits{ static_cast<uint32_t>(tag) };
+	coalition::value_t value;
+	std::memcpy(&value, &value_bits, sizeof(value));
+	return value;
+}
+
+// Unlike find, neither counts the lookup nor marks the entry as referenced.
+template<typename WordAccessor>
+bool coalition_value_cache::contains(const WordAccessor& word_at, const uint32_t task) const
+{
+	if (n_slots == 0)
+	{
+		return false;
+	}
+
+	const uint64_t slot_mask{ n_slots - 1 };
+	uint64_t slot{ hash(word_at, n_words, task) & slot_mask };
+	while (true)
+	{
+		const word_t* entry{ &slots[slot * slot_words] };
+		const word_t tag{ entry[n_words] };
+		if (tag == 0)
+		{
+			return false;
+		}
+		if (unpack_task(tag) == task)
+		{
+			uint32_t word_index{};
+			while (word_index < n_words && entry[word_index] == word_at(word_index))
+			{
+				++word_index;
+			}
+			if (word_index == n_words)
+			{
+				return true;
+			}
+		}
+		slot = (slot + 1) & slot_mask;
+	}
+}
+
+template<typename WordAccessor>
+void coalition_value_cache::insert(const WordAccessor& word_at, const word_t tag)
+{
+	if (n_entries + 1 > static_cast<uint64_t>(n_slots * MAX_LOAD_FACTOR))
+	{
+		if (n_slots < get_max_capacity())
+		{
+			grow(std::min(n_slots > 0 ? 2 * n_slots : INITIAL_CAPACITY, get_max_capacity()));
+		}
+		else
+		{
+			evict();
+		}
+	}
+
+	const uint64_t slot_mask{ n_slots - 1 };
+	uint64_t slot{ hash(word_at, n_words, unpack_task(tag)) & slot_mask };
+	while (slots[slot * slot_words + n_words] != 0)
+	{
+		slot = (slot + 1) & slot_mask;
+	}
+
+	word_t* entry{ &slots[slot * slot_words] };
+	for (uint32_t word_index{}; word_index < n_words; ++word_index)
+	{
+		entry[word_index] = word_at(word_index);
+	}
+	entry[n_words] = tag | REFERENCED_BIT;
+	++n_entries;
+}
+
+template<typename Visitor>
+void coalition_value_cache::for_each(Visitor&& visitor) const
+{
+	coalition::coalition_t coalition(n_agents);
+	for (uint64_t slot{}; slot < n_slots; ++slot)
+	{
+		const word_t* entry{ &slots[slot * slot_words] };
+		const word_t tag{ entry[n_words] };
+		if (tag == 0)
+		{
+			continue;
+		}
+		for (uint32_t word_index{}; word_index < n_words; ++word_index)
+		{
+			coalition.set_word(word_index, entry[word_index]);
+		}
+		visitor(coalition, unpack_task(tag), unpack_value(tag));
+	}
+}
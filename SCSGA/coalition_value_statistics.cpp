@@ -0,0 +1,167 @@
+#include "coalition_value_statistics.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "max_plus.h"
+#include "utility.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define VALUE_STATISTICS_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUG__)
+#define VALUE_STATISTICS_TARGET(target_name) __attribute__((target(target_name)))
+#else
+#define VALUE_STATISTICS_TARGET(target_name)
+#endif
+
+namespace
+{
+	constexpr uint32_t LANE_BITS{ 3 };
+	constexpr uint32_t LANES{ 1U << LANE_BITS };
+	constexpr uint64_t MIN_BLOCKS_PER_CHUNK{ 1ULL << 12 }; // Blocks of LANES coalitions per parallel work item, at least.
+	constexpr uint64_t MAX_CHUNKS_PER_TASK{ 64 }; // Bounds the memory of the partial statistics.
+
+	// Maximum and sum of each lane for each bit count of the block index, at [bit count * LANES + lane].
+	struct lane_statistics_t
+	{
+		std::vector<float> max_values;
+		std::vector<double> sums;
+
+		explicit lane_statistics_t(const uint32_t n_block_bit_counts)
+			: max_values(n_block_bit_counts * LANES, std::numeric_limits<float>::lowest()), sums(n_block_bit_counts * LANES, 0.0)
+		{
+		}
+	};
+
+	void accumulate_scalar(const float* values, const uint64_t coalition_stride, const uint32_t n_lanes,
+		const uint64_t n_first_block, const uint64_t n_end_block, lane_statistics_t& statistics)
+	{
+		for (uint64_t n_block{ n_first_block }; n_block < n_end_block; ++n_block)
+		{
+			const uint32_t n_offset{ utility::bits::bit_count_32bit(static_cast<uint32_t>(n_block)) * LANES };
+			const float* block_values{ values + n_block * n_lanes * coalition_stride };
+			for (uint32_t n_lane{}; n_lane < n_lanes; ++n_lane)
+			{
+				const float value{ block_values[n_lane * coalition_stride] };
+				float& max_value{ statistics.max_values[n_offset + n_lane] };
+				max_value = std::max(max_value, value);
+				statistics.sums[n_offset + n_lane] += value;
+			}
+		}
+	}
+
+#ifdef VALUE_STATISTICS_X86
+	// Reads the 8 contiguous values of each block with one load.
+	VALUE_STATISTICS_TARGET("avx2") void accumulate_avx2(const float* values, const uint64_t n_first_block, const uint64_t n_end_block,
+		lane_statistics_t& statistics)
+	{
+		float* max_values{ statistics.max_values.data() };
+		double* sums{ statistics.sums.data() };
+		for (uint64_t n_block{ n_first_block }; n_block < n_end_block; ++n_block)
+		{
+			const uint32_t n_offset{ utility::bits::bit_count_32bit(static_cast<uint32_t>(n_block)) * LANES };
+			const __m256 block_values{ _mm256_loadu_ps(values + n_block * LANES) };
+			_mm256_storeu_ps(max_values + n_offset, _mm256_max_ps(_mm256_loadu_ps(max_values + n_offset), block_values));
+			const __m256d low_values{ _mm256_cvtps_pd(_mm256_castps256_ps128(block_values)) };
+			const __m256d high_values{ _mm256_cvtps_pd(_mm256_extractf128_ps(block_values, 1)) };
+			_mm256_storeu_pd(sums + n_offset, _mm256_add_pd(_mm256_loadu_pd(sums + n_offset), low_values));
+			_mm256_storeu_pd(sums + n_offset + 4, _mm256_add_pd(_mm256_loadu_pd(sums + n_offset + 4), high_values));
+		}
+	}
+#endif
+}
+
+bool value_statistics::has_vector_kernel()
+{
+#ifdef VALUE_STATISTICS_X86
+	return max_plus::is_supported(max_plus_kernel_t::AVX2);
+#else
+	return false;
+#endif
+}
+
+value_statistics_t value_statistics::calculate(const coalition_value_table& table, const uint32_t n_threads)
+{
+	value_statistics_t statistics{};
+	if (table.empty())
+	{
+		return statistics;
+	}
+
+	const uint32_t n_agents{ table.get_n_agents() };
+	const uint32_t n_tasks{ table.get_n_tasks() };
+	const uint32_t n_lane_bits{ std::min(LANE_BITS, n_agents) };
+	const uint32_t n_lanes{ 1U << n_lane_bits };
+	const uint32_t n_block_bit_counts{ n_agents - n_lane_bits + 1 };
+	const uint64_t n_blocks{ table.get_n_coalitions() >> n_lane_bits };
+	const uint64_t n_blocks_per_chunk{ std::max(MIN_BLOCKS_PER_CHUNK, (n_blocks + MAX_CHUNKS_PER_TASK - 1) / MAX_CHUNKS_PER_TASK) };
+	const uint64_t n_chunks_per_task{ (n_blocks + n_blocks_per_chunk - 1) / n_blocks_per_chunk };
+	const uint64_t coalition_stride{ table.get_coalition_stride() };
+	const bool use_vector_kernel{ n_lanes == LANES && coalition_stride == 1 && has_vector_kernel() };
+
+	// One chunk per item, so that the partial statistics can be combined in the same order for any number of threads.
+	std::vector<lane_statistics_t> chunk_statistics(n_tasks * n_chunks_per_task, lane_statistics_t(n_block_bit_counts));
+	table.advise(file_access_t::SEQUENTIAL);
+	utility::parallel::for_each_index(chunk_statistics.size(), n_threads, [&](const uint64_t n_item)
+		{
+			const uint32_t task{ static_cast<uint32_t>(n_item / n_chunks_per_task) };
+			const uint64_t n_first_block{ (n_item % n_chunks_per_task) * n_blocks_per_chunk };
+			const uint64_t n_end_block{ std::min(n_first_block + n_blocks_per_chunk, n_blocks) };
+			const float* values{ table.data() + table.get_index(0, task) };
+#ifdef VALUE_STATISTICS_X86
+			if (use_vector_kernel)
+			{
+				accumulate_avx2(values, n_first_block, n_end_block, chunk_statistics[n_item]);
+				return;
+			}
+#endif
+			accumulate_scalar(values, coalition_stride, n_lanes, n_first_block, n_end_block, chunk_statistics[n_item]);
+		});
+	table.advise(file_access_t::NORMAL);
+
+	// Combine the lanes of each task into sizes.
+	std::vector<double> n_coalitions_of_size(n_agents + 1, 0.0);
+	for (uint32_t n_size{}; n_size <= n_agents; ++n_size)
+	{
+		n_coalitions_of_size[n_size] = n_size == 0 ? 1.0 : n_coalitions_of_size[n_size - 1] * (n_agents - n_size + 1) / n_size;
+	}
+
+	statistics.max_value_of_size.assign(n_tasks, std::vector<coalition::value_t>(n_agents + 1, std::numeric_limits<coalition::value_t>::lowest()));
+	statistics.mean_value_of_size.assign(n_tasks, std::vector<coalition::value_t>(n_agents + 1, 0.0f));
+	statistics.max_value_of_size_any_task.assign(n_agents + 1, std::numeric_limits<coalition::value_t>::lowest());
+	statistics.mean_value_of_size_any_task.assign(n_agents + 1, 0.0f);
+	std::vector<double> sums_any_task(n_agents + 1, 0.0);
+	for (uint32_t task{}; task < n_tasks; ++task)
+	{
+		std::vector<double> sums(n_agents + 1, 0.0);
+		std::vector<coalition::value_t>& max_value_of_size{ statistics.max_value_of_size[task] };
+		for (uint64_t n_chunk{}; n_chunk < n_chunks_per_task; ++n_chunk)
+		{
+			const lane_statistics_t& lane_statistics{ chunk_statistics[task * n_chunks_per_task + n_chunk] };
+			for (uint32_t n_block_bit_count{}; n_block_bit_count < n_block_bit_counts; ++n_block_bit_count)
+			{
+				for (uint32_t n_lane{}; n_lane < n_lanes; ++n_lane)
+				{
+					const uint32_t n_size{ n_block_bit_count + utility::bits::bit_count_32bit(n_lane) };
+					const uint32_t n_index{ n_block_bit_count * LANES + n_lane };
+					max_value_of_size[n_size] = std::max(max_value_of_size[n_size], lane_statistics.max_values[n_index]);
+					sums[n_size] += lane_statistics.sums[n_index];
+				}
+			}
+		}
+		for (uint32_t n_size{}; n_size <= n_agents; ++n_size)
+		{
+			statistics.mean_value_of_size[task][n_size] = static_cast<coalition::value_t>(sums[n_size] / n_coalitions_of_size[n_size]);
+			statistics.max_value_of_size_any_task[n_size] = std::max(statistics.max_value_of_size_any_task[n_size], max_value_of_size[n_size]);
+			sums_any_task[n_size] += sums[n_size];
+		}
+	}
+	for (uint32_t n_size{}; n_size <= n_agents; ++n_size)
+	{
+		statistics.mean_value_of_size_any_task[n_size] = static_cast<coalition::value_t>(sums_any_task[n_size] / (n_coalitions_of_size[n_size] * n_tasks));
+	}
+	return statistics;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "coalition.h"
+#include "coalition_value_table.h"
+
+/*
+	Statistics of the values of each coalition size k = 0..n of a problem with at most 32
+	agents, used as bounds by the exact solvers. The vectors are empty for larger problems.
+
+	max_value_of_size			max_value_of_size[task][k] is the largest value of a coalition
+								of k agents for task.
+	mean_value_of_size			mean_value_of_size[task][k] is the mean value of the coalitions
+								of k agents for task.
+	max_value_of_size_any_task	The largest value of a coalition of k agents for any task.
+	mean_value_of_size_any_task	The mean value of the coalitions of k agents over all tasks.
+*/
+struct value_statistics_t
+{
+	std::vector<std::vector<coalition::value_t>> max_value_of_size;
+	std::vector<std::vector<coalition::value_t>> mean_value_of_size;
+	std::vector<coalition::value_t> max_value_of_size_any_task;
+	std::vector<coalition::value_t> mean_value_of_size_any_task;
+};
+
+namespace value_statistics
+{
+	/*
+		Calculates the statistics of all values of table on n_threads threads (0 for one per hardware
+		thread). The coalitions are read in blocks of 8 that only differ in their lowest 3 agents, so
+		that lane l of a block always holds a coalition with popcount(l) more agents than the block
+		index has bits set. Each lane keeps its own maximum and sum per block bit count, which lets
+		a task major table be read with AVX2 when the CPU supports it, and the lanes are combined
+		into sizes at the end. The sums are kept in double and combined in a fixed order, so the
+		statistics do not depend on the number of threads.
+	*/
+	value_statistics_t calculate(const coalition_value_table& table, const uint32_t n_threads = 0);
+
+	// True if calculate reads task major tables with AVX2.
+	bool has_vector_kernel();
+}
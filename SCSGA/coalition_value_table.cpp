@@ -0,0 +1,401 @@
+#include "coalition_value_table.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <new>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+coalition_value_table::~coalition_value_table()
+{
+	clear();
+}
+
+void coalition_value_table::reset(const uint32_t n_agents, const uint32_t n_tasks)
+{
+	reset(n_agents, n_tasks, layout);
+}
+
+void coalition_value_table::reset(const uint32_t n_agents, const uint32_t n_tasks, const value_table_layout_t layout)
+{
+	assert(n_agents <= 32);
+	clear();
+	this->n_agents = n_agents;
+	this->n_tasks = n_tasks;
+	this->layout = layout;
+	n_coalitions = 1ULL << n_agents;
+	update_strides();
+
+	allocated_values.reset(allocate(size()));
+	values = allocated_values.get();
+	std::fill_n(values, size(), coalition::value_t{});
+}
+
+void coalition_value_table::clear()
+{
+	allocated_values.reset();
+	file.close();
+	if (!temporary_file_name.empty())
+	{
+		// The values were never completed.
+		std::error_code error;
+		std::filesystem::remove(temporary_file_name, error);
+		temporary_file_name.clear();
+	}
+	file_name.clear();
+	values = nullptr;
+	n_agents = 0;
+	n_tasks = 0;
+	n_coalitions = 0;
+	update_strides();
+}
+
+bool coalition_value_table::map(const std::string& file_name, const uint32_t n_agents, const uint32_t n_tasks, const uint64_t key)
+{
+	assert(n_agents <= 32);
+	clear();
+	this->n_agents = n_agents;
+	this->n_tasks = n_tasks;
+	n_coalitions = 1ULL << n_agents;
+	update_strides();
+
+	// Everything but the checksum must match, which is only verified when a problem file is opened.
+	file_header_t header{ make_file_header(key) };
+	header.is_complete = 1;
+	if (std::filesystem::exists(file_name))
+	{
+		file.open(file_name, false);
+		if (file.size() == get_file_size())
+		{
+			header.checksum = reinterpret_cast<const file_header_t*>(file.data())->checksum;
+			if (std::memcmp(file.data(), &header, sizeof(header)) == 0)
+			{
+				values = reinterpret_cast<coalition::value_t*>(file.data() + FILE_VALUES_OFFSET);
+				return true;
+			}
+		}
+		file.close();
+	}
+
+	// Tables generating the same file at the same time each use their own temporary file.
+	std::random_device random_device;
+	std::ostringstream temporary_file_name;
+	temporary_file_name << file_name << ".tmp" << std::hex << std::setw(16) << std::setfill('0')
+		<< ((static_cast<uint64_t>(random_device()) << 32) | random_device());
+	this->temporary_file_name = temporary_file_name.str();
+	this->file_name = file_name;
+
+	// The header is only marked complete by flush, so that a file whose values were never completed is regenerated.
+	header.is_complete = 0;
+	header.checksum = 0;
+	file.create(this->temporary_file_name, get_file_size());
+	std::memcpy(file.data(), &header, sizeof(header));
+	values = reinterpret_cast<coalition::value_t*>(file.data() + FILE_VALUES_OFFSET);
+	return false;
+}
+
+void coalition_value_table::flush()
+{
+	if (!is_mapped())
+	{
+		return;
+	}
+	// The values are written before the header is marked complete.
+	file_header_t* header{ reinterpret_cast<file_header_t*>(file.data()) };
+	header->checksum = calculate_checksum();
+	file.flush();
+	header->is_complete = 1;
+	file.flush();
+	if (temporary_file_name.empty())
+	{
+		return;
+	}
+
+	// Renaming replaces a file that other tables map without changing what they see. It only fails
+	// where files in use cannot be replaced, in which case another table already generated the same values.
+	file.close();
+	std::error_code error;
+	std::filesystem::rename(temporary_file_name, file_name, error);
+	if (error)
+	{
+		if (!std::filesystem::exists(file_name))
+		{
+			throw std::runtime_error("Could not move value table file " + temporary_file_name + " to " + file_name + ": " + error.message() + ".");
+		}
+		std::filesystem::remove(temporary_file_name, error);
+	}
+	temporary_file_name.clear();
+	file.open(file_name, false);
+	values = reinterpret_cast<coalition::value_t*>(file.data() + FILE_VALUES_OFFSET);
+}
+
+bool coalition_value_table::is_mapped() const
+{
+	return file.is_open();
+}
+
+void coalition_value_table::open(const std::string& file_name, const bool verify_checksum)
+{
+	clear();
+	file.open(file_name, false);
+
+	file_header_t header{};
+	if (file.size() >= sizeof(header))
+	{
+		std::memcpy(&header, file.data(), sizeof(header));
+	}
+	const auto fail = [this, &file_name](const std::string& reason)
+	{
+		clear();
+		throw std::runtime_error("Invalid value table file " + file_name + ": " + reason + ".");
+	};
+	if (file.size() < sizeof(header) || std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0)
+	{
+		fail("not a value table file");
+	}
+	if (header.version != FILE_VERSION)
+	{
+		fail("version " + std::to_string(header.version) + " instead of " + std::to_string(FILE_VERSION));
+	}
+	if (header.is_complete != 1)
+	{
+		fail("the values are incomplete");
+	}
+	if (header.n_agents > 32 || header.layout > static_cast<uint32_t>(value_table_layout_t::COALITION_MAJOR))
+	{
+		fail("invalid header");
+	}
+
+	n_agents = header.n_agents;
+	n_tasks = header.n_tasks;
+	n_coalitions = 1ULL << n_agents;
+	layout = static_cast<value_table_layout_t>(header.layout);
+	update_strides();
+	if (file.size() != get_file_size())
+	{
+		fail("expected " + std::to_string(get_file_size()) + " bytes, found " + std::to_string(file.size()));
+	}
+	values = reinterpret_cast<coalition::value_t*>(file.data() + FILE_VALUES_OFFSET);
+
+	if (verify_checksum && calculate_checksum() != header.checksum)
+	{
+		fail("checksum mismatch");
+	}
+}
+
+void coalition_value_table::save(const std::string& file_name, const uint64_t key) const
+{
+	file_header_t header{ make_file_header(key) };
+	header.is_complete = 1;
+	header.checksum = calculate_checksum();
+
+	std::ofstream output{ file_name, std::ios::binary | std::ios::trunc };
+	std::vector<char> padding(FILE_VALUES_OFFSET - sizeof(header), 0);
+	output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	output.write(padding.data(), padding.size());
+	output.write(reinterpret_cast<const char*>(values), size() * sizeof(coalition::value_t));
+	if (!output.good())
+	{
+		throw std::runtime_error("Could not write value table file " + file_name + ".");
+	}
+}
+
+bool coalition_value_table::is_table_file(const std::string& file_name)
+{
+	char magic[sizeof(FILE_MAGIC)]{};
+	std::ifstream input{ file_name, std::ios::binary };
+	input.read(magic, sizeof(magic));
+	return input.good() && std::memcmp(magic, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0;
+}
+
+uint64_t coalition_value_table::calculate_checksum() const
+{
+	// Multiply-xorshift mixing of 8 byte words in four independent lanes, so that the loop is not
+	// bound by the latency of a single chain, followed by mixing the lanes, the tail and the size.
+	const uint64_t n_bytes{ size() * sizeof(coalition::value_t) };
+	const uint8_t* bytes{ reinterpret_cast<const uint8_t*>(values) };
+	uint64_t lanes[4]{ 0x9E3779B97F4A7C15ULL, 0xBF58476D1CE4E5B9ULL, 0x94D049BB133111EBULL, 0xD6E8FEB86659FD93ULL };
+	uint64_t n_byte{};
+	for (; n_byte + 4 * sizeof(uint64_t) <= n_bytes; n_byte += 4 * sizeof(uint64_t))
+	{
+		for (uint32_t lane{}; lane < 4; ++lane)
+		{
+			uint64_t word;
+			std::memcpy(&word, bytes + n_byte + lane * sizeof(uint64_t), sizeof(word));
+			lanes[lane] = (lanes[lane] ^ word) * 0xFF51AFD7ED558CCDULL;
+			lanes[lane] ^= lanes[lane] >> 32;
+		}
+	}
+	uint64_t tail{};
+	if (n_byte < n_bytes)
+	{
+		std::memcpy(&tail, bytes + n_byte, n_bytes - n_byte);
+	}
+
+	uint64_t checksum{ n_bytes };
+	for (const uint64_t word : { lanes[0], lanes[1], lanes[2], lanes[3], tail })
+	{
+		checksum = (checksum ^ word) * 0xC4CEB9FE1A85EC53ULL;
+		checksum ^= checksum >> 33;
+	}
+	return checksum;
+}
+
+void coalition_value_table::advise(const file_access_t access) const
+{
+	file.advise(access, FILE_VALUES_OFFSET, size() * sizeof(coalition::value_t));
+}
+
+void coalition_value_table::advise_task(const file_access_t access, const uint32_t task) const
+{
+	if (layout == value_table_layout_t::TASK_MAJOR && task < n_tasks)
+	{
+		file.advise(access, FILE_VALUES_OFFSET + task * task_stride * sizeof(coalition::value_t), n_coalitions * sizeof(coalition::value_t));
+	}
+}
+
+void coalition_value_table::set_layout(const value_table_layout_t layout)
+{
+	if (layout == this->layout)
+	{
+		return;
+	}
+	std::unique_ptr<coalition::value_t[], aligned_deleter> relaid_values{ empty() ? nullptr : allocate(size()) };
+	const uint64_t source_coalition_stride{ coalition_stride };
+	const uint64_t source_task_stride{ task_stride };
+	this->layout = layout;
+	update_strides();
+
+	if (!empty())
+	{
+		for (uint32_t task{}; task < n_tasks; ++task)
+		{
+			for (uint64_t coalition_mask{}; coalition_mask < n_coalitions; ++coalition_mask)
+			{
+				relaid_values[coalition_mask * coalition_stride + task * task_stride] =
+					values[coalition_mask * source_coalition_stride + task * source_task_stride];
+			}
+		}
+		// A mapped table keeps the layout of its file, so its values move into memory.
+		file.close();
+		allocated_values.swap(relaid_values);
+		values = allocated_values.get();
+	}
+}
+
+value_table_layout_t coalition_value_table::get_layout() const
+{
+	return layout;
+}
+
+uint32_t coalition_value_table::get_n_agents() const
+{
+	return n_agents;
+}
+
+uint32_t coalition_value_table::get_n_tasks() const
+{
+	return n_tasks;
+}
+
+uint64_t coalition_value_table::get_n_coalitions() const
+{
+	return n_coalitions;
+}
+
+uint64_t coalition_value_table::get_coalition_stride() const
+{
+	return coalition_stride;
+}
+
+uint64_t coalition_value_table::get_task_stride() const
+{
+	return task_stride;
+}
+
+uint64_t coalition_value_table::size() const
+{
+	return n_coalitions * n_tasks;
+}
+
+bool coalition_value_table::empty() const
+{
+	return values == nullptr;
+}
+
+const coalition::value_t* coalition_value_table::data() const
+{
+	return values;
+}
+
+coalition::value_t* coalition_value_table::data()
+{
+	return values;
+}
+
+void coalition_value_table::aligned_deleter::operator()(coalition::value_t* values) const
+{
+#ifdef _MSC_VER
+	_aligned_free(values);
+#else
+	std::free(values);
+#endif
+}
+
+coalition::value_t* coalition_value_table::allocate(const uint64_t n_values)
+{
+	// std::aligned_alloc requires the size to be a multiple of the alignment.
+	const uint64_t n_bytes{ std::max<uint64_t>((n_values * sizeof(coalition::value_t) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT, ALIGNMENT) };
+#ifdef _MSC_VER
+	void* memory{ _aligned_malloc(n_bytes, ALIGNMENT) };
+#else
+	void* memory{ std::aligned_alloc(ALIGNMENT, n_bytes) };
+#endif
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return static_cast<coalition::value_t*>(memory);
+}
+
+coalition_value_table::file_header_t coalition_value_table::make_file_header(const uint64_t key) const
+{
+	file_header_t header{};
+	std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+	header.version = FILE_VERSION;
+	header.n_agents = n_agents;
+	header.n_tasks = n_tasks;
+	header.layout = static_cast<uint32_t>(layout);
+	header.key = key;
+	return header;
+}
+
+uint64_t coalition_value_table::get_file_size() const
+{
+	return FILE_VALUES_OFFSET + size() * sizeof(coalition::value_t);
+}
+
+void coalition_value_table::update_strides()
+{
+	if (layout == value_table_layout_t::TASK_MAJOR)
+	{
+		coalition_stride = 1;
+		task_stride = n_coalitions;
+	}
+	else
+	{
+		coalition_stride = n_tasks;
+		task_stride = 1;
+	}
+}
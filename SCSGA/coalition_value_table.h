@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "coalition.h"
+#include "mapped_file.h"
+
+/*
+	Order in which a coalition_value_table stores its values.
+
+	TASK_MAJOR			All coalitions of task 0, then all coalitions of task 1 and so on,
+						i.e. the value of (mask, task) is at task * 2^n + mask. Suits solvers
+						that sweep the coalitions of one task, e.g. DP and the task greedy solver.
+	COALITION_MAJOR		The values of all tasks for coalition 0, then for coalition 1 and so
+						on, i.e. the value of (mask, task) is at mask * m + task. Suits solvers
+						that evaluate one coalition across many tasks, e.g. the agent greedy,
+						hill climbing and annealing moves.
+*/
+enum class value_table_layout_t
+{
+	TASK_MAJOR, COALITION_MAJOR
+};
+
+/*
+	Values of all coalitions of a problem with at most 32 agents, for all tasks, stored in
+	a single contiguous buffer aligned to the cache line size. The layout only changes the
+	order of the values in memory, never the values themselves, and may be changed at any
+	time, in which case the values are moved to their new positions.
+
+	The buffer is either allocated in memory (reset) or a memory-mapped file (map, open),
+	which lets problems whose values do not fit in memory be solved, as the operating
+	system pages the values in on demand. Solvers pass their access pattern on with
+	advise, which only has an effect on mapped tables.
+
+	Table files are also the binary problem file format. A file starts with a versioned
+	header holding the number of agents and tasks, the layout, a key identifying the
+	values, whether the values are complete and a checksum of the values, which follow
+	as raw floats at a page aligned offset. Opening a file maps it as is, so loading
+	takes constant time regardless of its size.
+*/
+class coalition_value_table
+{
+public:
+	static constexpr size_t ALIGNMENT{ 64 };
+
+	coalition_value_table() = default;
+	~coalition_value_table();
+
+	// Allocates zero initialized values for all coalitions of n_agents agents and n_tasks tasks.
+	void reset(const uint32_t n_agents, const uint32_t n_tasks);
+	void reset(const uint32_t n_agents, const uint32_t n_tasks, const value_table_layout_t layout);
+	void clear();
+	/*
+		Maps the values of n_agents agents and n_tasks tasks in the current layout to file_name.
+		If the file holds complete values of the same size, layout and key, they are mapped
+		read-only and must not be changed. Otherwise a new temporary file next to it is mapped
+		with all values zero, which flush moves to file_name, so that a file is never changed
+		while other tables, possibly of other processes, map it. The key identifies the values,
+		e.g. the seed they were generated from. Returns true if the values were reused.
+		Throws std::runtime_error if the file cannot be created or mapped.
+	*/
+	bool map(const std::string& file_name, const uint32_t n_agents, const uint32_t n_tasks, const uint64_t key);
+	/*
+		Writes the values generated into a mapped table and their checksum to its file, marks them
+		as complete and moves the file to the name given to map. Throws std::runtime_error if the
+		file cannot be moved.
+	*/
+	void flush();
+	bool is_mapped() const;
+
+	/*
+		Maps the complete values of a table file read-only, in the layout of the file. The checksum
+		is only verified on request, as that reads all values. The values must not be changed.
+		Throws std::runtime_error if the file cannot be mapped, is not a table file of this version,
+		is incomplete or, if verified, does not match its checksum.
+	*/
+	void open(const std::string& file_name, const bool verify_checksum = false);
+	// Writes the values to a new table file with the given key. Throws std::runtime_error if it cannot be written.
+	void save(const std::string& file_name, const uint64_t key = 0) const;
+	// True if the file starts like a table file, of any version.
+	static bool is_table_file(const std::string& file_name);
+	uint64_t calculate_checksum() const;
+
+	// Access hints for mapped tables, for all values or for the values of one task.
+	// Task hints only apply to the task major layout, as the values of a task are spread over the whole table otherwise.
+	void advise(const file_access_t access) const;
+	void advise_task(const file_access_t access, const uint32_t task) const;
+
+	void set_layout(const value_table_layout_t layout);
+	value_table_layout_t get_layout() const;
+
+	uint32_t get_n_agents() const;
+	uint32_t get_n_tasks() const;
+	uint64_t get_n_coalitions() const;
+	uint64_t size() const;
+	bool empty() const;
+
+	const coalition::value_t* data() const;
+	coalition::value_t* data();
+
+	// The values of (mask, task) and (mask + 1, task) are get_coalition_stride() apart, those of (mask, task) and (mask, task + 1) get_task_stride().
+	uint64_t get_coalition_stride() const;
+	uint64_t get_task_stride() const;
+	uint64_t get_index(const uint32_t coalition_agent_mask, const uint32_t task) const;
+	coalition::value_t get_value_of(const uint32_t coalition_agent_mask, const uint32_t task) const;
+	void set_value_of(const uint32_t coalition_agent_mask, const uint32_t task, const coalition::value_t value);
+
+private:
+	struct aligned_deleter
+	{
+		void operator()(coalition::value_t* values) const;
+	};
+
+	// Header of a mapped table file. The values start at FILE_VALUES_OFFSET, so that they are page aligned.
+	struct file_header_t
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t n_agents;
+		uint32_t n_tasks;
+		uint32_t layout;
+		uint64_t key;
+		uint64_t is_complete;
+		uint64_t checksum;
+	};
+	static constexpr char FILE_MAGIC[8]{ 'S', 'C', 'S', 'G', 'A', 'V', 'T', '\0' };
+	static constexpr uint32_t FILE_VERSION{ 2 };
+	static constexpr uint64_t FILE_VALUES_OFFSET{ 4096 };
+
+	std::unique_ptr<coalition::value_t[], aligned_deleter> allocated_values;
+	mapped_file file;
+	std::string file_name; // That the file being generated by a mapped table is moved to by flush.
+	std::string temporary_file_name; // Of the file being generated by a mapped table, empty otherwise.
+	coalition::value_t* values{ nullptr };
+	value_table_layout_t layout{ value_table_layout_t::TASK_MAJOR };
+	uint32_t n_agents{};
+	uint32_t n_tasks{};
+	uint64_t n_coalitions{};
+
+	// The index of (mask, task) is mask * coalition_stride + task * task_stride for either layout.
+	uint64_t coalition_stride{ 1 };
+	uint64_t task_stride{};
+
+	static coalition::value_t* allocate(const uint64_t n_values);
+	file_header_t make_file_header(const uint64_t key) const;
+	uint64_t get_file_size() const;
+	void update_strides();
+};
+
+inline uint64_t coalition_value_table::get_index(const uint32_t coalition_agent_mask, const uint32_t task) const
+{
+	assert(coalition_agent_mask < n_coalitions && task < n_tasks);
+	return coalition_agent_mask * coalition_stride + task * task_stride;
+}
+
+inline coalition::value_t coalition_value_table::get_value_of(const uint32_t coalition_agent_mask, const uint32_t task) const
+{
+	return values[get_index(coalition_agent_mask, task)];
+}
+
+inline void coalition_value_table::set_value_of(const uint32_t coalition_agent_mask, const uint32_t task, const coalition::value_t value)
+{
+	values[get_index(coalition_agent_mask, task)] = value;
+}
@@ -1,10 +1,13 @@
 #include "coalitional_values_generator.h"
 
-#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "utility.h"
 
 coalitional_values_generator::~coalitional_values_generator()
 {
-	if (generated_values.size() > 50000000)	std::cout << generated_values.size() << " exceeded reserved." << std::endl;
 	if (n_agents > MAX_AGENTS_IN_TABLE && seed >= 0)
 	{
 #ifdef SAVE_PROBLEMS_TO_FILE
@@ -34,42 +37,133 @@ uint32_t coalitional_values_generator::get_n_value_table_size() const
 	return generated_values.size();
 }
 
-const std::vector<std::vector<coalition::value_t>>& coalitional_values_generator::get_data() const
+value_cache_statistics_t coalitional_values_generator::get_value_cache_statistics() const
+{
+	return generated_values.get_statistics();
+}
+
+void coalitional_values_generator::set_value_cache_budget(const uint64_t budget)
+{
+	generated_values.set_memory_budget(budget);
+}
+
+value_table_layout_t coalitional_values_generator::get_value_table_layout() const
+{
+	return value_table.get_layout();
+}
+
+void coalitional_values_generator::set_value_table_layout(const value_table_layout_t layout)
+{
+	value_table.set_layout(layout);
+}
+
+value_generation_t coalitional_values_generator::get_value_generation() const
+{
+	return value_generation;
+}
+
+void coalitional_values_generator::set_value_generation(const value_generation_t value_generation, const uint32_t n_threads)
+{
+	if (value_generation == value_generation_t::COUNTER_BASED && !supports_counter_based_generation())
+	{
+		throw std::invalid_argument("Counter-based value generation is not supported by this distribution.");
+	}
+	force_regeneration = force_regeneration || value_generation != this->value_generation;
+	this->value_generation = value_generation;
+	n_generation_threads = n_threads;
+}
+
+bool coalitional_values_generator::supports_counter_based_generation() const
+{
+	return false;
+}
+
+const std::string& coalitional_values_generator::get_value_table_directory() const
+{
+	return value_table_directory;
+}
+
+void coalitional_values_generator::set_value_table_directory(const std::string& directory)
+{
+	force_regeneration = force_regeneration || directory != value_table_directory;
+	value_table_directory = directory;
+}
+
+const coalition_value_table& coalitional_values_generator::get_data() const
+{
+	return value_table;
+}
+
+value_bounds_t coalitional_values_generator::get_value_bounds()
+{
+	value_bounds_t bounds{};
+	if (n_agents <= MAX_AGENTS_IN_TABLE)
+	{
+		bounds.max_value_of_size = get_value_statistics().max_value_of_size;
+	}
+	return bounds;
+}
+
+const value_statistics_t& coalitional_values_generator::get_value_statistics(const uint32_t n_threads)
 {
-	return task_coalition_value;
+	if (!has_value_statistics)
+	{
+		value_statistics = value_statistics::calculate(value_table, n_threads);
+		has_value_statistics = true;
+	}
+	return value_statistics;
+}
+
+void coalitional_values_generator::invalidate_value_statistics()
+{
+	value_statistics = value_statistics_t{};
+	has_value_statistics = false;
 }
 
 coalition::value_t coalitional_values_generator::get_value_of(const coalition::coalition_t& coalition, const uint32_t n_task)
 {
 	if (n_agents <= MAX_AGENTS_IN_TABLE)
 	{
-		return task_coalition_value[n_task][coalition.get_agent_mask()];
+		return value_table.get_value_of(coalition.get_agent_mask(), n_task);
 	}
 	else
 	{
-		const auto it{ generated_values.find({coalition, n_task}) };
-		if (it == generated_values.end())
-		{
-			coalition::value_t value{ generate_new_value(coalition, n_task) };
-			generated_values[{coalition, n_task}] = value;
-			return value;
-		}
-		else
+		coalition::value_t value;
+		if (!generated_values.find(coalition, n_task, value))
 		{
-			return it->second;
+			const uint64_t value_key{ get_value_key(coalition, n_task) };
+			if (value_generation == value_generation_t::COUNTER_BASED)
+			{
+				value = generate_counter_based_value(coalition.count_agents_in_coalition(), n_task, value_key);
+			}
+			else
+			{
+				seed_value_generator(value_key);
+				value = generate_new_value(coalition, n_task);
+			}
+			generated_values.insert(coalition, n_task, value);
 		}
+		return value;
 	}
 }
 
 coalition::value_t coalitional_values_generator::get_value_of(const uint32_t coalition_agent_mask, const uint32_t n_task) const
 {
 	assert(n_agents <= MAX_AGENTS_IN_TABLE);
-	return task_coalition_value[n_task][coalition_agent_mask];
+	return value_table.get_value_of(coalition_agent_mask, n_task);
 }
 
 void coalitional_values_generator::generate_coalitional_values(unsigned int n_agents, unsigned int n_tasks, int seed)
 {
-	if (seed == -1 || n_agents != this->n_agents || n_tasks != this->n_tasks || seed != this->seed) {
+	if (n_agents > coalition::coalition_t::CAPACITY)
+	{
+		throw std::invalid_argument(
+			"Problems with " + std::to_string(n_agents) + " agents require building with COALITION_MAX_AGENTS >= "
+			+ std::to_string(n_agents) + " (currently " + std::to_string(coalition::coalition_t::CAPACITY) + ")."
+		);
+	}
+
+	if (force_regeneration || seed == -1 || n_agents != this->n_agents || n_tasks != this->n_tasks || seed != this->seed) {
 		// Only regenerate if a new problem is requested.
 #ifdef SAVE_PROBLEMS_TO_FILE
 		if (seed >= 0 && generated_values.size() > 0)
@@ -80,84 +174,165 @@ void coalitional_values_generator::generate_coalitional_values(unsigned int n_ag
 		this->n_agents = n_agents;
 		this->n_tasks = n_tasks;
 		this->seed = seed;
-		generated_values.clear();
-		task_coalition_value.clear();
+		force_regeneration = false;
+		// Like the engines of the generators, a negative seed continues from the previous problem.
+		lazy_values_seed = utility::random::splitmix64(seed >= 0 ? static_cast<uint64_t>(seed) : lazy_values_seed);
+		generated_values.reset(n_agents);
+		value_table.clear();
+		invalidate_value_statistics();
 		reset(n_agents, n_tasks, seed);
-		file_name = "data/" + get_file_name();	// This result must be saved, as it is used in the base class destructor.
+		file_name = get_file_name();	// This result must be saved, as it is used in the base class destructor.
 
-		if (n_agents <= MAX_AGENTS_IN_TABLE)
+		if (n_agents <= MAX_AGENTS_IN_TABLE && allocate_value_table(n_agents, n_tasks))
+		{
+			// The values were generated before and are read from the mapped file.
+		}
+		else if (n_agents <= MAX_AGENTS_IN_TABLE && value_generation == value_generation_t::COUNTER_BASED)
 		{
-			// Generate coalitional values.
-			const uint32_t n_coalitions{ 1U << n_agents };
+			generate_counter_based_values(n_agents, n_tasks);
+			value_table.flush();
+		}
+		else if (n_agents <= MAX_AGENTS_IN_TABLE)
+		{
+			// Generate coalitional values. They are always drawn task by task, so that the values do not depend on the layout.
+			const uint64_t n_coalitions{ 1ULL << n_agents };
 			coalition::coalition_t coalition(n_agents);
-			task_coalition_value.resize(n_tasks);
-			for (uint32_t task{}; task < n_tasks; ++task) {
-				task_coalition_value[task].resize(n_coalitions);
-			}
 			for (uint32_t task{}; task < n_tasks; ++task)
 			{
-				for (uint32_t coalition_mask{}; coalition_mask < n_coalitions; ++coalition_mask)
+				for (uint64_t coalition_mask{}; coalition_mask < n_coalitions; ++coalition_mask)
 				{
-					coalition.set_value(coalition_mask);
-					task_coalition_value[task][coalition_mask] = generate_new_value(coalition, task);
+					coalition.set_value(static_cast<uint32_t>(coalition_mask));
+					value_table.set_value_of(static_cast<uint32_t>(coalition_mask), task, generate_new_value(coalition, task));
 				}
 			}
+			value_table.flush();
 #ifdef SAVE_PROBLEMS_TO_FILE
 		} else if (seed >= 0) {
 			load_generated_values(get_file_name());
 #endif
-		} else {
-			generated_values.reserve(50000000);
 		}
 	}
 }
 
-void coalitional_values_generator::save_generated_values(const std::string& file_name)
+void coalitional_values_generator::seed_value_generator(const uint64_t /*value_seed*/)
 {
-	std::filesystem::create_directory(DATA_DIR);
-	std::ofstream output{ DATA_DIR + file_name, std::ios::binary };
-	output << std::setprecision(10);
-	for (const auto it : generated_values)
+	// Generators that do not draw values at random are already reproducible.
+}
+
+coalition::value_t coalitional_values_generator::generate_counter_based_value(const uint32_t /*n_agents_in_coalition*/, const uint32_t /*task*/, const uint64_t /*value_key*/) const
+{
+	throw std::logic_error("Counter-based value generation is not supported by this distribution.");
+}
+
+void coalitional_values_generator::generate_counter_based_block(const uint32_t task, const uint64_t task_key, const uint64_t first_coalition_mask,
+	const uint32_t n_coalitions, coalition::value_t* values) const
+{
+	for (uint32_t index{}; index < n_coalitions; ++index)
 	{
-		const coalition::coalition_t coalition{ it.first.first };
-		const uint32_t task{ it.first.second };
-		const coalition::value_t value{ it.second };
-		const std::vector<uint32_t> agents_in_coalition{ coalition.get_all_agents() };
-		const uint32_t n_agents_in_coalition{ static_cast<uint32_t>(agents_in_coalition.size()) };
-
-		output << n_agents_in_coalition;
-		for (const uint32_t agent : agents_in_coalition)
-		{
-			output << " " << agent;
-		}
-		output << " " << task << " " << value << "\n";
+		const uint64_t coalition_mask{ first_coalition_mask + index };
+		const uint32_t n_agents_in_coalition{ utility::bits::bit_count_32bit(static_cast<uint32_t>(coalition_mask)) };
+		values[index] = generate_counter_based_value(n_agents_in_coalition, task, get_counter_based_value_key(task_key, coalition_mask));
 	}
-	output.close();
 }
 
-void coalitional_values_generator::load_generated_values(const std::string& file_name)
+bool coalitional_values_generator::allocate_value_table(const uint32_t n_agents, const uint32_t n_tasks)
 {
-	std::ifstream input{ DATA_DIR + file_name };
-	while (true)
+	// Sequential values of a negative seed continue from the engine state left by earlier problems, which the
+	// key does not identify, so they are only kept in memory.
+	if (value_table_directory.empty() || (seed < 0 && value_generation == value_generation_t::SEQUENTIAL))
 	{
-		uint32_t n_agents_in_coalition, task;
-		coalition::value_t value;
-		coalition::coalition_t coalition(n_agents);
+		value_table.reset(n_agents, n_tasks);
+		return false;
+	}
 
-		input >> n_agents_in_coalition;
-		if (!input)
-		{
-			break;
-		}
-		for (uint32_t i{}; i < n_agents_in_coalition; ++i)
+	// The key tells values generated from different seeds or in different modes apart. It and the layout
+	// are part of the file name, so that tables of the same problem in other layouts or modes, which may
+	// be mapped by other processes sharing the directory, are separate files.
+	std::filesystem::create_directories(value_table_directory);
+	const uint64_t key{ utility::random::splitmix64(lazy_values_seed ^ static_cast<uint64_t>(value_generation) ^ (static_cast<uint64_t>(GENERATED_VALUES_VERSION) << 32)) };
+	std::ostringstream table_file_name;
+	table_file_name << std::filesystem::path(get_file_name()).replace_extension("").string()
+		<< (value_table.get_layout() == value_table_layout_t::TASK_MAJOR ? "_task_major_" : "_coalition_major_")
+		<< std::hex << std::setw(16) << std::setfill('0') << key << ".values";
+	return value_table.map((std::filesystem::path(value_table_directory) / table_file_name.str()).string(), n_agents, n_tasks, key);
+}
+
+uint64_t coalitional_values_generator::get_value_key(const coalition::coalition_t& coalition, const uint32_t task) const
+{
+	uint64_t value_key{ utility::random::splitmix64(lazy_values_seed ^ task) };
+	for (uint32_t word_index{}; word_index < coalition.get_n_words(); ++word_index)
+	{
+		value_key = utility::random::splitmix64(value_key ^ coalition.get_word(word_index));
+	}
+	return value_key;
+}
+
+void coalitional_values_generator::generate_counter_based_values(const uint32_t n_agents, const uint32_t n_tasks)
+{
+	// Each work item covers a range of coalitions for all tasks. The ranges start at multiples of
+	// the block size in either layout, so no two threads write to the same cache line. The keys are
+	// the same as those of get_value_key for a single word. The values of a task are generated into
+	// a contiguous buffer, so that the loop of the generator does not depend on the layout.
+	const uint64_t n_coalitions{ 1ULL << n_agents };
+	const uint64_t n_blocks{ (n_coalitions + COUNTER_BASED_BLOCK_SIZE - 1) / COUNTER_BASED_BLOCK_SIZE };
+	utility::parallel::for_each_index(n_blocks, n_generation_threads, [this, n_coalitions, n_tasks](const uint64_t n_block)
+	{
+		const uint64_t first_mask{ n_block * COUNTER_BASED_BLOCK_SIZE };
+		const uint32_t n_block_coalitions{ static_cast<uint32_t>(std::min<uint64_t>(COUNTER_BASED_BLOCK_SIZE, n_coalitions - first_mask)) };
+		std::vector<coalition::value_t> block_values(n_block_coalitions);
+		for (uint32_t task{}; task < n_tasks; ++task)
 		{
-			uint32_t agent{ };
-			input >> agent;
-			coalition.add_agent(agent);
+			const uint64_t task_key{ utility::random::splitmix64(lazy_values_seed ^ task) };
+			generate_counter_based_block(task, task_key, first_mask, n_block_coalitions, block_values.data());
+			for (uint32_t index{}; index < n_block_coalitions; ++index)
+			{
+				value_table.set_value_of(static_cast<uint32_t>(first_mask + index), task, block_values[index]);
+			}
 		}
-		input >> task >> value;
-		generated_values[{coalition, task}] = value;
-		generate_new_value(coalition, task); // Discard values to restore generator state.
+	});
+}
+
+void coalitional_values_generator::save_generated_values(const std::string& file_name)
+{
+	generated_values_header_t header{};
+	std::memcpy(header.magic, GENERATED_VALUES_MAGIC, sizeof(GENERATED_VALUES_MAGIC));
+	header.version = GENERATED_VALUES_VERSION;
+	header.n_agents = n_agents;
+	header.n_tasks = n_tasks;
+	header.value_generation = static_cast<uint32_t>(value_generation);
+	header.lazy_values_seed = lazy_values_seed;
+	header.n_entries = generated_values.size();
+
+	// The values are written to a temporary file first, so that an interrupted save never leaves a truncated file behind.
+	std::filesystem::create_directory(DATA_DIR);
+	const std::string temporary_file_name{ DATA_DIR + file_name + ".tmp" };
+	std::ofstream output{ temporary_file_name, std::ios::binary | std::ios::trunc };
+	output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	generated_values.write_entries(output);
+	output.close();
+	if (output)
+	{
+		std::filesystem::rename(temporary_file_name, DATA_DIR + file_name);
+	}
+}
+
+void coalitional_values_generator::load_generated_values(const std::string& file_name)
+{
+	std::ifstream input{ DATA_DIR + file_name, std::ios::binary };
+	generated_values_header_t header{};
+	input.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+	// Files of other problems, generation modes or versions, including the former text format, are ignored and their values generated again.
+	if (!input || std::memcmp(header.magic, GENERATED_VALUES_MAGIC, sizeof(GENERATED_VALUES_MAGIC)) != 0
+		|| header.version != GENERATED_VALUES_VERSION || header.n_agents != n_agents || header.n_tasks != n_tasks
+		|| header.value_generation != static_cast<uint32_t>(value_generation) || header.lazy_values_seed != lazy_values_seed)
+	{
+		return;
+	}
+	if (!generated_values.read_entries(input, header.n_entries, n_tasks))
+	{
+		// Entries of a damaged file cannot be trusted.
+		generated_values.reset(n_agents);
 	}
-	input.close();
+	generated_values.reset_statistics();
 }
@@ -3,25 +3,54 @@
 #include <random>
 #include <cstring>
 #include <cassert>
-#include <unordered_map>
 #include <fstream>
 #include <filesystem>
 #include <iomanip>
 
 #include "coalition.h"
+#include "coalition_value_cache.h"
+#include "coalition_value_table.h"
+#include "coalition_value_statistics.h"
+#include "max_plus.h"
+#include "utility.h"
 
-namespace std
+// The counter-based blocks are compiled for the vector instructions of max_plus and selected at runtime.
+#if defined(__GNUG__) && (defined(__x86_64__) || defined(__i386__))
+#define COUNTER_BASED_X86
+#define COUNTER_BASED_TARGET(target_name) __attribute__((target(target_name)))
+#endif
+
+/*
+	How the values of a problem are drawn.
+
+	SEQUENTIAL		Values are drawn one after another from the engine of the generator,
+					which is seeded once per problem.
+	COUNTER_BASED	Every value is a pure function of the seed, the task and the coalition,
+					computed with a counter-based generator (SplitMix64) instead of an
+					engine. The values of problems with at most 32 agents are therefore
+					generated on several threads, with the same result for any number of
+					threads. Only supported by some generators, see
+					supports_counter_based_generation.
+*/
+enum class value_generation_t
 {
-	template<>
-	struct hash<std::pair<coalition::coalition_t, uint32_t>>
-	{
-		std::size_t operator()(const std::pair<coalition::coalition_t, uint32_t>& pair) const noexcept
-		{
-			const std::size_t coalition_hash{ std::hash<coalition::coalition_t>{}(pair.first) };
-			return (coalition_hash << 5) + coalition_hash + pair.second;
-		}
-	};
-}
+	SEQUENTIAL, COUNTER_BASED
+};
+
+/*
+	Upper bounds on the values of a problem, used to prune exact searches. A vector is empty if
+	the generator cannot bound it.
+
+	max_value_of_size	max_value_of_size[task][k] is at least the value of every coalition of
+						k agents for task, for k = 0..n.
+	max_marginal_value	max_marginal_value[task][agent] is at least the value gained by adding
+						agent to any coalition for task.
+*/
+struct value_bounds_t
+{
+	std::vector<std::vector<coalition::value_t>> max_value_of_size;
+	std::vector<std::vector<coalition::value_t>> max_marginal_value;
+};
 
 class coalitional_values_generator
 {
@@ -36,8 +65,39 @@ public:
 	uint32_t get_n_tasks() const;
 	uint32_t get_n_coalitions() const;
 	uint32_t get_n_value_table_size() const;
+	value_cache_statistics_t get_value_cache_statistics() const; // Only used for problems with more than 32 agents.
+	void set_value_cache_budget(const uint64_t budget); // In bytes, 0 for no limit. Only used for problems with more than 32 agents.
+	value_table_layout_t get_value_table_layout() const;
+	void set_value_table_layout(const value_table_layout_t layout); // Only used for problems with at most 32 agents.
+	value_generation_t get_value_generation() const;
+	// Used from the next call to generate_coalitional_values, which then always generates new values. n_threads == 0 uses all hardware threads.
+	// Throws std::invalid_argument if the generator does not support the requested generation.
+	void set_value_generation(const value_generation_t value_generation, const uint32_t n_threads = 0);
+	virtual bool supports_counter_based_generation() const;
+	const std::string& get_value_table_directory() const;
+	/*
+		Used from the next call to generate_coalitional_values. If not empty, the values of problems
+		with at most 32 agents are kept in a memory-mapped file in directory instead of in memory, so
+		that they are paged in on demand and may exceed the available memory. The file is named after
+		the problem and generated once, later problems with the same values map it again. Sequential
+		values of a negative seed depend on the earlier problems and are always kept in memory.
+	*/
+	void set_value_table_directory(const std::string& directory);
 
-	const std::vector<std::vector<coalition::value_t>>& get_data() const;
+	const coalition_value_table& get_data() const;
+	/*
+		Returns upper bounds on the values of the problem. For problems with at most 32 agents, the
+		size bounds are the largest values of each size in the table. Problems with more agents only
+		have the bounds their generator derives from its distribution.
+	*/
+	virtual value_bounds_t get_value_bounds();
+	/*
+		Returns the largest and mean value of each coalition size, see value_statistics_t. They are
+		calculated on n_threads threads (0 for one per hardware thread) the first time they are
+		requested for a problem and cached until its values change, so that solvers of the same
+		problem share them. Empty for problems with more than 32 agents.
+	*/
+	const value_statistics_t& get_value_statistics(const uint32_t n_threads = 0);
 
 	virtual coalition::value_t generate_new_value(const coalition::coalition_t& coalition, const uint32_t n_task) = 0;
 	virtual coalition::value_t get_value_of(const coalition::coalition_t& coalition, const uint32_t n_task);
@@ -47,18 +107,152 @@ public:
 	virtual void generate_coalitional_values(unsigned int n_agents, unsigned int n_tasks, int seed = 0);
 
 protected:
-	std::vector<std::vector<coalition::value_t>> task_coalition_value;
-	std::unordered_map<std::pair<coalition::coalition_t, uint32_t>, coalition::value_t> generated_values;
+	coalition_value_table value_table;
+	coalition_value_cache generated_values;
 
 	uint32_t n_agents{};
 	uint32_t n_tasks{};
 	int seed{};
+	uint64_t lazy_values_seed{};
+	value_generation_t value_generation{ value_generation_t::SEQUENTIAL };
+	uint32_t n_generation_threads{};
+	bool force_regeneration{ false };
 
 	virtual std::string get_file_name() const = 0;
 	virtual void reset(const uint32_t n_agents, const uint32_t n_tasks, const int seed = 0) = 0;
 
+	/*
+		Called before generate_new_value for problems with more than 32 agents, with a seed
+		derived from the problem seed, the coalition and the task. Generators that draw values
+		at random must reseed their engine with it and discard any state their distributions
+		keep between draws, so that a value only depends on its coalition and task and can be
+		regenerated exactly after being evicted from the value cache.
+	*/
+	virtual void seed_value_generator(const uint64_t value_seed);
+
+	/*
+		Returns the value of a coalition of n_agents_in_coalition agents for task, drawn with
+		the counter-based generator from value_key, which is derived from the problem seed, the
+		task and the coalition. Only used when the values are generated COUNTER_BASED. Must
+		neither depend on nor change any state other than the parameters of the distribution,
+		as it is called concurrently from several threads.
+	*/
+	virtual coalition::value_t generate_counter_based_value(const uint32_t n_agents_in_coalition, const uint32_t task, const uint64_t value_key) const;
+
+	/*
+		Writes the values of the n_coalitions coalitions from first_coalition_mask on for task to
+		values, each equal to generate_counter_based_value with the key get_counter_based_value_key
+		of task_key, the key of the task. Called for blocks of coalitions of problems with at most
+		32 agents. The default calls generate_counter_based_value for every coalition, generators
+		override it with a loop without calls, which the compiler can vectorize.
+	*/
+	virtual void generate_counter_based_block(const uint32_t task, const uint64_t task_key, const uint64_t first_coalition_mask,
+		const uint32_t n_coalitions, coalition::value_t* values) const;
+
+	static uint64_t get_counter_based_value_key(const uint64_t task_key, const uint64_t coalition_mask)
+	{
+		return utility::random::splitmix64(task_key ^ coalition_mask);
+	}
+
+	/*
+		Stores draw(value_key) for the n_coalitions coalitions from first_coalition_mask on to
+		values, with the keys of get_counter_based_value_key, for generate_counter_based_block.
+		The loop is also compiled for AVX-512 and AVX2, selected at runtime, so that the 64-bit
+		arithmetic of the keys is vectorized in builds for any x86 CPU. It only vectorizes if draw
+		is inlined and has no calls or branches.
+	*/
+	template<typename Draw>
+	static void draw_counter_based_block(const uint64_t task_key, const uint64_t first_coalition_mask, const uint32_t n_coalitions,
+		coalition::value_t* values, const Draw& draw);
+
+	// Must be called whenever values of the table change outside of generate_coalitional_values.
+	void invalidate_value_statistics();
+
 private:
+	static const uint32_t COUNTER_BASED_BLOCK_SIZE{ 1U << 14 }; // Coalitions per parallel work item.
+
+	/*
+		Header of a file of lazily generated values, saved and loaded with SAVE_PROBLEMS_TO_FILE.
+		The entries of the value cache follow, see coalition_value_cache::write_entries. Besides
+		the size of the problem, the header records the state the values were generated from, so
+		that a file is only loaded if it holds exactly the values that would be generated now.
+	*/
+	struct generated_values_header_t
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t n_agents;
+		uint32_t n_tasks;
+		uint32_t value_generation;
+		uint64_t lazy_values_seed;
+		uint64_t n_entries;
+	};
+	static constexpr char GENERATED_VALUES_MAGIC[8]{ 'S', 'C', 'S', 'G', 'A', 'L', 'V', '\0' };
+	static constexpr uint32_t GENERATED_VALUES_VERSION{ 2 }; // Also tells mapped value tables of other versions apart.
+
 	std::string file_name{};
+	std::string value_table_directory{};
+	value_statistics_t value_statistics{};
+	bool has_value_statistics{ false };
+	// Allocates or maps the value table. Returns true if it was mapped to a file that already holds the values.
+	bool allocate_value_table(const uint32_t n_agents, const uint32_t n_tasks);
+	uint64_t get_value_key(const coalition::coalition_t& coalition, const uint32_t task) const;
+	void generate_counter_based_values(const uint32_t n_agents, const uint32_t n_tasks);
 	void save_generated_values(const std::string& file_name);
 	void load_generated_values(const std::string& file_name);
 };
+
+namespace counter_based
+{
+	template<typename Draw>
+	inline void draw_block(const uint64_t task_key, const uint64_t first_coalition_mask, const uint32_t n_coalitions,
+		coalition::value_t* values, const Draw& draw)
+	{
+		for (uint32_t index{}; index < n_coalitions; ++index)
+		{
+			values[index] = draw(utility::random::splitmix64(task_key ^ (first_coalition_mask + index)));
+		}
+	}
+
+#ifdef COUNTER_BASED_X86
+	template<typename Draw>
+	COUNTER_BASED_TARGET("avx2") void draw_block_avx2(const uint64_t task_key, const uint64_t first_coalition_mask, const uint32_t n_coalitions,
+		coalition::value_t* values, const Draw& draw)
+	{
+		for (uint32_t index{}; index < n_coalitions; ++index)
+		{
+			values[index] = draw(utility::random::splitmix64(task_key ^ (first_coalition_mask + index)));
+		}
+	}
+
+	template<typename Draw>
+	COUNTER_BASED_TARGET("avx512f") void draw_block_avx512(const uint64_t task_key, const uint64_t first_coalition_mask, const uint32_t n_coalitions,
+		coalition::value_t* values, const Draw& draw)
+	{
+		for (uint32_t index{}; index < n_coalitions; ++index)
+		{
+			values[index] = draw(utility::random::splitmix64(task_key ^ (first_coalition_mask + index)));
+		}
+	}
+#endif
+}
+
+template<typename Draw>
+void coalitional_values_generator::draw_counter_based_block(const uint64_t task_key, const uint64_t first_coalition_mask, const uint32_t n_coalitions,
+	coalition::value_t* values, const Draw& draw)
+{
+#ifdef COUNTER_BASED_X86
+	static const max_plus_kernel_t kernel{ max_plus::get_best_kernel() };
+	if (kernel == max_plus_kernel_t::AVX512)
+	{
+		counter_based::draw_block_avx512(task_key, first_coalition_mask, n_coalitions, values, draw);
+		return;
+	}
+	if (kernel == max_plus_kernel_t::AVX2)
+	{
+		counter_based::draw_block_avx2(task_key, first_coalition_mask, n_coalitions, values, draw);
+		return;
+	}
+#endif
+	counter_based::draw_block(task_key, first_coalition_mask, n_coalitions, values, draw);
+}
@@ -43,6 +43,12 @@ void coalitional_values_generator_MPD::reset
 	*/
 }
 
+void coalitional_values_generator_MPD::seed_value_generator(const uint64_t value_seed)
+{
+	generator.seed(value_seed);
+	error_generator.reset();
+}
+
 coalition::value_t coalitional_values_generator_MPD::generate_new_value(
 	const coalition::coalition_t& coalition, const uint32_t task
 )
@@ -52,15 +58,15 @@ coalition::value_t coalitional_values_generator_MPD::generate_new_value(
 	uint32_t skill_value_samples = 0;
 	coalition::value_t relation_value = 0.0f;
 	uint32_t relation_value_samples = 0;
-	std::vector<uint32_t> agents_in_coalition{ coalition.get_all_agents() };
-	for (uint32_t i = 0; i < agents_in_coalition.size(); ++i)
+	const auto agents_in_coalition{ coalition.agents() };
+	for (auto it_i = agents_in_coalition.begin(); it_i != agents_in_coalition.end(); ++it_i)
 	{
-		uint32_t n_agent_index_i = agents_in_coalition[i];
+		uint32_t n_agent_index_i = *it_i;
 		skill_value += AgentToTaskSkillLevel[n_agent_index_i][task];
 		++skill_value_samples;
-		for (uint32_t j = i + 1; j < agents_in_coalition.size(); ++j)
+		for (auto it_j = std::next(it_i); it_j != agents_in_coalition.end(); ++it_j)
 		{
-			uint32_t n_agent_index_j = agents_in_coalition[j];
+			uint32_t n_agent_index_j = *it_j;
 			relation_value += AgentToAgentToTaskSkillLevel[n_agent_index_i][n_agent_index_j][task];
 			++relation_value_samples;
 		}
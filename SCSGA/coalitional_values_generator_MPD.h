@@ -10,6 +10,7 @@ public:
 protected:
 	std::string get_file_name() const override;
 	void reset(uint32_t n_agents, uint32_t n_tasks, int seed = 0) override;
+	void seed_value_generator(const uint64_t value_seed) override;
 
 private:
 	std::default_random_engine generator;
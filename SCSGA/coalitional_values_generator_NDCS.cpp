@@ -27,6 +27,52 @@ void coalitional_values_generator_NDCS::reset
 	}
 }
 
+void coalitional_values_generator_NDCS::seed_value_generator(const uint64_t value_seed)
+{
+	generator.seed(value_seed);
+	for (auto& ndcs_generator : ndcs_generators)
+	{
+		ndcs_generator.reset();
+	}
+}
+
+bool coalitional_values_generator_NDCS::supports_counter_based_generation() const
+{
+	return true;
+}
+
+coalition::value_t coalitional_values_generator_NDCS::generate_counter_based_value(
+	const uint32_t n_agents_in_coalition,
+	const uint32_t /*task*/,
+	const uint64_t value_key
+) const
+{
+	// Drawn from the same distribution as generate_new_value, but without advancing it.
+	const std::normal_distribution<coalition::value_t>& ndcs_generator{ ndcs_generators[n_agents_in_coalition] };
+	const float z{ utility::random::to_standard_normal(utility::random::splitmix64(value_key, 0), utility::random::splitmix64(value_key, 1)) };
+	return ndcs_generator.mean() + ndcs_generator.stddev() * z;
+}
+
+void coalitional_values_generator_NDCS::generate_counter_based_block(
+	const uint32_t /*task*/,
+	const uint64_t task_key,
+	const uint64_t first_coalition_mask,
+	const uint32_t n_coalitions,
+	coalition::value_t* values
+) const
+{
+	// The normal values first, then the parameters of their coalition size.
+	draw_counter_based_block(task_key, first_coalition_mask, n_coalitions, values, [](const uint64_t value_key)
+	{
+		return utility::random::to_standard_normal(utility::random::splitmix64(value_key, 0), utility::random::splitmix64(value_key, 1));
+	});
+	for (uint32_t index = 0; index < n_coalitions; ++index)
+	{
+		const std::normal_distribution<coalition::value_t>& ndcs_generator{ ndcs_generators[utility::bits::bit_count_32bit(static_cast<uint32_t>(first_coalition_mask + index))] };
+		values[index] = ndcs_generator.mean() + ndcs_generator.stddev() * values[index];
+	}
+}
+
 coalition::value_t coalitional_values_generator_NDCS::generate_new_value(
 	const coalition::coalition_t& coalition,
 	const uint32_t task
@@ -7,6 +7,7 @@
 #include <iostream>
 
 #include "coalition.h"
+#include "utility.h"
 
 coalitional_values_generator_NPD::coalitional_values_generator_NPD() :
 	npd_generator(coalition::value_t(1.0), coalition::value_t(0.1))
@@ -20,6 +21,43 @@ void coalitional_values_generator_NPD::reset(uint32_t n_agents, uint32_t n_tasks
 		generator.seed(seed); // Used to generate samples.
 }
 
+void coalitional_values_generator_NPD::seed_value_generator(const uint64_t value_seed)
+{
+	generator.seed(value_seed);
+	npd_generator.reset();
+}
+
+bool coalitional_values_generator_NPD::supports_counter_based_generation() const
+{
+	return true;
+}
+
+coalition::value_t coalitional_values_generator_NPD::generate_counter_based_value(
+	const uint32_t /*n_agents_in_coalition*/,
+	const uint32_t /*task*/,
+	const uint64_t value_key
+) const
+{
+	const float z{ utility::random::to_standard_normal(utility::random::splitmix64(value_key, 0), utility::random::splitmix64(value_key, 1)) };
+	return npd_generator.mean() + npd_generator.stddev() * z;
+}
+
+void coalitional_values_generator_NPD::generate_counter_based_block(
+	const uint32_t /*task*/,
+	const uint64_t task_key,
+	const uint64_t first_coalition_mask,
+	const uint32_t n_coalitions,
+	coalition::value_t* values
+) const
+{
+	const coalition::value_t mean{ npd_generator.mean() };
+	const coalition::value_t stddev{ npd_generator.stddev() };
+	draw_counter_based_block(task_key, first_coalition_mask, n_coalitions, values, [mean, stddev](const uint64_t value_key)
+	{
+		return mean + stddev * utility::random::to_standard_normal(utility::random::splitmix64(value_key, 0), utility::random::splitmix64(value_key, 1));
+	});
+}
+
 coalition::value_t coalitional_values_generator_NPD::generate_new_value(
 	const coalition::coalition_t& coalition,
 	const uint32_t task
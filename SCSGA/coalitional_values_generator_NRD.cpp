@@ -63,12 +63,12 @@ coalition::value_t coalitional_values_generator_NRD::generate_new_value(
 )
 {
 	coalition::value_t value{};
-	const std::vector<uint32_t> agents{ coalition.get_all_agents() };
-	auto it_1 = agents.cbegin();
-	while (it_1 != agents.cend())
+	const auto agents{ coalition.agents() };
+	auto it_1 = agents.begin();
+	while (it_1 != agents.end())
 	{
-		auto it_2 = it_1 + 1;
-		while (it_2 != agents.cend())
+		auto it_2 = std::next(it_1);
+		while (it_2 != agents.end())
 		{
 			value += AgentToAgentToTaskSkillLevel[*it_1][*it_2][task];
 			++it_2;
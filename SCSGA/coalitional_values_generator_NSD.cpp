@@ -1,6 +1,8 @@
 #include "coalitional_values_generator_NSD.h"
 #include "utility.h"
 #include <cassert>
+#include <algorithm>
+#include <functional>
 
 coalitional_values_generator_NSD::coalitional_values_generator_NSD() :
 	nsd_generator(coalition::value_t(0.0), coalition::value_t(0.1)), TaskToAgentSkillLevel{}
@@ -58,14 +60,31 @@ coalition::value_t coalitional_values_generator_NSD::generate_new_value(
 )
 {
 	coalition::value_t value{};
-	const std::vector<uint32_t> agents{ coalition.get_all_agents() };
-	for (const uint32_t& agent : agents)
+	for (const uint32_t agent : coalition.agents())
 	{
 		value += TaskToAgentSkillLevel[task][agent];
 	}
 	return value;
 }
 
+value_bounds_t coalitional_values_generator_NSD::get_value_bounds()
+{
+	value_bounds_t bounds{};
+	bounds.max_marginal_value = TaskToAgentSkillLevel;
+	bounds.max_value_of_size.assign(n_tasks, std::vector<coalition::value_t>(n_agents + 1, coalition::value_t(0.0)));
+	for (uint32_t task = 0; task < n_tasks; ++task)
+	{
+		// The best coalition of k agents has the k most skilled agents.
+		std::vector<coalition::value_t> skill_levels{ TaskToAgentSkillLevel[task] };
+		std::sort(skill_levels.begin(), skill_levels.end(), std::greater<coalition::value_t>());
+		for (uint32_t k = 0; k < n_agents; ++k)
+		{
+			bounds.max_value_of_size[task][k + 1] = bounds.max_value_of_size[task][k] + skill_levels[k];
+		}
+	}
+	return bounds;
+}
+
 std::string coalitional_values_generator_NSD::get_file_name() const
 {
 	return "NSD_" + std::to_string(seed) + "_" + std::to_string(n_agents) + "_" + std::to_string(n_tasks) + ".problem";
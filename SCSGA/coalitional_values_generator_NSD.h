@@ -8,6 +8,8 @@ public:
 
 	coalition::value_t get_value_of(const coalition::coalition_t& coalition, const uint32_t n_task) override;
 	coalition::value_t generate_new_value(const coalition::coalition_t& coalition, const uint32_t task) override;
+	// The value of a coalition is the sum of the skills of its agents, so both bounds are exact.
+	value_bounds_t get_value_bounds() override;
 
 protected:
 	std::string get_file_name() const override;
@@ -1,6 +1,8 @@
 #include "coalitional_values_generator_NSRD.h"
 #include "utility.h"
 #include <cassert>
+#include <algorithm>
+#include <functional>
 
 coalitional_values_generator_NSRD::coalitional_values_generator_NSRD() :
 	nrd_generator(coalition::value_t(1.0), coalition::value_t(0.1)),
@@ -74,15 +76,15 @@ coalition::value_t coalitional_values_generator_NSRD::generate_new_value(
 	uint32_t skill_value_samples = 0;
 	coalition::value_t relation_value = 0.0f;
 	uint32_t relation_value_samples = 0;
-	std::vector<uint32_t> agents_in_coalition{ coalition.get_all_agents() };
-	for (uint32_t i = 0; i < agents_in_coalition.size(); ++i)
+	const auto agents_in_coalition{ coalition.agents() };
+	for (auto it_i = agents_in_coalition.begin(); it_i != agents_in_coalition.end(); ++it_i)
 	{
-		uint32_t n_agent_index_i = agents_in_coalition[i];
+		uint32_t n_agent_index_i = *it_i;
 		skill_value += AgentToTaskSkillLevel[n_agent_index_i][task];
 		++skill_value_samples;
-		for (uint32_t j = i + 1; j < agents_in_coalition.size(); ++j)
+		for (auto it_j = std::next(it_i); it_j != agents_in_coalition.end(); ++it_j)
 		{
-			uint32_t n_agent_index_j = agents_in_coalition[j];
+			uint32_t n_agent_index_j = *it_j;
 			relation_value += AgentToAgentToTaskSkillLevel[n_agent_index_i][n_agent_index_j][task];
 			++relation_value_samples;
 		}
@@ -98,6 +100,40 @@ coalition::value_t coalitional_values_generator_NSRD::generate_new_value(
 	return coalitional_value;
 }
 
+value_bounds_t coalitional_values_generator_NSRD::get_value_bounds()
+{
+	if (n_agents <= MAX_AGENTS_IN_TABLE)
+	{
+		return coalitional_values_generator::get_value_bounds();
+	}
+
+	value_bounds_t bounds{};
+	bounds.max_value_of_size.assign(n_tasks, std::vector<coalition::value_t>(n_agents + 1, coalition::value_t(0.0)));
+	for (uint32_t task = 0; task < n_tasks; ++task)
+	{
+		std::vector<coalition::value_t> skill_levels(n_agents);
+		coalition::value_t best_relation_value = coalition::NEG_INF;
+		for (uint32_t n_agent_index_i = 0; n_agent_index_i < n_agents; ++n_agent_index_i)
+		{
+			skill_levels[n_agent_index_i] = AgentToTaskSkillLevel[n_agent_index_i][task];
+			for (uint32_t n_agent_index_j = n_agent_index_i + 1; n_agent_index_j < n_agents; ++n_agent_index_j)
+			{
+				best_relation_value = std::max(best_relation_value, AgentToAgentToTaskSkillLevel[n_agent_index_i][n_agent_index_j][task]);
+			}
+		}
+		std::sort(skill_levels.begin(), skill_levels.end(), std::greater<coalition::value_t>());
+
+		// Both values are means, which are at most the mean of the best skills and the best relation.
+		coalition::value_t skill_value = 0.0f;
+		for (uint32_t k = 1; k <= n_agents; ++k)
+		{
+			skill_value += skill_levels[k - 1];
+			bounds.max_value_of_size[task][k] = skill_value / float(k) + (k > 1 ? best_relation_value : 0.0f);
+		}
+	}
+	return bounds;
+}
+
 std::string coalitional_values_generator_NSRD::get_file_name() const
 {
 	return "NSRD_" + std::to_string(seed) + "_" + std::to_string(n_agents) + "_" + std::to_string(n_tasks) + ".problem";
@@ -7,6 +7,8 @@ public:
 
 	coalition::value_t get_value_of(const coalition::coalition_t& coalition, const uint32_t task) override;
 	coalition::value_t generate_new_value(const coalition::coalition_t& coalition, const uint32_t task) override;
+	// Without a value table, a coalition of k agents is bounded by the mean of the k best skills plus the best relation.
+	value_bounds_t get_value_bounds() override;
 
 protected:
 	std::string get_file_name() const override;
@@ -1,6 +1,8 @@
 #include "coalitional_values_generator_UPD.h"
 #include <cassert>
 
+#include "utility.h"
+
 coalitional_values_generator_UPD::coalitional_values_generator_UPD() :
 	upd_generator(coalition::value_t(0.0), coalition::value_t(1.0))
 {
@@ -13,6 +15,43 @@ void coalitional_values_generator_UPD::reset(uint32_t n_agents, uint32_t n_tasks
 		generator.seed(seed); // Used to generate samples.
 }
 
+void coalitional_values_generator_UPD::seed_value_generator(const uint64_t value_seed)
+{
+	generator.seed(value_seed);
+	upd_generator.reset();
+}
+
+bool coalitional_values_generator_UPD::supports_counter_based_generation() const
+{
+	return true;
+}
+
+coalition::value_t coalitional_values_generator_UPD::generate_counter_based_value(
+	const uint32_t /*n_agents_in_coalition*/,
+	const uint32_t /*task*/,
+	const uint64_t value_key
+) const
+{
+	const float u{ utility::random::to_unit_float(utility::random::splitmix64(value_key, 0)) };
+	return upd_generator.a() + (upd_generator.b() - upd_generator.a()) * u;
+}
+
+void coalitional_values_generator_UPD::generate_counter_based_block(
+	const uint32_t /*task*/,
+	const uint64_t task_key,
+	const uint64_t first_coalition_mask,
+	const uint32_t n_coalitions,
+	coalition::value_t* values
+) const
+{
+	const coalition::value_t a{ upd_generator.a() };
+	const coalition::value_t range{ upd_generator.b() - upd_generator.a() };
+	draw_counter_based_block(task_key, first_coalition_mask, n_coalitions, values, [a, range](const uint64_t value_key)
+	{
+		return a + range * utility::random::to_unit_float(utility::random::splitmix64(value_key, 0));
+	});
+}
+
 coalition::value_t coalitional_values_generator_UPD::generate_new_value(
 	const coalition::coalition_t& coalition,
 	const uint32_t task
@@ -9,12 +9,7 @@ coalitional_values_generator_custom::coalitional_values_generator_custom(
 	this->n_agents = n_agents;
 	this->n_tasks = n_tasks;
 
-	const uint32_t n_coalitions{ 1U << n_agents };
-	task_coalition_value.resize(n_tasks);
-	for (auto& task_values : task_coalition_value) {
-		task_values.resize(n_coalitions);
-		std::fill(task_values.begin(), task_values.end(), 0.0);
-	}
+	value_table.reset(n_agents, n_tasks);
 }
 
 void coalitional_values_generator_custom::set_value_of(
@@ -23,7 +18,8 @@ void coalitional_values_generator_custom::set_value_of(
 	const coalition::value_t v_value
 )
 {
-	task_coalition_value[n_task][coalition_agent_mask] = v_value;
+	value_table.set_value_of(coalition_agent_mask, n_task, v_value);
+	invalidate_value_statistics();
 }
 
 void coalitional_values_generator_custom::reset(
@@ -37,11 +33,8 @@ void coalitional_values_generator_custom::reset(
 	this->n_tasks = n_tasks;
 	this->seed = seed;
 
-	task_coalition_value.resize(n_tasks);
-	for (uint32_t task{}; task < n_tasks; ++task)
-	{
-		task_coalition_value[task].assign(get_n_coalitions(), 0);
-	}
+	value_table.reset(n_agents, n_tasks);
+	invalidate_value_statistics();
 }
 
 void coalitional_values_generator_custom::generate_coalitional_values(const uint32_t n_agents, const uint32_t n_tasks, int seed)
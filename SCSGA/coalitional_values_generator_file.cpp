@@ -3,23 +3,15 @@
 coalitional_values_generator_file::coalitional_values_generator_file(const std::string& file_name)
     : coalitional_values_generator(), file_name{ file_name }
 {
-    std::ifstream file{ file_name };
-    file >> n_agents >> n_tasks;
-    if (!file.good())
-    {
-        throw std::invalid_argument("Distribution file not found: " + file_name);
-    }
-
-    for (uint32_t task{}; task < n_tasks; ++task)
+    if (coalition_value_table::is_table_file(file_name))
     {
-        for (uint32_t coalition{}; coalition < get_n_coalitions(); ++coalition)
-        {
-            file >> task_coalition_value[task][coalition];
-        }
+        value_table.open(file_name);
+        n_agents = value_table.get_n_agents();
+        n_tasks = value_table.get_n_tasks();
     }
-    if (!file.good())
+    else
     {
-        throw std::runtime_error("Invalid format of distribution file " + file_name);
+        read_text_file();
     }
 }
 
@@ -37,6 +29,18 @@ void coalitional_values_generator_file::generate_coalitional_values(unsigned int
     }    
 }
 
+void coalitional_values_generator_file::convert_to_binary(const std::string& text_file_name, const std::string& binary_file_name,
+    const value_table_layout_t layout)
+{
+    coalitional_values_generator_file generator{ text_file_name };
+    generator.value_table.set_layout(layout);
+    generator.value_table.save(binary_file_name);
+
+    // Reading the file back verifies that it was written completely.
+    coalition_value_table binary_table{};
+    binary_table.open(binary_file_name, true);
+}
+
 std::string coalitional_values_generator_file::get_file_name() const
 {
     return "file_" + file_name + ".problem";
@@ -48,4 +52,34 @@ void coalitional_values_generator_file::reset(const uint32_t n_agents, const uin
     {
         throw std::invalid_argument("Cannot change problem size of file generator.");
     }
-}
\ No newline at end of file
+}
+
+void coalitional_values_generator_file::read_text_file()
+{
+    std::ifstream file{ file_name };
+    file >> n_agents >> n_tasks;
+    if (!file.good())
+    {
+        throw std::invalid_argument("Distribution file not found: " + file_name);
+    }
+    if (n_agents > MAX_AGENTS_IN_TABLE)
+    {
+        throw std::runtime_error("Distribution file " + file_name + " has more than " + std::to_string(MAX_AGENTS_IN_TABLE) + " agents.");
+    }
+
+    value_table.reset(n_agents, n_tasks);
+    for (uint32_t task{}; task < n_tasks; ++task)
+    {
+        for (uint32_t coalition{}; coalition < get_n_coalitions(); ++coalition)
+        {
+            coalition::value_t value;
+            file >> value;
+            value_table.set_value_of(coalition, task, value);
+        }
+    }
+    // The last value may be followed directly by the end of the file.
+    if (file.fail())
+    {
+        throw std::runtime_error("Invalid format of distribution file " + file_name);
+    }
+}
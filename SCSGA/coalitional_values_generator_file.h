@@ -7,6 +7,12 @@
 
 #include "coalitional_values_generator.h"
 
+/*
+    Reads the values of a problem from a file, either in the text format, which holds the
+    number of agents and tasks followed by the values of all coalitions of task 0, then of
+    task 1 and so on, or in the binary format of coalition_value_table. Binary files are
+    memory-mapped as they are instead of parsed, see convert_to_binary.
+*/
 class coalitional_values_generator_file : public coalitional_values_generator {
 public:
     coalitional_values_generator_file(const std::string& file_name);
@@ -14,10 +20,16 @@ public:
     coalition::value_t generate_new_value(const coalition::coalition_t& coalition, const uint32_t n_task) override;
     void generate_coalitional_values(unsigned int n_agents, unsigned int n_tasks, int seed = 0) override;
 
+    // Converts a text problem file to a binary one with the given layout. Throws if the text file cannot be read or the binary file cannot be written.
+    static void convert_to_binary(const std::string& text_file_name, const std::string& binary_file_name,
+        const value_table_layout_t layout = value_table_layout_t::TASK_MAJOR);
+
 protected:
     std::string get_file_name() const override;
     void reset(const uint32_t n_agents, const uint32_t n_tasks, const int seed = 0) override;
 
 private:
     std::string file_name;
-};
\ No newline at end of file
+
+    void read_text_file();
+};
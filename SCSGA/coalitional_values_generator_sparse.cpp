@@ -1,6 +1,8 @@
 #include "coalitional_values_generator_sparse.h"
 #include <cassert>
 
+#include "utility.h"
+
 coalitional_values_generator_sparse::coalitional_values_generator_sparse() :
 	sparse_generator(coalition::value_t(1.0), coalition::value_t(0.1)),
 	uniform_01_generator(coalition::value_t(0.0), coalition::value_t(1.0)),
@@ -17,6 +19,73 @@ void coalitional_values_generator_sparse::reset(uint32_t n_agents, uint32_t n_ta
 	}
 }
 
+void coalitional_values_generator_sparse::seed_value_generator(const uint64_t value_seed)
+{
+	generator.seed(value_seed);
+	sparse_generator.reset();
+	sparse_uniform_generator.reset();
+	uniform_01_generator.reset();
+}
+
+bool coalitional_values_generator_sparse::supports_counter_based_generation() const
+{
+	return true;
+}
+
+coalition::value_t coalitional_values_generator_sparse::generate_counter_based_value(
+	const uint32_t /*n_agents_in_coalition*/,
+	const uint32_t /*task*/,
+	const uint64_t value_key
+) const
+{
+	const bool is_good_value{ utility::random::to_unit_float(utility::random::splitmix64(value_key, 0)) < probability_to_draw_good_value };
+	coalition::value_t value;
+	if (use_uniform)
+	{
+		const float u{ utility::random::to_unit_float(utility::random::splitmix64(value_key, 1)) };
+		value = sparse_uniform_generator.a() + (sparse_uniform_generator.b() - sparse_uniform_generator.a()) * u;
+	}
+	else
+	{
+		const float z{ utility::random::to_standard_normal(utility::random::splitmix64(value_key, 1), utility::random::splitmix64(value_key, 2)) };
+		value = sparse_generator.mean() + sparse_generator.stddev() * z;
+	}
+	return is_good_value ? value : 0.1f * value;
+}
+
+void coalitional_values_generator_sparse::generate_counter_based_block(
+	const uint32_t /*task*/,
+	const uint64_t task_key,
+	const uint64_t first_coalition_mask,
+	const uint32_t n_coalitions,
+	coalition::value_t* values
+) const
+{
+	// The same values as generate_counter_based_value, with the choice of distribution out of the loops.
+	const float probability{ probability_to_draw_good_value };
+	if (use_uniform)
+	{
+		const coalition::value_t a{ sparse_uniform_generator.a() };
+		const coalition::value_t range{ sparse_uniform_generator.b() - sparse_uniform_generator.a() };
+		draw_counter_based_block(task_key, first_coalition_mask, n_coalitions, values, [probability, a, range](const uint64_t value_key)
+		{
+			const bool is_good_value{ utility::random::to_unit_float(utility::random::splitmix64(value_key, 0)) < probability };
+			const coalition::value_t value{ a + range * utility::random::to_unit_float(utility::random::splitmix64(value_key, 1)) };
+			return is_good_value ? value : 0.1f * value;
+		});
+		return;
+	}
+	const coalition::value_t mean{ sparse_generator.mean() };
+	const coalition::value_t stddev{ sparse_generator.stddev() };
+	draw_counter_based_block(task_key, first_coalition_mask, n_coalitions, values, [probability, mean, stddev](const uint64_t value_key)
+	{
+		const bool is_good_value{ utility::random::to_unit_float(utility::random::splitmix64(value_key, 0)) < probability };
+		const float z{ utility::random::to_standard_normal(utility::random::splitmix64(value_key, 1), utility::random::splitmix64(value_key, 2)) };
+		const coalition::value_t value{ mean + stddev * z };
+		return is_good_value ? value : 0.1f * value;
+	});
+}
+
 coalition::value_t coalitional_values_generator_sparse::generate_new_value(
 	const coalition::coalition_t& coalition,
 	const uint32_t task
@@ -42,5 +111,6 @@ coalition::value_t coalitional_values_generator_sparse::generate_new_value(
 
 std::string coalitional_values_generator_sparse::get_file_name() const
 {
-	return "sparse_" + std::to_string(seed) + "_" + std::to_string(n_agents) + "_" + std::to_string(n_tasks) + ".problem";
+	// Uniform and normal sparse problems must not share files.
+	return std::string(use_uniform ? "SUPD_" : "SNPD_") + std::to_string(seed) + "_" + std::to_string(n_agents) + "_" + std::to_string(n_tasks) + ".problem";
 }
\ No newline at end of file
@@ -9,10 +9,15 @@ public:
 	coalitional_values_generator_sparse();
 	bool use_uniform = false;
 	coalition::value_t generate_new_value(const coalition::coalition_t& coalition, const uint32_t task) override;
+	bool supports_counter_based_generation() const override;
 
 protected:
 	std::string get_file_name() const override;
 	void reset(uint32_t n_agents, uint32_t n_tasks, int seed = 0) override;
+	void seed_value_generator(const uint64_t value_seed) override;
+	coalition::value_t generate_counter_based_value(const uint32_t n_agents_in_coalition, const uint32_t task, const uint64_t value_key) const override;
+	void generate_counter_based_block(const uint32_t task, const uint64_t task_key, const uint64_t first_coalition_mask,
+		const uint32_t n_coalitions, coalition::value_t* values) const override;
 	
 private:
 	const float probability_to_draw_good_value = 0.01f;
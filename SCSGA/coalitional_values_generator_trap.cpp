@@ -43,6 +43,61 @@ void coalitional_values_generator_trap::reset(uint32_t n_agents, uint32_t n_task
 	}
 }
 
+void coalitional_values_generator_trap::seed_value_generator(const uint64_t value_seed)
+{
+	generator.seed(value_seed);
+	for (auto& generators_of_task : task_trap_generators)
+	{
+		for (auto& trap_generator : generators_of_task)
+		{
+			trap_generator.reset();
+		}
+	}
+}
+
+bool coalitional_values_generator_trap::supports_counter_based_generation() const
+{
+	return true;
+}
+
+coalition::value_t coalitional_values_generator_trap::generate_counter_based_value(
+	const uint32_t n_agents_in_coalition,
+	const uint32_t task,
+	const uint64_t value_key
+) const
+{
+	// The same distributions as generate_new_value, see there.
+	const float z{ utility::random::to_standard_normal(utility::random::splitmix64(value_key, 0), utility::random::splitmix64(value_key, 1)) };
+	coalition::value_t value{};
+	switch (MODE)
+	{
+	case 0:
+		value = values[n_agents_in_coalition];
+		break;
+	case 1:
+	{
+		float xf = n_agents_in_coalition;
+
+		float cost = -xf * xf;
+		float steep = pow(xf, 2.1f);
+		float val = xf + (xf > n_agents / 2.0f ? steep : 0.0f);
+
+		float mean = cost + val;
+		value = 0.1f * mean + 0.1f * z;
+	}
+	break;
+	case 2:
+	{
+		const std::normal_distribution<coalition::value_t>& trap_generator{ task_trap_generators[task][n_agents_in_coalition] };
+		value = trap_generator.mean() + trap_generator.stddev() * z;
+	}
+	break;
+	default:
+		break;
+	}
+	return value;
+}
+
 coalition::value_t coalitional_values_generator_trap::generate_new_value(
 	const coalition::coalition_t& coalition,
 	const uint32_t task
@@ -9,10 +9,13 @@ public:
 	coalitional_values_generator_trap() = default;
 
 	coalition::value_t generate_new_value(const coalition::coalition_t& coalition, const uint32_t task) override;
+	bool supports_counter_based_generation() const override;
 
 protected:
 	std::string get_file_name() const override;
 	void reset(uint32_t n_agents, uint32_t n_tasks, int seed) override;
+	void seed_value_generator(const uint64_t value_seed) override;
+	coalition::value_t generate_counter_based_value(const uint32_t n_agents_in_coalition, const uint32_t task, const uint64_t value_key) const override;
 
 private:
 	const int MODE = 1; // 0 == old, 1 == "Lkare utan grnser" (new mode).
@@ -0,0 +1,91 @@
+#include "deadline_token.h"
+
+deadline_token::guard::guard(deadline_token& token, const double time_limit)
+	: token(token)
+{
+	token.start(time_limit);
+}
+
+deadline_token::guard::~guard()
+{
+	token.stop();
+}
+
+deadline_token::deadline_token(const deadline_token&)
+	: deadline_token()
+{
+}
+
+deadline_token& deadline_token::operator=(const deadline_token&)
+{
+	return *this;
+}
+
+deadline_token::~deadline_token()
+{
+	stop_watchdog();
+}
+
+void deadline_token::start(const double time_limit)
+{
+	stop_watchdog();
+	start_time = std::chrono::steady_clock::now();
+	// A cancel between these two stores is seen by the check, so that it expires this solve rather than the next.
+	is_expired = false;
+	if (is_cancel_requested)
+	{
+		is_expired = true;
+	}
+	if (time_limit < 0)
+	{
+		return;
+	}
+	if (time_limit == 0)
+	{
+		is_expired = true;
+		return;
+	}
+
+	using clock_t = std::chrono::steady_clock;
+	const clock_t::time_point deadline{ start_time + std::chrono::duration_cast<clock_t::duration>(std::chrono::duration<double>(time_limit)) };
+	is_watchdog_stopping = false;
+	watchdog = std::thread([this, deadline]()
+		{
+			std::unique_lock<std::mutex> lock(watchdog_mutex);
+			if (!watchdog_wake.wait_until(lock, deadline, [this]() { return is_watchdog_stopping; }))
+			{
+				is_expired = true;
+			}
+		});
+}
+
+void deadline_token::stop()
+{
+	stop_watchdog();
+	is_cancel_requested = false;
+}
+
+double deadline_token::get_elapsed_time() const
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+void deadline_token::cancel()
+{
+	is_cancel_requested = true;
+	is_expired = true;
+}
+
+void deadline_token::stop_watchdog()
+{
+	if (!watchdog.joinable())
+	{
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(watchdog_mutex);
+		is_watchdog_stopping = true;
+	}
+	watchdog_wake.notify_one();
+	watchdog.join();
+}
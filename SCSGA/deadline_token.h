@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/*
+	Tells a solver when to stop, because its time limit has passed or because the solve was
+	cancelled from another thread. Solvers poll expired in their inner loops, which only reads an
+	atomic flag, instead of reading a clock. The flag is set by a watchdog thread that sleeps until
+	the deadline, so a solve without a time limit does not start a thread at all.
+*/
+class deadline_token
+{
+public:
+	// Starts a solve of token on construction and stops it on destruction.
+	class guard
+	{
+	public:
+		guard(deadline_token& token, const double time_limit);
+		~guard();
+		guard(const guard&) = delete;
+		guard& operator=(const guard&) = delete;
+
+	private:
+		deadline_token& token;
+	};
+
+	deadline_token() = default;
+	// Copies start without a solve, so that solvers holding a token can still be copied.
+	deadline_token(const deadline_token&);
+	deadline_token& operator=(const deadline_token&);
+	~deadline_token();
+
+	// Starts a solve that expires after time_limit seconds, or only when cancelled if time_limit is negative.
+	void start(const double time_limit);
+
+	// Stops the watchdog of the solve. The token stays expired if it was.
+	void stop();
+
+	// Expires the running solve, or the next one to start if none is running. Safe to call from any thread.
+	void cancel();
+
+	bool expired() const
+	{
+		return is_expired.load(std::memory_order_relaxed);
+	}
+
+	// Seconds since the last start. Reads the clock, so it is not meant for inner loops.
+	double get_elapsed_time() const;
+
+private:
+	std::atomic<bool> is_expired{ false };
+	std::atomic<bool> is_cancel_requested{ false };
+	std::chrono::steady_clock::time_point start_time{ std::chrono::steady_clock::now() };
+
+	std::mutex watchdog_mutex;
+	std::condition_variable watchdog_wake;
+	bool is_watchdog_stopping{ false };
+	std::thread watchdog;
+
+	void stop_watchdog();
+};
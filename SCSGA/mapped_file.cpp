@@ -0,0 +1,293 @@
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+mapped_file::~mapped_file()
+{
+	close();
+}
+
+mapped_file::mapped_file(mapped_file&& o) noexcept
+{
+	*this = std::move(o);
+}
+
+mapped_file& mapped_file::operator=(mapped_file&& o) noexcept
+{
+	if (this != &o)
+	{
+		close();
+		std::swap(bytes, o.bytes);
+		std::swap(n_bytes, o.n_bytes);
+		std::swap(writable, o.writable);
+#ifdef _WIN32
+		std::swap(file_handle, o.file_handle);
+		std::swap(mapping_handle, o.mapping_handle);
+#else
+		std::swap(file_descriptor, o.file_descriptor);
+#endif
+	}
+	return *this;
+}
+
+#ifdef _WIN32
+
+void mapped_file::open(const std::string& file_name, const bool writable)
+{
+	close();
+	this->writable = writable;
+	file_handle = CreateFileA(file_name.c_str(), GENERIC_READ | (writable ? GENERIC_WRITE : 0), FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file_handle == INVALID_HANDLE_VALUE)
+	{
+		file_handle = nullptr;
+		throw std::runtime_error("Could not open " + file_name + ".");
+	}
+	LARGE_INTEGER file_size;
+	GetFileSizeEx(file_handle, &file_size);
+	n_bytes = static_cast<uint64_t>(file_size.QuadPart);
+	map(file_name);
+}
+
+void mapped_file::create(const std::string& file_name, const uint64_t n_bytes)
+{
+	close();
+	writable = true;
+	file_handle = CreateFileA(file_name.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file_handle == INVALID_HANDLE_VALUE)
+	{
+		file_handle = nullptr;
+		throw std::runtime_error("Could not create " + file_name + ".");
+	}
+	this->n_bytes = n_bytes;
+	map(file_name);
+}
+
+void mapped_file::map(const std::string& file_name)
+{
+	if (n_bytes == 0)
+	{
+		return;
+	}
+	// Mapping a writable file larger than it is extends it with zeros.
+	mapping_handle = CreateFileMappingA(file_handle, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+		static_cast<DWORD>(n_bytes >> 32), static_cast<DWORD>(n_bytes), nullptr);
+	if (mapping_handle != nullptr)
+	{
+		bytes = static_cast<uint8_t*>(MapViewOfFile(mapping_handle, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+	}
+	if (bytes == nullptr)
+	{
+		close();
+		throw std::runtime_error("Could not map " + file_name + ".");
+	}
+}
+
+void mapped_file::close()
+{
+	if (bytes != nullptr)
+	{
+		UnmapViewOfFile(bytes);
+	}
+	if (mapping_handle != nullptr)
+	{
+		CloseHandle(mapping_handle);
+	}
+	if (file_handle != nullptr)
+	{
+		CloseHandle(file_handle);
+	}
+	bytes = nullptr;
+	mapping_handle = nullptr;
+	file_handle = nullptr;
+	n_bytes = 0;
+	writable = false;
+}
+
+bool mapped_file::is_open() const
+{
+	return file_handle != nullptr;
+}
+
+void mapped_file::flush()
+{
+	if (bytes != nullptr && writable)
+	{
+		FlushViewOfFile(bytes, 0);
+		FlushFileBuffers(file_handle);
+	}
+}
+
+void mapped_file::advise(const file_access_t access, const uint64_t offset, const uint64_t n_bytes) const
+{
+	// Windows only takes hints for ranges that are about to be used.
+	if (bytes == nullptr || access != file_access_t::WILL_NEED || offset >= this->n_bytes)
+	{
+		return;
+	}
+	WIN32_MEMORY_RANGE_ENTRY range;
+	range.VirtualAddress = bytes + offset;
+	range.NumberOfBytes = static_cast<SIZE_T>(std::min(n_bytes, this->n_bytes - offset));
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+#else
+
+void mapped_file::open(const std::string& file_name, const bool writable)
+{
+	close();
+	this->writable = writable;
+	file_descriptor = ::open(file_name.c_str(), writable ? O_RDWR : O_RDONLY);
+	if (file_descriptor < 0)
+	{
+		throw std::runtime_error("Could not open " + file_name + ": " + std::strerror(errno) + ".");
+	}
+	struct stat file_status;
+	if (fstat(file_descriptor, &file_status) != 0)
+	{
+		close();
+		throw std::runtime_error("Could not read the size of " + file_name + ": " + std::strerror(errno) + ".");
+	}
+	n_bytes = static_cast<uint64_t>(file_status.st_size);
+	map(file_name);
+}
+
+void mapped_file::create(const std::string& file_name, const uint64_t n_bytes)
+{
+	close();
+	writable = true;
+	file_descriptor = ::open(file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (file_descriptor < 0)
+	{
+		throw std::runtime_error("Could not create " + file_name + ": " + std::strerror(errno) + ".");
+	}
+	// Extending the file leaves a hole that reads as zeros and takes no disk space until written.
+	if (ftruncate(file_descriptor, static_cast<off_t>(n_bytes)) != 0)
+	{
+		close();
+		throw std::runtime_error("Could not resize " + file_name + ": " + std::strerror(errno) + ".");
+	}
+	this->n_bytes = n_bytes;
+	map(file_name);
+}
+
+void mapped_file::map(const std::string& file_name)
+{
+	if (n_bytes == 0)
+	{
+		return;
+	}
+	void* memory{ mmap(nullptr, n_bytes, PROT_READ | (writable ? PROT_WRITE : 0), MAP_SHARED, file_descriptor, 0) };
+	if (memory == MAP_FAILED)
+	{
+		const std::string reason{ std::strerror(errno) };
+		close();
+		throw std::runtime_error("Could not map " + file_name + ": " + reason + ".");
+	}
+	bytes = static_cast<uint8_t*>(memory);
+}
+
+void mapped_file::close()
+{
+	if (bytes != nullptr)
+	{
+		munmap(bytes, n_bytes);
+	}
+	if (file_descriptor >= 0)
+	{
+		::close(file_descriptor);
+	}
+	bytes = nullptr;
+	file_descriptor = -1;
+	n_bytes = 0;
+	writable = false;
+}
+
+bool mapped_file::is_open() const
+{
+	return file_descriptor >= 0;
+}
+
+void mapped_file::flush()
+{
+	if (bytes != nullptr && writable)
+	{
+		msync(bytes, n_bytes, MS_SYNC);
+	}
+}
+
+void mapped_file::advise(const file_access_t access, const uint64_t offset, const uint64_t n_bytes) const
+{
+	if (bytes == nullptr || offset >= this->n_bytes)
+	{
+		return;
+	}
+
+	// madvise requires a page aligned start, so the range is widened to the start of its first page.
+	static const uint64_t page_size{ static_cast<uint64_t>(sysconf(_SC_PAGESIZE)) };
+	const uint64_t first_byte{ offset / page_size * page_size };
+	const uint64_t last_byte{ std::min(offset + n_bytes, this->n_bytes) };
+
+	int advice{ MADV_NORMAL };
+	switch (access)
+	{
+	case file_access_t::NORMAL:
+		advice = MADV_NORMAL;
+		break;
+	case file_access_t::SEQUENTIAL:
+		advice = MADV_SEQUENTIAL;
+		break;
+	case file_access_t::RANDOM:
+		advice = MADV_RANDOM;
+		break;
+	case file_access_t::WILL_NEED:
+		advice = MADV_WILLNEED;
+		break;
+	case file_access_t::DONT_NEED:
+		// Dropping pages of a shared mapping never loses data, as dirty pages stay in the page cache.
+		advice = MADV_DONTNEED;
+		break;
+	}
+	madvise(bytes + first_byte, last_byte - first_byte, advice);
+}
+
+#endif
+
+bool mapped_file::is_writable() const
+{
+	return writable;
+}
+
+uint64_t mapped_file::size() const
+{
+	return n_bytes;
+}
+
+const uint8_t* mapped_file::data() const
+{
+	return bytes;
+}
+
+uint8_t* mapped_file::data()
+{
+	return bytes;
+}
+
+void mapped_file::advise(const file_access_t access) const
+{
+	advise(access, 0, n_bytes);
+}
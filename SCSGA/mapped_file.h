@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/*
+	Expected access pattern of a range of a memory-mapped file, passed on to the
+	operating system as a paging hint (madvise on POSIX systems).
+
+	NORMAL			Default readahead.
+	SEQUENTIAL		The range is read once from start to end, so read ahead aggressively
+					and drop pages soon after they have been read.
+	RANDOM			The range is read in no particular order, so do not read ahead.
+	WILL_NEED		The range will be read soon, so start paging it in now.
+	DONT_NEED		The range will not be read for a while, so its pages may be dropped.
+*/
+enum class file_access_t
+{
+	NORMAL, SEQUENTIAL, RANDOM, WILL_NEED, DONT_NEED
+};
+
+/*
+	A file mapped into memory as a whole. Writes to a writable mapping go to the file
+	and pages are read from the file on demand, so the file may be larger than the
+	available memory.
+*/
+class mapped_file
+{
+public:
+	mapped_file() = default;
+	~mapped_file();
+
+	mapped_file(const mapped_file& o) = delete;
+	mapped_file& operator=(const mapped_file& o) = delete;
+	mapped_file(mapped_file&& o) noexcept;
+	mapped_file& operator=(mapped_file&& o) noexcept;
+
+	// Maps an existing file. Throws std::runtime_error if it cannot be opened or mapped.
+	void open(const std::string& file_name, const bool writable);
+	// Creates (or truncates) a file of n_bytes zero bytes and maps it writable. Throws std::runtime_error on failure.
+	void create(const std::string& file_name, const uint64_t n_bytes);
+	void close();
+
+	bool is_open() const;
+	bool is_writable() const;
+	uint64_t size() const;
+	const uint8_t* data() const;
+	uint8_t* data();
+
+	// Writes modified pages back to the file.
+	void flush();
+	// Passes an access hint for the n_bytes bytes at offset on to the operating system. Does nothing if hints are not supported.
+	void advise(const file_access_t access, const uint64_t offset, const uint64_t n_bytes) const;
+	void advise(const file_access_t access) const;
+
+private:
+	uint8_t* bytes{ nullptr };
+	uint64_t n_bytes{};
+	bool writable{ false };
+#ifdef _WIN32
+	void* file_handle{ nullptr };
+	void* mapping_handle{ nullptr };
+#else
+	int file_descriptor{ -1 };
+#endif
+
+	void map(const std::string& file_name);
+};
@@ -0,0 +1,413 @@
+#include "max_plus.h"
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define MAX_PLUS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUG__)
+#define MAX_PLUS_TARGET(target_name) __attribute__((target(target_name)))
+#else
+#define MAX_PLUS_TARGET(target_name)
+#endif
+
+namespace
+{
+	max_plus_result_t evaluate_scalar(const uint32_t n_mask, const float* coalition_values, const uint32_t coalition_stride,
+		const float* previous_values, const uint32_t previous_stride)
+	{
+		max_plus_result_t best{ std::numeric_limits<float>::lowest(), 0u };
+		uint32_t n_submask{ 0u };
+		do
+		{
+			const float value{ coalition_values[static_cast<uint64_t>(n_submask) * coalition_stride]
+				+ previous_values[static_cast<uint64_t>(n_mask & ~n_submask) * previous_stride] };
+			if (value > best.value)
+			{
+				best = { value, n_submask };
+			}
+			n_submask = (n_submask - n_mask) & n_mask;
+		} while (n_submask != 0u);
+		return best;
+	}
+
+	// Gathers take signed 32 bit indices.
+	bool fits_gather_indices(const uint32_t n_mask, const uint32_t coalition_stride, const uint32_t previous_stride)
+	{
+		const uint64_t n_max_index{ static_cast<uint64_t>(n_mask) * (coalition_stride > previous_stride ? coalition_stride : previous_stride) };
+		return n_max_index <= static_cast<uint64_t>(std::numeric_limits<int32_t>::max());
+	}
+
+	// Splits n_mask into its lowest n_low_agents agents and the others, and writes the 2^n_low_agents
+	// subsets of the lowest agents in increasing order to low_submasks.
+	uint32_t split_low_agents(const uint32_t n_mask, const uint32_t n_low_agents, uint32_t* low_submasks)
+	{
+		uint32_t n_high_mask{ n_mask };
+		uint32_t low_agents[16];
+		for (uint32_t n_agent{}; n_agent < n_low_agents; ++n_agent)
+		{
+			low_agents[n_agent] = n_high_mask & (0u - n_high_mask);
+			n_high_mask ^= low_agents[n_agent];
+		}
+		for (uint32_t n_submask{}; n_submask < (1u << n_low_agents); ++n_submask)
+		{
+			low_submasks[n_submask] = 0u;
+			for (uint32_t n_agent{}; n_agent < n_low_agents; ++n_agent)
+			{
+				low_submasks[n_submask] |= (n_submask >> n_agent & 1u) != 0 ? low_agents[n_agent] : 0u;
+			}
+		}
+		return n_high_mask;
+	}
+
+	// The best of the per lane results, preferring the smallest coalition on ties, as that one comes first in increasing order.
+	max_plus_result_t reduce_lanes(const float* values, const uint32_t* coalition_masks, const uint32_t n_lanes)
+	{
+		max_plus_result_t best{ values[0], coalition_masks[0] };
+		for (uint32_t n_lane{ 1 }; n_lane < n_lanes; ++n_lane)
+		{
+			if (values[n_lane] > best.value || (values[n_lane] == best.value && coalition_masks[n_lane] < best.coalition_mask))
+			{
+				best = { values[n_lane], coalition_masks[n_lane] };
+			}
+		}
+		return best;
+	}
+
+	void evaluate_batch_scalar(const uint32_t n_mask, const float* coalition_values, const float* previous_values,
+		float* best_values, uint32_t* best_coalitions)
+	{
+		constexpr uint32_t N_LANES{ max_plus::BATCH_LANES };
+		for (uint32_t n_lane{}; n_lane < N_LANES; ++n_lane)
+		{
+			best_values[n_lane] = std::numeric_limits<float>::lowest();
+			best_coalitions[n_lane] = 0u;
+		}
+		uint32_t n_submask{ 0u };
+		do
+		{
+			const float* lane_coalition_values{ coalition_values + static_cast<uint64_t>(n_submask) * N_LANES };
+			const float* lane_previous_values{ previous_values + static_cast<uint64_t>(n_mask & ~n_submask) * N_LANES };
+			for (uint32_t n_lane{}; n_lane < N_LANES; ++n_lane)
+			{
+				const float value{ lane_coalition_values[n_lane] + lane_previous_values[n_lane] };
+				if (value > best_values[n_lane])
+				{
+					best_values[n_lane] = value;
+					best_coalitions[n_lane] = n_submask;
+				}
+			}
+			n_submask = (n_submask - n_mask) & n_mask;
+		} while (n_submask != 0u);
+	}
+
+#ifdef MAX_PLUS_X86
+	/*
+		The vector kernels are specialized for the strides of the DP solver, as the gathers
+		then scale the indices themselves: coalition values with a stride of 1 (task major
+		layout) and previous values with a stride of 1 (rolling layers) or 2 (memoization
+		entries). A stride of 0 stands for any stride, which is multiplied in.
+	*/
+	template<uint32_t COALITION_STRIDE, uint32_t PREVIOUS_STRIDE>
+	MAX_PLUS_TARGET("avx2") max_plus_result_t evaluate_avx2(const uint32_t n_mask, const float* coalition_values, const uint32_t coalition_stride,
+		const float* previous_values, const uint32_t previous_stride)
+	{
+		constexpr uint32_t N_LOW_AGENTS{ 3 }, N_LANES{ 8 };
+		if (static_cast<uint32_t>(_mm_popcnt_u32(n_mask)) < N_LOW_AGENTS || !fits_gather_indices(n_mask, coalition_stride, previous_stride))
+		{
+			return evaluate_scalar(n_mask, coalition_values, coalition_stride, previous_values, previous_stride);
+		}
+
+		alignas(32) uint32_t low_submasks[N_LANES];
+		const uint32_t n_high_mask{ split_low_agents(n_mask, N_LOW_AGENTS, low_submasks) };
+		const __m256i low_coalitions{ _mm256_load_si256(reinterpret_cast<const __m256i*>(low_submasks)) };
+		const __m256i mask{ _mm256_set1_epi32(static_cast<int>(n_mask)) };
+		const __m256i coalition_strides{ _mm256_set1_epi32(static_cast<int>(coalition_stride)) };
+		const __m256i previous_strides{ _mm256_set1_epi32(static_cast<int>(previous_stride)) };
+
+		__m256 best_values{ _mm256_set1_ps(std::numeric_limits<float>::lowest()) };
+		__m256i best_coalitions{ _mm256_setzero_si256() };
+		uint32_t n_high_submask{ 0u };
+		do
+		{
+			const __m256i coalitions{ _mm256_or_si256(_mm256_set1_epi32(static_cast<int>(n_high_submask)), low_coalitions) };
+			const __m256i remaining_agents{ _mm256_xor_si256(mask, coalitions) };
+			__m256 values;
+			if constexpr (COALITION_STRIDE == 0)
+			{
+				values = _mm256_i32gather_ps(coalition_values, _mm256_mullo_epi32(coalitions, coalition_strides), 4);
+			}
+			else
+			{
+				values = _mm256_i32gather_ps(coalition_values, coalitions, 4 * COALITION_STRIDE);
+			}
+			if constexpr (PREVIOUS_STRIDE == 0)
+			{
+				values = _mm256_add_ps(values, _mm256_i32gather_ps(previous_values, _mm256_mullo_epi32(remaining_agents, previous_strides), 4));
+			}
+			else
+			{
+				values = _mm256_add_ps(values, _mm256_i32gather_ps(previous_values, remaining_agents, 4 * PREVIOUS_STRIDE));
+			}
+			const __m256 is_better{ _mm256_cmp_ps(values, best_values, _CMP_GT_OQ) };
+			best_values = _mm256_blendv_ps(best_values, values, is_better);
+			best_coalitions = _mm256_blendv_epi8(best_coalitions, coalitions, _mm256_castps_si256(is_better));
+			n_high_submask = (n_high_submask - n_high_mask) & n_high_mask;
+		} while (n_high_submask != 0u);
+
+		alignas(32) float lane_values[N_LANES];
+		alignas(32) uint32_t lane_coalitions[N_LANES];
+		_mm256_store_ps(lane_values, best_values);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(lane_coalitions), best_coalitions);
+		return reduce_lanes(lane_values, lane_coalitions, N_LANES);
+	}
+
+	template<uint32_t COALITION_STRIDE, uint32_t PREVIOUS_STRIDE>
+	MAX_PLUS_TARGET("avx512f") max_plus_result_t evaluate_avx512(const uint32_t n_mask, const float* coalition_values, const uint32_t coalition_stride,
+		const float* previous_values, const uint32_t previous_stride)
+	{
+		constexpr uint32_t N_LOW_AGENTS{ 4 }, N_LANES{ 16 };
+		if (static_cast<uint32_t>(_mm_popcnt_u32(n_mask)) < N_LOW_AGENTS || !fits_gather_indices(n_mask, coalition_stride, previous_stride))
+		{
+			return evaluate_scalar(n_mask, coalition_values, coalition_stride, previous_values, previous_stride);
+		}
+
+		alignas(64) uint32_t low_submasks[N_LANES];
+		const uint32_t n_high_mask{ split_low_agents(n_mask, N_LOW_AGENTS, low_submasks) };
+		const __m512i low_coalitions{ _mm512_load_si512(low_submasks) };
+		const __m512i mask{ _mm512_set1_epi32(static_cast<int>(n_mask)) };
+		const __m512i coalition_strides{ _mm512_set1_epi32(static_cast<int>(coalition_stride)) };
+		const __m512i previous_strides{ _mm512_set1_epi32(static_cast<int>(previous_stride)) };
+
+		// The masked gathers start from zeros, as GCC warns that the plain ones read an uninitialized source.
+		const __mmask16 all_lanes{ 0xFFFF };
+		__m512 best_values{ _mm512_set1_ps(std::numeric_limits<float>::lowest()) };
+		__m512i best_coalitions{ _mm512_setzero_si512() };
+		uint32_t n_high_submask{ 0u };
+		do
+		{
+			const __m512i coalitions{ _mm512_or_si512(_mm512_set1_epi32(static_cast<int>(n_high_submask)), low_coalitions) };
+			const __m512i remaining_agents{ _mm512_xor_si512(mask, coalitions) };
+			__m512 values;
+			if constexpr (COALITION_STRIDE == 0)
+			{
+				values = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), all_lanes, _mm512_mullo_epi32(coalitions, coalition_strides), coalition_values, 4);
+			}
+			else
+			{
+				values = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), all_lanes, coalitions, coalition_values, 4 * COALITION_STRIDE);
+			}
+			if constexpr (PREVIOUS_STRIDE == 0)
+			{
+				values = _mm512_add_ps(values, _mm512_mask_i32gather_ps(_mm512_setzero_ps(), all_lanes, _mm512_mullo_epi32(remaining_agents, previous_strides), previous_values, 4));
+			}
+			else
+			{
+				values = _mm512_add_ps(values, _mm512_mask_i32gather_ps(_mm512_setzero_ps(), all_lanes, remaining_agents, previous_values, 4 * PREVIOUS_STRIDE));
+			}
+			const __mmask16 is_better{ _mm512_cmp_ps_mask(values, best_values, _CMP_GT_OQ) };
+			best_values = _mm512_mask_blend_ps(is_better, best_values, values);
+			best_coalitions = _mm512_mask_blend_epi32(is_better, best_coalitions, coalitions);
+			n_high_submask = (n_high_submask - n_high_mask) & n_high_mask;
+		} while (n_high_submask != 0u);
+
+		alignas(64) float lane_values[N_LANES];
+		alignas(64) uint32_t lane_coalitions[N_LANES];
+		_mm512_store_ps(lane_values, best_values);
+		_mm512_store_si512(lane_coalitions, best_coalitions);
+		return reduce_lanes(lane_values, lane_coalitions, N_LANES);
+	}
+
+	max_plus_result_t evaluate_avx2_any_stride(const uint32_t n_mask, const float* coalition_values, const uint32_t coalition_stride,
+		const float* previous_values, const uint32_t previous_stride)
+	{
+		if (coalition_stride == 1 && previous_stride == 1)
+		{
+			return evaluate_avx2<1, 1>(n_mask, coalition_values, coalition_stride, previous_values, previous_stride);
+		}
+		if (coalition_stride == 1 && previous_stride == 2)
+		{
+			return evaluate_avx2<1, 2>(n_mask, coalition_values, coalition_stride, previous_values, previous_stride);
+		}
+		return evaluate_avx2<0, 0>(n_mask, coalition_values, coalition_stride, previous_values, previous_stride);
+	}
+
+	max_plus_result_t evaluate_avx512_any_stride(const uint32_t n_mask, const float* coalition_values, const uint32_t coalition_stride,
+		const float* previous_values, const uint32_t previous_stride)
+	{
+		if (coalition_stride == 1 && previous_stride == 1)
+		{
+			return evaluate_avx512<1, 1>(n_mask, coalition_values, coalition_stride, previous_values, previous_stride);
+		}
+		if (coalition_stride == 1 && previous_stride == 2)
+		{
+			return evaluate_avx512<1, 2>(n_mask, coalition_values, coalition_stride, previous_values, previous_stride);
+		}
+		return evaluate_avx512<0, 0>(n_mask, coalition_values, coalition_stride, previous_values, previous_stride);
+	}
+
+	// The lanes of the batch kernels are independent instances, so their values are contiguous and need no gathers.
+	MAX_PLUS_TARGET("avx2") void evaluate_batch_avx2(const uint32_t n_mask, const float* coalition_values, const float* previous_values,
+		float* best_values, uint32_t* best_coalitions)
+	{
+		static_assert(max_plus::BATCH_LANES == 16, "The AVX2 batch kernel works on two vectors of 8 lanes.");
+		__m256 best_values_low{ _mm256_set1_ps(std::numeric_limits<float>::lowest()) };
+		__m256 best_values_high{ best_values_low };
+		__m256i best_coalitions_low{ _mm256_setzero_si256() };
+		__m256i best_coalitions_high{ best_coalitions_low };
+		uint32_t n_submask{ 0u };
+		do
+		{
+			const float* lane_coalition_values{ coalition_values + static_cast<uint64_t>(n_submask) * 16 };
+			const float* lane_previous_values{ previous_values + static_cast<uint64_t>(n_mask & ~n_submask) * 16 };
+			const __m256i coalitions{ _mm256_set1_epi32(static_cast<int>(n_submask)) };
+			const __m256 values_low{ _mm256_add_ps(_mm256_loadu_ps(lane_coalition_values), _mm256_loadu_ps(lane_previous_values)) };
+			const __m256 values_high{ _mm256_add_ps(_mm256_loadu_ps(lane_coalition_values + 8), _mm256_loadu_ps(lane_previous_values + 8)) };
+			const __m256 is_better_low{ _mm256_cmp_ps(values_low, best_values_low, _CMP_GT_OQ) };
+			const __m256 is_better_high{ _mm256_cmp_ps(values_high, best_values_high, _CMP_GT_OQ) };
+			best_values_low = _mm256_blendv_ps(best_values_low, values_low, is_better_low);
+			best_values_high = _mm256_blendv_ps(best_values_high, values_high, is_better_high);
+			best_coalitions_low = _mm256_blendv_epi8(best_coalitions_low, coalitions, _mm256_castps_si256(is_better_low));
+			best_coalitions_high = _mm256_blendv_epi8(best_coalitions_high, coalitions, _mm256_castps_si256(is_better_high));
+			n_submask = (n_submask - n_mask) & n_mask;
+		} while (n_submask != 0u);
+		_mm256_storeu_ps(best_values, best_values_low);
+		_mm256_storeu_ps(best_values + 8, best_values_high);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(best_coalitions), best_coalitions_low);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(best_coalitions + 8), best_coalitions_high);
+	}
+
+	MAX_PLUS_TARGET("avx512f") void evaluate_batch_avx512(const uint32_t n_mask, const float* coalition_values, const float* previous_values,
+		float* best_values, uint32_t* best_coalitions)
+	{
+		static_assert(max_plus::BATCH_LANES == 16, "The AVX-512 batch kernel works on one vector of 16 lanes.");
+		__m512 best_lane_values{ _mm512_set1_ps(std::numeric_limits<float>::lowest()) };
+		__m512i best_lane_coalitions{ _mm512_setzero_si512() };
+		uint32_t n_submask{ 0u };
+		do
+		{
+			const __m512 values{ _mm512_add_ps(_mm512_loadu_ps(coalition_values + static_cast<uint64_t>(n_submask) * 16),
+				_mm512_loadu_ps(previous_values + static_cast<uint64_t>(n_mask & ~n_submask) * 16)) };
+			const __mmask16 is_better{ _mm512_cmp_ps_mask(values, best_lane_values, _CMP_GT_OQ) };
+			best_lane_values = _mm512_mask_blend_ps(is_better, best_lane_values, values);
+			best_lane_coalitions = _mm512_mask_blend_epi32(is_better, best_lane_coalitions, _mm512_set1_epi32(static_cast<int>(n_submask)));
+			n_submask = (n_submask - n_mask) & n_mask;
+		} while (n_submask != 0u);
+		_mm512_storeu_ps(best_values, best_lane_values);
+		_mm512_storeu_si512(best_coalitions, best_lane_coalitions);
+	}
+
+#if defined(__GNUG__)
+	bool cpu_supports_avx2()
+	{
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+	}
+
+	bool cpu_supports_avx512()
+	{
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("popcnt");
+	}
+#elif defined(_MSC_VER)
+	// CPUID leaf 7 reports AVX2 in bit 5 and AVX-512F in bit 16 of EBX. The operating system must
+	// also save the YMM (and for AVX-512 the ZMM and mask) registers, as reported by XGETBV.
+	bool cpu_supports(const int n_leaf_7_bit, const unsigned long long n_xcr0_bits)
+	{
+		int cpu_info[4];
+		__cpuid(cpu_info, 0);
+		if (cpu_info[0] < 7)
+		{
+			return false;
+		}
+		__cpuid(cpu_info, 1);
+		const bool has_osxsave{ (cpu_info[2] & (1 << 27)) != 0 };
+		if (!has_osxsave || (_xgetbv(0) & n_xcr0_bits) != n_xcr0_bits)
+		{
+			return false;
+		}
+		__cpuidex(cpu_info, 7, 0);
+		return (cpu_info[1] & (1 << n_leaf_7_bit)) != 0;
+	}
+
+	bool cpu_supports_avx2()
+	{
+		return cpu_supports(5, 0x6);
+	}
+
+	bool cpu_supports_avx512()
+	{
+		return cpu_supports(16, 0xE6);
+	}
+#endif
+
+	const bool has_avx2{ cpu_supports_avx2() };
+	const bool has_avx512{ cpu_supports_avx512() };
+#else
+	const bool has_avx2{ false };
+	const bool has_avx512{ false };
+#endif
+}
+
+bool max_plus::is_supported(const max_plus_kernel_t kernel)
+{
+	switch (kernel)
+	{
+	case max_plus_kernel_t::AVX2:
+		return has_avx2;
+	case max_plus_kernel_t::AVX512:
+		return has_avx512;
+	default:
+		return true;
+	}
+}
+
+max_plus_kernel_t max_plus::get_best_kernel()
+{
+	return has_avx512 ? max_plus_kernel_t::AVX512 : has_avx2 ? max_plus_kernel_t::AVX2 : max_plus_kernel_t::SCALAR;
+}
+
+max_plus::kernel_function_t max_plus::get_kernel(const max_plus_kernel_t kernel)
+{
+	if (!is_supported(kernel))
+	{
+		throw std::invalid_argument("The max-plus kernel is not supported by this CPU.");
+	}
+	switch (kernel)
+	{
+#ifdef MAX_PLUS_X86
+	case max_plus_kernel_t::AVX2:
+		return evaluate_avx2_any_stride;
+	case max_plus_kernel_t::AVX512:
+		return evaluate_avx512_any_stride;
+#endif
+	default:
+		return evaluate_scalar;
+	}
+}
+
+max_plus::batch_kernel_function_t max_plus::get_batch_kernel(const max_plus_kernel_t kernel)
+{
+	if (!is_supported(kernel))
+	{
+		throw std::invalid_argument("The max-plus kernel is not supported by this CPU.");
+	}
+	switch (kernel)
+	{
+#ifdef MAX_PLUS_X86
+	case max_plus_kernel_t::AVX2:
+		return evaluate_batch_avx2;
+	case max_plus_kernel_t::AVX512:
+		return evaluate_batch_avx512;
+#endif
+	default:
+		return evaluate_batch_scalar;
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+	Implementations of the max-plus step of the DP solver, which for a mask of unassigned
+	agents finds the coalition (submask) maximizing its value plus the value of the
+	remaining agents in the previous layer.
+
+	SCALAR		One submask at a time. Runs on any CPU.
+	AVX2		8 submasks per instruction: the submasks are split into the 8 subsets
+				of the lowest 3 agents of the mask, held in the lanes of a vector, and
+				the subsets of the other agents, which are enumerated one by one. Both
+				values are gathered and the best value and coalition are kept per lane.
+	AVX512		As AVX2, with 16 submasks per instruction.
+
+	All kernels return the same value and coalition as evaluating the submasks in
+	increasing order and keeping the first best one, as the values are added in the
+	same way and ties between lanes go to the smallest coalition.
+*/
+enum class max_plus_kernel_t
+{
+	SCALAR, AVX2, AVX512
+};
+
+struct max_plus_result_t
+{
+	float value;
+	uint32_t coalition_mask;
+};
+
+namespace max_plus
+{
+	/*
+		Returns the maximum over all submasks C of n_mask of
+			coalition_values[C * coalition_stride] + previous_values[(n_mask & ~C) * previous_stride],
+		and the smallest C attaining it. The strides are in floats. Vector kernels fall back on
+		the scalar one when an index would not fit in 31 bits.
+	*/
+	using kernel_function_t = max_plus_result_t(*)(const uint32_t n_mask, const float* coalition_values, const uint32_t coalition_stride,
+		const float* previous_values, const uint32_t previous_stride);
+
+	// True if the CPU (and the operating system) supports the instructions of kernel.
+	bool is_supported(const max_plus_kernel_t kernel);
+	// The fastest kernel supported by the CPU, detected once at startup.
+	max_plus_kernel_t get_best_kernel();
+	// Throws std::invalid_argument if the kernel is not supported.
+	kernel_function_t get_kernel(const max_plus_kernel_t kernel);
+
+	/*
+		Batch kernels evaluate one mask for BATCH_LANES independent instances of the same size at
+		once, whose values are interleaved: value i of lane l is at i * BATCH_LANES + l. For every
+		lane, best_values and best_coalitions get the maximum over all submasks C of n_mask of
+			coalition_values[C * BATCH_LANES + l] + previous_values[(n_mask & ~C) * BATCH_LANES + l]
+		and the smallest C attaining it, i.e. the same as the other kernels do for one instance.
+	*/
+	constexpr uint32_t BATCH_LANES{ 16 };
+	using batch_kernel_function_t = void(*)(const uint32_t n_mask, const float* coalition_values, const float* previous_values,
+		float* best_values, uint32_t* best_coalitions);
+
+	// Throws std::invalid_argument if the kernel is not supported.
+	batch_kernel_function_t get_batch_kernel(const max_plus_kernel_t kernel);
+}
@@ -97,5 +97,9 @@ problem_t& problem_t::operator=(problem_t&& o)
 
 void problem_t::allocate()
 {
+	generator->set_value_cache_budget(specification.value_cache_budget);
+	generator->set_value_table_layout(specification.value_table_layout);
+	generator->set_value_generation(specification.value_generation, specification.value_generation_threads);
+	generator->set_value_table_directory(specification.value_table_directory);
 	generator->generate_coalitional_values(specification.n_agents, specification.n_tasks, specification.seed);
 }
\ No newline at end of file
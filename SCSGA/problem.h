@@ -28,6 +28,11 @@ struct problem_specification_t {
 	int seed;
 	distribution_t distribution;
 	std::string distribution_file_name{ "" };
+	uint64_t value_cache_budget{ 0 }; // Bytes for lazily generated values of problems with more than 32 agents, 0 for no limit.
+	value_table_layout_t value_table_layout{ value_table_layout_t::TASK_MAJOR }; // Memory layout of the values of problems with at most 32 agents.
+	value_generation_t value_generation{ value_generation_t::SEQUENTIAL };
+	uint32_t value_generation_threads{ 0 }; // Threads used for COUNTER_BASED generation, 0 for one per hardware thread.
+	std::string value_table_directory{ "" }; // Directory of memory-mapped value tables of problems with at most 32 agents, empty to keep them in memory.
 };
 
 std::string to_string(const problem_specification_t::distribution_t distribution_type);
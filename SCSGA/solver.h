@@ -1,13 +1,34 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <string>
 
 #include "instance_solution.h"
 #include "coalition.h"
+#include "deadline_token.h"
+
+/*
+	A solution that a solve found to be better than all of its earlier ones.
+
+	elapsed_time	Seconds since the solve started.
+	n_evaluations	The work the solver had done by then, in its own unit: solutions evaluated
+					by the local and random searches, nodes by branch and bound and subspaces
+					popped by the MP solvers.
+	value			The value of the solution.
+*/
+struct incumbent_t
+{
+	double elapsed_time;
+	uint64_t n_evaluations;
+	coalition::value_t value;
+};
 
 class solver
 {
 public:
+	using incumbent_observer_t = std::function<void(const incumbent_t&)>;
+
 	enum SOLVER_TYPE 
 	{ 
 		BRUTE_FORCE, 
@@ -19,15 +40,32 @@ public:
 		GENETIC, 
 		MCTS_FLAT,
 		SPMCTS,
-		SIMULATED_ANNEALING
+		SIMULATED_ANNEALING,
+		BRANCH_AND_BOUND
 	};
 
+	virtual ~solver() = default; // Solvers are deleted through solver pointers.
+
 	virtual instance_solution solve(coalitional_values_generator* coalitional_vales) = 0;
 
 	void set_time_limit(const double vTimeLimit) {
 		this->vTimeLimit = vTimeLimit;
 	}
 
+	// Stops the running solve early, or the next one if none is running. Can be called from any thread.
+	void cancel() {
+		deadline.cancel();
+	}
+
+	/*
+		Calls observer with every incumbent of the following solves. Solvers with several threads
+		call it from the thread that found the incumbent, but never from two threads at once.
+		An empty observer stops the calls.
+	*/
+	void set_incumbent_observer(incumbent_observer_t observer) {
+		incumbent_observer = std::move(observer);
+	}
+
 	static std::string convert_solver_type_to_string(SOLVER_TYPE solver_type)
 	{
 		switch (solver_type)
@@ -60,6 +98,8 @@ public:
 			return "MCTS-F";
 		case solver::SPMCTS:
 			return "SPMCTS";
+		case solver::BRANCH_AND_BOUND:
+			return "BB";
 		default:
 			return "unknown";
 		}
@@ -67,5 +107,13 @@ public:
 
 protected:
 	double vTimeLimit{ -1 };
+	deadline_token deadline; // Started by solve with vTimeLimit; polled instead of a clock.
+	incumbent_observer_t incumbent_observer;
+
+	void report_incumbent(const coalition::value_t value, const uint64_t n_evaluations) const {
+		if (incumbent_observer) {
+			incumbent_observer(incumbent_t{ deadline.get_elapsed_time(), n_evaluations, value });
+		}
+	}
 };
 
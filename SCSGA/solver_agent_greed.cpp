@@ -124,7 +124,7 @@ void solver_agent_greed::LocalSearch2Opt
 	coalitional_values_generator* pProblem,
 	std::vector<unsigned int>& AgentOrder,
 	std::default_random_engine& Generator,
-	utility::date_and_time::timer& timer,
+	const deadline_token& Deadline,
 	const int _nMaximumNumberOfIterations
 )
 {
@@ -157,7 +157,7 @@ void solver_agent_greed::LocalSearch2Opt
 		// *******************************
 		// Stochastic methods.
 		// *******************************
-	} while (bFoundImprovement && nIterations < _nMaximumNumberOfIterations);
+	} while (bFoundImprovement && nIterations < _nMaximumNumberOfIterations && !Deadline.expired());
 }
 
 void solver_agent_greed::HillClimb
@@ -166,7 +166,7 @@ void solver_agent_greed::HillClimb
 	coalitional_values_generator* pProblem, // The problem that we want to solve.
 	std::vector<unsigned int>& AgentOrder,
 	std::default_random_engine& Generator,
-	utility::date_and_time::timer& timer,
+	const deadline_token& Deadline,
 	const bool _ShuffleAgentsEachHillClimbIteration,
 	const int _HillClimbSwapLimit // -1 means no limit; keep on swapping for as long as we can improve the solution.
 )
@@ -225,14 +225,13 @@ void solver_agent_greed::HillClimb
 				SolutionToImprove.value += vBestAssignmentImprovementValue; // Should always be positive here.
 			}
 		}
-	} while (bFoundGoodSwap && nIterations++ != _HillClimbSwapLimit);
+	} while (bFoundGoodSwap && nIterations++ != _HillClimbSwapLimit && !Deadline.expired());
 }
 
 void solver_agent_greed::greedily_assign_agents
 (
 	coalitional_values_generator* problem,
 	instance_solution& solution,
-	utility::date_and_time::timer& timer,
 	std::vector<uint32_t> agents_to_assign
 )
 {
@@ -294,7 +293,7 @@ void solver_agent_greed::greedily_assign_agents
 
 	if (_RunHillClimbToPolish)
 	{
-		HillClimb(solution, problem, agents_to_assign, _generator, timer, false, 1000);
+		HillClimb(solution, problem, agents_to_assign, _generator, GetDeadline(), false, 1000);
 	}
 }
 
@@ -306,12 +305,11 @@ instance_solution solver_agent_greed::solve(coalitional_values_generator* proble
 	instance_solution best_solution;
 	best_solution.reset(problem->get_n_tasks(), problem->get_n_agents());
 
-	utility::date_and_time::timer timer{};
-
 	if (vTimeLimit < 0 || !_RunMultipleTimesWithShuffledAgents) // Single mode (without time limit).
 	{
-		timer.start_countdown(-1);
-		greedily_assign_agents(problem, best_solution, timer);
+		const deadline_token::guard deadline_guard{ deadline, -1 };
+		greedily_assign_agents(problem, best_solution);
+		report_incumbent(best_solution.value, 1);
 	}
 	else
 	{
@@ -322,7 +320,7 @@ instance_solution solver_agent_greed::solve(coalitional_values_generator* proble
 		std::vector<unsigned int> AgentOrder(problem->get_n_agents());
 		std::iota(AgentOrder.begin(), AgentOrder.end(), 0);
 
-		timer.start_countdown(vTimeLimit);
+		const deadline_token::guard deadline_guard{ deadline, vTimeLimit };
 
 		std::uniform_int_distribution<int> agent_distribution(0, problem->get_n_agents());
 		std::uniform_int_distribution<int> task_distribution(0, problem->get_n_tasks() - 1);
@@ -333,16 +331,17 @@ instance_solution solver_agent_greed::solve(coalitional_values_generator* proble
 			++nTimesRun;
 			temp_solution.reset(problem->get_n_tasks(), problem->get_n_agents());
 
-			greedily_assign_agents(problem, temp_solution, timer, AgentOrder);
+			greedily_assign_agents(problem, temp_solution, AgentOrder);
 
 			if (!bBestSolutionHasBeenSet || best_solution.value < temp_solution.value)
 			{
 				best_solution = temp_solution;
 				bBestSolutionHasBeenSet = true;
+				report_incumbent(best_solution.value, nTimesRun);
 			}
 
 			// Check if time ran out.
-			if (timer.countdown_reached())
+			if (HasExpired())
 			{
 				break;
 			}
@@ -369,24 +368,36 @@ instance_solution solver_agent_greed::solve(coalitional_values_generator* proble
 
 	instance_solution best_solution{}, temp_solution{};
 	bool found_solution{ false };
-	utility::date_and_time::timer timer{};
+	uint64_t n_times_run{};
 	std::default_random_engine engine{};
 	srand(time(NULL));
 	engine.seed(rand());
-	timer.start_countdown(vTimeLimit);
+	const deadline_token::guard deadline_guard{ deadline, vTimeLimit };
 	do {
 		temp_solution = partial_solution;
-		greedily_assign_agents(problem, temp_solution, timer, unassigned_agents);
+		greedily_assign_agents(problem, temp_solution, unassigned_agents);
+		++n_times_run;
 		if (!found_solution || temp_solution.value > best_solution.value)
 		{
 			found_solution = true;
 			best_solution = temp_solution;
+			report_incumbent(best_solution.value, n_times_run);
 		}
 		std::shuffle(unassigned_agents.begin(), unassigned_agents.end(), engine);
-	} while (vTimeLimit >= 0 && _RunMultipleTimesWithShuffledAgents && !timer.countdown_reached());
+	} while (vTimeLimit >= 0 && _RunMultipleTimesWithShuffledAgents && !HasExpired());
 	return best_solution;
 }
 
+const deadline_token& solver_agent_greed::GetDeadline() const
+{
+	return _pParentDeadline != nullptr ? *_pParentDeadline : deadline;
+}
+
+bool solver_agent_greed::HasExpired() const
+{
+	return deadline.expired() || (_pParentDeadline != nullptr && _pParentDeadline->expired());
+}
+
 instance_solution solver_agent_greed::solve(coalitional_values_generator* problem)
 {
 	return solve(problem, nullptr);
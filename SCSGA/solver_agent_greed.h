@@ -19,11 +19,15 @@ private:
 	void greedily_assign_agents(
 		coalitional_values_generator* problem,
 		instance_solution& solution,
-		utility::date_and_time::timer& timer,
 		std::vector<uint32_t> agents_to_assign = {}
 	);
+	// The deadline that the hill climb polls, the parent one if set.
+	const deadline_token& GetDeadline() const;
+	bool HasExpired() const;
 public:
 	unsigned _nSeed = 0;
+	// Also stops the solve when it expires, e.g. the deadline of a solver that starts from the greedy solution.
+	const deadline_token* _pParentDeadline = nullptr;
 	bool _RunMultipleTimesWithShuffledAgents = true;
 	bool _RunHillClimbToPolish = false;
 
@@ -33,7 +37,7 @@ public:
 		coalitional_values_generator* pProblem, // The problem that we want to solve.
 		std::vector<unsigned int>& AgentOrder,
 		std::default_random_engine& Generator,
-		utility::date_and_time::timer& timer, // Countdown timer initialized with desired time limit.
+		const deadline_token& Deadline, // Stops the search when it expires.
 		const int _nMaximumNumberOfIterations
 	);
 
@@ -43,7 +47,7 @@ public:
 		coalitional_values_generator* pProblem, // The problem that we want to solve.
 		std::vector<unsigned int>& AgentOrder,
 		std::default_random_engine& Generator,
-		utility::date_and_time::timer& timer, // Countdown timer initialized with desired time limit.
+		const deadline_token& Deadline, // Stops the hill climb between sweeps when it expires.
 		const bool _ShuffleAgentsEachHillClimbIteration = false,
 		const int _HillClimbSwapLimit = -1 // -1 means no limit; keep on swapping for as long as we can improve the solution.
 	);
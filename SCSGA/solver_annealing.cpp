@@ -13,8 +13,9 @@ instance_solution solver_annealing::solve(coalitional_values_generator* problem)
 	AcceptanceUniformGenerator = std::uniform_real_distribution<float>(0.0f, 1.0f);
 	const unsigned long long nMaxIterations = std::max<unsigned long long>(1ULL, nIterations);
 
-	utility::date_and_time::timer timer{};
-	timer.start_countdown(vTimeLimit);
+	const deadline_token::guard deadline_guard{ deadline, vTimeLimit };
+	utility::date_and_time::timer timer{}; // Only read for the temperature.
+	timer.start();
 
 	std::vector<uint32_t> nAgentAssignments(problem->get_n_agents(), 0);
 	current_solution = instance_solution();
@@ -41,6 +42,7 @@ instance_solution solver_annealing::solve(coalitional_values_generator* problem)
 	best_solution = current_solution;
 
 	unsigned nIteration = 0, solutions_evaluated = 0, solutions_improved = 0, reverts = 0, non_reverts = 0;
+	report_incumbent(best_solution.value, solutions_evaluated);
 
 	float T = 10000000.0f; // large number.
 
@@ -79,8 +81,9 @@ instance_solution solver_annealing::solve(coalitional_values_generator* problem)
 				best_solution = current_solution;
 				if (_RunHillClimbToPolish)
 				{
-					solver_agent_greed::HillClimb(best_solution, problem, agent_order, generator, timer, true);
+					solver_agent_greed::HillClimb(best_solution, problem, agent_order, generator, deadline, true);
 				}
+				report_incumbent(best_solution.value, solutions_evaluated);
 
 				// current_solution.value = best_solution.value;
 				++solutions_improved;
@@ -117,12 +120,15 @@ instance_solution solver_annealing::solve(coalitional_values_generator* problem)
 			}
 		}
 
+		if (deadline.expired())
+		{
+			break;
+		}
 		if (vTimeLimit >= 0) {
-			if (timer.countdown_reached())
+			if (nIteration % TEMPERATURE_UPDATE_INTERVAL == 0)
 			{
-				break;
+				T = float(vTimeLimit) / timer.get_time() - 1;
 			}
-			T = float(vTimeLimit) / timer.get_time() - 1;
 		}
 		else {
 			// Calculate temperature.
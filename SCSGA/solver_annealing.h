@@ -16,6 +16,9 @@ class solver_annealing : public solver
 	std::uniform_real_distribution<float> AcceptanceUniformGenerator;
 	std::default_random_engine generator;
 
+	// Iterations between the clock reads that update the temperature under a time limit.
+	static constexpr unsigned TEMPERATURE_UPDATE_INTERVAL = 64u;
+
 public:
 	unsigned seed = 0;
 	uint32_t nMaxSwapTries = 3u;
@@ -0,0 +1,224 @@
+#include "solver_branch_and_bound.h"
+
+bool solver_branch_and_bound::HasProvedOptimality() const
+{
+	return !_bTimedOut;
+}
+
+uint64_t solver_branch_and_bound::GetNumberOfNodes() const
+{
+	return _nNodes;
+}
+
+void solver_branch_and_bound::InitializeAgentOrder()
+{
+	_AgentOrder.resize(_nAgents);
+	std::iota(_AgentOrder.begin(), _AgentOrder.end(), 0);
+	if (_Bounds.max_marginal_value.empty())
+	{
+		return;
+	}
+
+	// Assign the agents whose task matters the most first, i.e. those with the largest spread of marginal values.
+	std::vector<coalition::value_t> MarginalSpreads(_nAgents), BestMarginalValues(_nAgents);
+	for (uint32_t nAgentIndex = 0; nAgentIndex < _nAgents; ++nAgentIndex)
+	{
+		coalition::value_t vBest = coalition::NEG_INF, vWorst = coalition::POS_INF;
+		for (uint32_t nTaskIndex = 0; nTaskIndex < _nTasks; ++nTaskIndex)
+		{
+			vBest = std::max(vBest, _Bounds.max_marginal_value[nTaskIndex][nAgentIndex]);
+			vWorst = std::min(vWorst, _Bounds.max_marginal_value[nTaskIndex][nAgentIndex]);
+		}
+		MarginalSpreads[nAgentIndex] = vBest - vWorst;
+		BestMarginalValues[nAgentIndex] = vBest;
+	}
+	std::stable_sort(_AgentOrder.begin(), _AgentOrder.end(), [&](const uint32_t nA, const uint32_t nB)
+	{
+		return MarginalSpreads[nA] > MarginalSpreads[nB];
+	});
+
+	_RemainingMarginalBounds.assign(_nAgents + 1, 0.0f);
+	for (uint32_t nDepth = _nAgents; nDepth-- > 0;)
+	{
+		_RemainingMarginalBounds[nDepth] = _RemainingMarginalBounds[nDepth + 1] + BestMarginalValues[_AgentOrder[nDepth]];
+	}
+}
+
+bool solver_branch_and_bound::CanPrune(const coalition::value_t vUpperBound) const
+{
+	return vUpperBound + _vBoundTolerance * (1.0f + std::abs(vUpperBound)) <= _vBestValue;
+}
+
+coalition::value_t solver_branch_and_bound::GetUpperBound(const uint32_t nDepth)
+{
+	coalition::value_t vValue = 0;
+	for (uint32_t nTaskIndex = 0; nTaskIndex < _nTasks; ++nTaskIndex)
+	{
+		vValue += _CoalitionValues[nTaskIndex];
+	}
+	const uint32_t nRemainingAgents = _nAgents - nDepth;
+	if (nRemainingAgents == 0)
+	{
+		return vValue;
+	}
+
+	coalition::value_t vUpperBound = coalition::POS_INF;
+	if (!_RemainingMarginalBounds.empty())
+	{
+		vUpperBound = vValue + _RemainingMarginalBounds[nDepth];
+		if (CanPrune(vUpperBound))
+		{
+			return vUpperBound;
+		}
+	}
+	if (_Bounds.max_value_of_size.empty())
+	{
+		return vUpperBound;
+	}
+
+	// Divide the remaining agents over the tasks: _AllocationBounds[k] bounds the tasks so far given k of the agents.
+	_AllocationBounds.assign(nRemainingAgents + 1, coalition::NEG_INF);
+	_AllocationBounds[0] = 0;
+	for (uint32_t nTaskIndex = 0; nTaskIndex < _nTasks; ++nTaskIndex)
+	{
+		const std::vector<coalition::value_t>& MaxValueOfSize = _Bounds.max_value_of_size[nTaskIndex];
+		const uint32_t nSize = _CoalitionSizes[nTaskIndex];
+		_NextAllocationBounds.assign(nRemainingAgents + 1, coalition::NEG_INF);
+		for (uint32_t nGiven = 0; nGiven <= nRemainingAgents; ++nGiven)
+		{
+			if (_AllocationBounds[nGiven] == coalition::NEG_INF)
+			{
+				continue;
+			}
+			_NextAllocationBounds[nGiven] = std::max(_NextAllocationBounds[nGiven], _AllocationBounds[nGiven] + _CoalitionValues[nTaskIndex]);
+			for (uint32_t nAdded = 1; nGiven + nAdded <= nRemainingAgents; ++nAdded)
+			{
+				coalition::value_t& vBound = _NextAllocationBounds[nGiven + nAdded];
+				vBound = std::max(vBound, _AllocationBounds[nGiven] + MaxValueOfSize[nSize + nAdded]);
+			}
+		}
+		std::swap(_AllocationBounds, _NextAllocationBounds);
+	}
+	return std::min(vUpperBound, _AllocationBounds[nRemainingAgents]);
+}
+
+void solver_branch_and_bound::Search(const uint32_t nDepth)
+{
+	++_nNodes;
+	if (deadline.expired())
+	{
+		_bTimedOut = true;
+	}
+	if (_bTimedOut)
+	{
+		return;
+	}
+
+	if (nDepth == _nAgents)
+	{
+		// Add the values in the same order as instance_solution::recalculate_value.
+		coalition::value_t vValue = 0;
+		for (uint32_t nTaskIndex = 0; nTaskIndex < _nTasks; ++nTaskIndex)
+		{
+			vValue += _CoalitionValues[nTaskIndex];
+		}
+		if (vValue > _vBestValue)
+		{
+			_vBestValue = vValue;
+			_BestAgentTasks = _AgentTasks;
+			report_incumbent(_vBestValue, _nNodes);
+		}
+		return;
+	}
+
+	// Try the tasks the agent adds the most value to first, to find good solutions early.
+	const uint32_t nAgentIndex = _AgentOrder[nDepth];
+	coalition::value_t* pChildValues = &_ChildValues[nDepth * _nTasks];
+	uint32_t* pChildOrder = &_ChildOrder[nDepth * _nTasks];
+	for (uint32_t nTaskIndex = 0; nTaskIndex < _nTasks; ++nTaskIndex)
+	{
+		_Coalitions[nTaskIndex].add_agent(nAgentIndex);
+		pChildValues[nTaskIndex] = _pProblem->get_value_of(_Coalitions[nTaskIndex], nTaskIndex);
+		_Coalitions[nTaskIndex].remove_agent(nAgentIndex);
+		pChildOrder[nTaskIndex] = nTaskIndex;
+	}
+	std::stable_sort(pChildOrder, pChildOrder + _nTasks, [&](const uint32_t nA, const uint32_t nB)
+	{
+		return pChildValues[nA] - _CoalitionValues[nA] > pChildValues[nB] - _CoalitionValues[nB];
+	});
+
+	for (uint32_t nChild = 0; nChild < _nTasks; ++nChild)
+	{
+		const uint32_t nTaskIndex = pChildOrder[nChild];
+		const coalition::value_t vPreviousValue = _CoalitionValues[nTaskIndex];
+		_Coalitions[nTaskIndex].add_agent(nAgentIndex);
+		_CoalitionValues[nTaskIndex] = pChildValues[nTaskIndex];
+		++_CoalitionSizes[nTaskIndex];
+		_AgentTasks[nAgentIndex] = nTaskIndex;
+
+		if (!CanPrune(GetUpperBound(nDepth + 1)))
+		{
+			Search(nDepth + 1);
+		}
+
+		_Coalitions[nTaskIndex].remove_agent(nAgentIndex);
+		_CoalitionValues[nTaskIndex] = vPreviousValue;
+		--_CoalitionSizes[nTaskIndex];
+	}
+}
+
+instance_solution solver_branch_and_bound::solve(coalitional_values_generator* pProblem)
+{
+	_pProblem = pProblem;
+	_nAgents = pProblem->get_n_agents();
+	_nTasks = pProblem->get_n_tasks();
+	const deadline_token::guard deadline_guard{ deadline, vTimeLimit };
+	_bTimedOut = false;
+	_nNodes = 0;
+
+	_Bounds = pProblem->get_value_bounds();
+	_RemainingMarginalBounds.clear();
+	if (_Bounds.max_value_of_size.empty() && _Bounds.max_marginal_value.empty() && _nAgents > coalitional_values_generator::MAX_AGENTS_IN_TABLE)
+	{
+		throw std::invalid_argument("Branch and bound needs value bounds, which the generator does not provide for problems with more than "
+			+ std::to_string(coalitional_values_generator::MAX_AGENTS_IN_TABLE) + " agents.");
+	}
+	InitializeAgentOrder();
+
+	// Start from the agent greedy solution.
+	solver_agent_greed AgentGreed;
+	AgentGreed._RunMultipleTimesWithShuffledAgents = false;
+	AgentGreed._RunHillClimbToPolish = true;
+	AgentGreed._pParentDeadline = &deadline;
+	instance_solution InitialSolution = AgentGreed.solve(pProblem);
+	InitialSolution.recalculate_value(pProblem);
+	const std::vector<int> InitialAgentTasks = InitialSolution.get_coalition_indices_of_agents(_nAgents);
+	_BestAgentTasks.assign(InitialAgentTasks.begin(), InitialAgentTasks.end());
+	_vBestValue = InitialSolution.value;
+	report_incumbent(_vBestValue, _nNodes);
+
+	_Coalitions.assign(_nTasks, coalition::coalition_t(_nAgents));
+	_CoalitionValues.resize(_nTasks);
+	for (uint32_t nTaskIndex = 0; nTaskIndex < _nTasks; ++nTaskIndex)
+	{
+		_CoalitionValues[nTaskIndex] = pProblem->get_value_of(_Coalitions[nTaskIndex], nTaskIndex);
+	}
+	_CoalitionSizes.assign(_nTasks, 0);
+	_AgentTasks.assign(_nAgents, 0);
+	_ChildValues.resize(static_cast<size_t>(_nAgents) * _nTasks);
+	_ChildOrder.resize(static_cast<size_t>(_nAgents) * _nTasks);
+
+	if (!CanPrune(GetUpperBound(0)))
+	{
+		Search(0);
+	}
+
+	instance_solution BestSolution;
+	BestSolution.reset(_nTasks, _nAgents);
+	for (uint32_t nAgentIndex = 0; nAgentIndex < _nAgents; ++nAgentIndex)
+	{
+		BestSolution.add_agent_to_coalition(nAgentIndex, _BestAgentTasks[nAgentIndex]);
+	}
+	BestSolution.recalculate_value(pProblem);
+	return BestSolution;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cmath>
+
+#include "solver.h"
+#include "solver_agent_greed.h"
+#include "utility.h"
+
+/*
+	Depth-first branch and bound over the assignments of agents to tasks. The agents are assigned
+	one at a time, each to the tasks in the order of the value it adds to them, and a partial
+	assignment is pruned when an upper bound on its best completion is no better than the best
+	solution found so far, which starts as the agent greedy solution. The bounds come from the
+	problem, see coalitional_values_generator::get_value_bounds:
+
+	- The value of a task with c agents that gets k more is at most the largest value of a
+	  coalition of c + k agents, and the remaining agents are divided over the tasks in the best
+	  possible way.
+	- Each remaining agent adds at most its largest marginal value over all tasks.
+
+	The smaller bound is used. Works for any number of agents, but a problem with more than 32
+	agents needs a generator that provides bounds. The solution is optimal if the search completes
+	within the time limit, see HasProvedOptimality.
+*/
+class solver_branch_and_bound : public solver
+{
+public:
+	float _vBoundTolerance = 1e-5f; // Relative slack added to every bound, so that rounding never prunes a better solution.
+
+	instance_solution solve(coalitional_values_generator* pProblem) override;
+
+	bool HasProvedOptimality() const; // True if the last solve explored or pruned every assignment.
+	uint64_t GetNumberOfNodes() const; // Partial assignments explored by the last solve.
+
+private:
+	coalitional_values_generator* _pProblem = nullptr;
+	uint32_t _nAgents = 0, _nTasks = 0;
+	value_bounds_t _Bounds;
+	std::vector<uint32_t> _AgentOrder; // Agent assigned at every depth.
+	std::vector<coalition::value_t> _RemainingMarginalBounds; // Sum of the largest marginal values of the agents from every depth on.
+
+	std::vector<coalition::coalition_t> _Coalitions;
+	std::vector<coalition::value_t> _CoalitionValues;
+	std::vector<uint32_t> _CoalitionSizes;
+	std::vector<uint32_t> _AgentTasks, _BestAgentTasks; // Task of every agent.
+	coalition::value_t _vBestValue = coalition::NEG_INF;
+
+	std::vector<coalition::value_t> _ChildValues; // Value of every task with the agent of a depth added, m per depth.
+	std::vector<uint32_t> _ChildOrder; // Order the tasks are tried in, m per depth.
+	std::vector<coalition::value_t> _AllocationBounds, _NextAllocationBounds;
+
+	bool _bTimedOut = false;
+	uint64_t _nNodes = 0;
+
+	void InitializeAgentOrder();
+	void Search(const uint32_t nDepth);
+	coalition::value_t GetUpperBound(const uint32_t nDepth);
+	bool CanPrune(const coalition::value_t vUpperBound) const;
+};
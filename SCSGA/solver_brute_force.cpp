@@ -1,37 +1,106 @@
 #include "solver_brute_force.h"
 
-void solver_brute_force::solve_brute_force_recursive(const uint32_t n_agent_index, instance_solution& current_solution)
+void solver_brute_force::solve_brute_force_recursive(const uint32_t n_agent_index, search_state_t& state) const
 {
+	const uint32_t n_tasks = problem->get_n_tasks();
 	if (n_agent_index == problem->get_n_agents())
 	{
-		// Calculate the value of this solution.
-		current_solution.recalculate_value(problem);
+		// Calculate the value of this solution, adding the values in the same order as instance_solution::recalculate_value.
+		coalition::value_t value = 0;
+		for (uint32_t n_task_index = 0; n_task_index < n_tasks; ++n_task_index)
+		{
+			value += state.coalition_values[n_task_index];
+		}
 
 		// Check if this solution is the best one found so far.
-		if (current_solution.value > best_solution.value)
+		if (value > state.best_value)
 		{
-			best_solution = current_solution;
+			state.best_value = value;
+			state.best_agent_tasks = state.agent_tasks;
 		}
-
 		return;
 	}
 
 	// Try to assign this agent to all coalitions.
-	for (uint32_t n_task_index = 0; n_task_index < problem->get_n_tasks(); ++n_task_index)
+	for (uint32_t n_task_index = 0; n_task_index < n_tasks; ++n_task_index)
 	{
-		current_solution.add_agent_to_coalition(n_agent_index, n_task_index);
-		solve_brute_force_recursive(n_agent_index + 1, current_solution);
-		current_solution.remove_agent_from_coalition(n_agent_index, n_task_index);
+		const coalition::value_t previous_value = state.coalition_values[n_task_index];
+		assign_agent(n_agent_index, n_task_index, state);
+		solve_brute_force_recursive(n_agent_index + 1, state);
+		state.coalition_masks[n_task_index] ^= 1u << n_agent_index;
+		state.coalition_values[n_task_index] = previous_value;
 	}
 }
 
+void solver_brute_force::assign_agent(const uint32_t n_agent_index, const uint32_t n_task_index, search_state_t& state) const
+{
+	state.coalition_masks[n_task_index] |= 1u << n_agent_index;
+	state.coalition_values[n_task_index] = problem->get_data().get_value_of(state.coalition_masks[n_task_index], n_task_index);
+	state.agent_tasks[n_agent_index] = n_task_index;
+}
+
 instance_solution solver_brute_force::solve(coalitional_values_generator* _problem)
 {
 	assert(_problem->get_n_agents() <= 32);
 	problem = _problem;
+	const uint32_t n_agents = problem->get_n_agents(), n_tasks = problem->get_n_tasks();
+
+	// A job fixes the tasks of the first n_prefix_agents agents. Job j assigns agent i to digit n_prefix_agents - 1 - i of j
+	// in base m, so the jobs enumerate the assignments in the same order as a single search.
+	const uint32_t n_threads = utility::parallel::get_n_threads(_nThreads);
+	uint32_t n_prefix_agents = 0;
+	uint64_t n_jobs = 1;
+	while (n_prefix_agents < n_agents && n_jobs < static_cast<uint64_t>(JOBS_PER_THREAD) * n_threads && n_tasks > 1)
+	{
+		++n_prefix_agents;
+		n_jobs *= n_tasks;
+	}
+
+	std::vector<search_state_t> job_results(n_jobs);
+	utility::parallel::for_each_index(n_jobs, n_threads, [&](const uint64_t n_job)
+	{
+		search_state_t state;
+		state.coalition_masks.assign(n_tasks, 0u);
+		state.coalition_values.resize(n_tasks);
+		for (uint32_t n_task_index = 0; n_task_index < n_tasks; ++n_task_index)
+		{
+			state.coalition_values[n_task_index] = problem->get_data().get_value_of(0u, n_task_index);
+		}
+		state.agent_tasks.assign(n_agents, 0u);
+		state.best_value = coalition::NEG_INF;
+
+		uint64_t n_prefix = n_job;
+		for (uint32_t n_agent_index = n_prefix_agents; n_agent_index-- > 0;)
+		{
+			assign_agent(n_agent_index, static_cast<uint32_t>(n_prefix % n_tasks), state);
+			n_prefix /= n_tasks;
+		}
+		solve_brute_force_recursive(n_prefix_agents, state);
+
+		job_results[n_job].best_value = state.best_value;
+		job_results[n_job].best_agent_tasks = std::move(state.best_agent_tasks);
+	});
+
+	// Take the best assignment of the first job that found it.
+	const search_state_t* best_result = &job_results[0];
+	for (const search_state_t& job_result : job_results)
+	{
+		if (job_result.best_value > best_result->best_value)
+		{
+			best_result = &job_result;
+		}
+	}
+
+	instance_solution best_solution;
+	best_solution.reset(n_tasks, n_agents);
 	best_solution.value = coalition::NEG_INF;
-	instance_solution temp_solution;
-	temp_solution.reset(_problem->get_n_tasks(), _problem->get_n_agents());
-	solve_brute_force_recursive(0, temp_solution);
+	if (!best_result->best_agent_tasks.empty() || n_agents == 0)
+	{
+		for (uint32_t n_agent_index = 0; n_agent_index < n_agents; ++n_agent_index)
+		{
+			best_solution.add_agent_to_coalition(n_agent_index, best_result->best_agent_tasks[n_agent_index]);
+		}
+		best_solution.recalculate_value(problem);
+	}
 	return best_solution;
 }
@@ -1,14 +1,36 @@
 #pragma once
 #include "solver.h"
+#include "utility.h"
+
+/*
+	Evaluates all m^n assignments of agents to tasks. The assignments are split into jobs by the
+	tasks of the first agents, which are solved on _nThreads threads. Within a job, agents are
+	assigned one after the other and the value of a coalition is looked up when an agent joins
+	or leaves it, so a complete assignment only sums m values. The best assignment is kept as
+	the task of every agent. Finds the same solution as enumerating all assignments in order on
+	a single thread, as ties go to the first job.
+*/
 class solver_brute_force : public solver
 {
 private:
+	static constexpr uint32_t JOBS_PER_THREAD = 16;
+
+	struct search_state_t
+	{
+		std::vector<uint32_t> coalition_masks; // Agents of every task.
+		std::vector<coalition::value_t> coalition_values; // Value of every task for its agents.
+		std::vector<uint32_t> agent_tasks; // Task of every assigned agent.
+		std::vector<uint32_t> best_agent_tasks;
+		coalition::value_t best_value;
+	};
+
 	coalitional_values_generator* problem = nullptr;
-	instance_solution best_solution;
 
-	void solve_brute_force_recursive(const uint32_t n_agent_index, instance_solution& current_solution);
+	void solve_brute_force_recursive(const uint32_t n_agent_index, search_state_t& state) const;
+	void assign_agent(const uint32_t n_agent_index, const uint32_t n_task_index, search_state_t& state) const;
 
 public:
+	uint32_t _nThreads = 1; // Threads the jobs are split across, 0 for one per hardware thread. The result does not depend on it.
+
 	instance_solution solve(coalitional_values_generator* _problem) override;
 };
-
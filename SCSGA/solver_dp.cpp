@@ -1,5 +1,10 @@
 #include "solver_dp.h"
 
+#include <filesystem>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
 inline float solver_dp::GetUtilityValueFor(const uint32_t nTaskIndex, const uint32_t nCoalitionMask)
 {
 	return (*_UtilityValues).get_value_of(nCoalitionMask, nTaskIndex);
@@ -7,6 +12,65 @@ inline float solver_dp::GetUtilityValueFor(const uint32_t nTaskIndex, const uint
 
 void solver_dp::SolveIterative()
 {
+	switch (_SubsetEnumeration)
+	{
+	case utility::bits::subset_enumeration_t::SOFTWARE_PDEP:
+		return SolveIterative<utility::bits::subset_enumeration_t::SOFTWARE_PDEP>();
+	case utility::bits::subset_enumeration_t::PDEP:
+		return SolveIterative<utility::bits::subset_enumeration_t::PDEP>();
+	case utility::bits::subset_enumeration_t::SUBMASK:
+		return SolveIterative<utility::bits::subset_enumeration_t::SUBMASK>();
+	}
+}
+
+void solver_dp::SolveRolling()
+{
+	// The files of the OUT_OF_CORE mode are removed when done, also on failure. The PDEP enumerations need fewer than 32 agents.
+	try
+	{
+		if (_nAgents >= 32 || _SubsetEnumeration == utility::bits::subset_enumeration_t::SUBMASK)
+		{
+			SolveRolling<utility::bits::subset_enumeration_t::SUBMASK>();
+		}
+		else if (_SubsetEnumeration == utility::bits::subset_enumeration_t::PDEP)
+		{
+			SolveRolling<utility::bits::subset_enumeration_t::PDEP>();
+		}
+		else
+		{
+			SolveRolling<utility::bits::subset_enumeration_t::SOFTWARE_PDEP>();
+		}
+	}
+	catch (...)
+	{
+		RemoveOutOfCoreFiles();
+		throw;
+	}
+	RemoveOutOfCoreFiles();
+}
+
+float solver_dp::SolveRecursive(const uint32_t nTaskIndex, const uint32_t nUnassignedAgentsMask)
+{
+	switch (_SubsetEnumeration)
+	{
+	case utility::bits::subset_enumeration_t::SOFTWARE_PDEP:
+		return SolveRecursive<utility::bits::subset_enumeration_t::SOFTWARE_PDEP>(nTaskIndex, nUnassignedAgentsMask);
+	case utility::bits::subset_enumeration_t::PDEP:
+		return SolveRecursive<utility::bits::subset_enumeration_t::PDEP>(nTaskIndex, nUnassignedAgentsMask);
+	default:
+		return SolveRecursive<utility::bits::subset_enumeration_t::SUBMASK>(nTaskIndex, nUnassignedAgentsMask);
+	}
+}
+
+template<utility::bits::subset_enumeration_t ENUMERATION>
+void solver_dp::SolveIterative()
+{
+	// Each task layer only reads the values of its own task, so the values of the next task are paged in
+	// while the current layer is evaluated, and those of a finished task are dropped.
+	const coalition_value_table& Values = _UtilityValues->get_data();
+	Values.advise_task(file_access_t::WILL_NEED, 0);
+	Values.advise_task(file_access_t::WILL_NEED, 1);
+
 	const uint32_t nNumberOfPossibleCoalitions = (1 << _nAgents);
 	for (uint32_t nUnassignedAgentsMask = 0u; nUnassignedAgentsMask < nNumberOfPossibleCoalitions; ++nUnassignedAgentsMask)
 	{
@@ -14,37 +78,521 @@ void solver_dp::SolveIterative()
 		_MemoizationTable[0][nUnassignedAgentsMask]._vUtilityValue = GetUtilityValueFor(0, nUnassignedAgentsMask);
 		_MemoizationTable[0][nUnassignedAgentsMask]._nBestCoalition = nUnassignedAgentsMask;
 	}
+	Values.advise_task(file_access_t::DONT_NEED, 0);
 
+	// A tile must have at least one high agent, or it is just the numeric order.
+	const uint32_t nTileBits = _nTileBits < _nAgents ? _nTileBits : 0u;
 	for (uint32_t nTaskIndex = 1u; nTaskIndex < _nTasks; ++nTaskIndex)
 	{
-		for (uint32_t nUnassignedAgentsMask = 0u; nUnassignedAgentsMask < nNumberOfPossibleCoalitions; ++nUnassignedAgentsMask)
+		Values.advise_task(file_access_t::WILL_NEED, nTaskIndex + 1);
+		if (nTileBits > 0)
 		{
-			// Try all other possible ways of assigning agents to this task, and improve the current best solution utility.
-			const uint32_t nNumberOfUnassignedAgents = utility::bits::bit_count_32bit(nUnassignedAgentsMask);
-			const uint32_t nNumberOfPossibleCoalitionsFromUnassignedAgents = (1u << nNumberOfUnassignedAgents);
+			ForEachBlockOfLayer(nTileBits, [&](const uint32_t nTile)
+			{
+				SolveTile<ENUMERATION>(nTaskIndex, nTile, nTileBits);
+			});
+		}
+		else
+		{
+			ForEachMaskOfLayer([&](const uint32_t nUnassignedAgentsMask)
+			{
+				SolveMask<ENUMERATION>(nTaskIndex, nUnassignedAgentsMask);
+			});
+		}
+		Values.advise_task(file_access_t::DONT_NEED, nTaskIndex);
+	}
+}
 
-			for (uint32_t nSkewedCoalitionMask = 0u; nSkewedCoalitionMask < nNumberOfPossibleCoalitionsFromUnassignedAgents; ++nSkewedCoalitionMask)
+template<utility::bits::subset_enumeration_t ENUMERATION>
+void solver_dp::SolveTile(const uint32_t nTaskIndex, const uint32_t nTile, const uint32_t nTileBits)
+{
+	// The states of the tile are the masks nTile << nTileBits | nLowMask. A coalition of such a state splits the same
+	// way into a high part, a submask of nTile, and a low part, a submask of nLowMask, and the remaining agents are
+	// (nTile & ~nHighCoalition) << nTileBits | (nLowMask & ~nLowCoalition). For one high part of the coalitions, all
+	// states of the tile therefore only read one tile of values and one tile of the previous layer. The high parts are
+	// visited in increasing order, and the low parts too, so the coalitions of a state are evaluated in increasing
+	// order and the first best one is kept, exactly as in SolveMask.
+	MemoizationEntry* pCurrentTile = _MemoizationTable[nTaskIndex].data() + (static_cast<size_t>(nTile) << nTileBits);
+	const std::vector<MemoizationEntry>& PreviousLayer = _MemoizationTable[nTaskIndex - 1];
+	const uint32_t nStatesPerTile = 1u << nTileBits;
+	utility::bits::for_each_submask_32bit<ENUMERATION>(nTile, [&](const uint32_t nHighCoalition)
+	{
+		const uint32_t nCoalitionOffset = nHighCoalition << nTileBits;
+		const MemoizationEntry* pPreviousTile = PreviousLayer.data() + (static_cast<size_t>(nTile & ~nHighCoalition) << nTileBits);
+		for (uint32_t nLowMask = 0u; nLowMask < nStatesPerTile; ++nLowMask)
+		{
+			MemoizationEntry& CurrentEntry = pCurrentTile[nLowMask];
+			if (_EvaluateMaxPlus != nullptr)
+			{
+				const max_plus_result_t Best = _EvaluateMaxPlus(nLowMask,
+					_pFirstTaskValues + nTaskIndex * _nTaskStride + static_cast<uint64_t>(nCoalitionOffset) * _nCoalitionStride, _nCoalitionStride,
+					reinterpret_cast<const float*>(pPreviousTile), 2);
+				if (Best.value > CurrentEntry._vUtilityValue)
+				{
+					CurrentEntry._vUtilityValue = Best.value;
+					CurrentEntry._nBestCoalition = nCoalitionOffset | Best.coalition_mask;
+				}
+				continue;
+			}
+			utility::bits::for_each_submask_32bit<ENUMERATION>(nLowMask, [&](const uint32_t nLowCoalition)
 			{
-				// Calculate a mask that represents the current coalition we want to try.
-				const uint32_t nRealCoalitionMask = utility::bits::calc_parallel_bits_deposit_32bit(nSkewedCoalitionMask, nUnassignedAgentsMask);
-				const uint32_t nNewUnassignedAgentsMask = nUnassignedAgentsMask & (~nRealCoalitionMask);
+				const float vNewSolutionUtility =
+					GetUtilityValueFor(nTaskIndex, nCoalitionOffset | nLowCoalition) +
+					pPreviousTile[nLowMask & (~nLowCoalition)]._vUtilityValue;
+
+				if (vNewSolutionUtility > CurrentEntry._vUtilityValue)
+				{
+					CurrentEntry._vUtilityValue = vNewSolutionUtility;
+					CurrentEntry._nBestCoalition = nCoalitionOffset | nLowCoalition;
+				}
+			});
+		}
+	});
+}
 
-				// Calculate the utility value for assigning that mask to this task.
+template<utility::bits::subset_enumeration_t ENUMERATION>
+inline void solver_dp::SolveMask(const uint32_t nTaskIndex, const uint32_t nUnassignedAgentsMask)
+{
+	MemoizationEntry& CurrentEntry = _MemoizationTable[nTaskIndex][nUnassignedAgentsMask];
+	const std::vector<MemoizationEntry>& PreviousLayer = _MemoizationTable[nTaskIndex - 1];
+	if (_EvaluateMaxPlus != nullptr)
+	{
+		// The previous values are read in place, every other float of the layer.
+		static_assert(sizeof(MemoizationEntry) == 2 * sizeof(float), "Memoization entries must be two floats wide.");
+		const max_plus_result_t Best = _EvaluateMaxPlus(nUnassignedAgentsMask, _pFirstTaskValues + nTaskIndex * _nTaskStride, _nCoalitionStride,
+			reinterpret_cast<const float*>(PreviousLayer.data()), 2);
+		CurrentEntry._vUtilityValue = Best.value;
+		CurrentEntry._nBestCoalition = Best.coalition_mask;
+		return;
+	}
+
+	// Try all other possible ways of assigning agents to this task, and improve the current best solution utility.
+	utility::bits::for_each_submask_32bit<ENUMERATION>(nUnassignedAgentsMask, [&](const uint32_t nRealCoalitionMask)
+	{
+		const uint32_t nNewUnassignedAgentsMask = nUnassignedAgentsMask & (~nRealCoalitionMask);
+
+		// Calculate the utility value for assigning that mask to this task.
+		const float vNewSolutionUtility =
+			GetUtilityValueFor(nTaskIndex, nRealCoalitionMask) +
+			PreviousLayer[nNewUnassignedAgentsMask]._vUtilityValue;
+
+		if (vNewSolutionUtility > CurrentEntry._vUtilityValue)
+		{
+			// Found a better assignment than before.
+			CurrentEntry._vUtilityValue = vNewSolutionUtility;
+			CurrentEntry._nBestCoalition = nRealCoalitionMask;
+		}
+	});
+}
+
+template<utility::bits::subset_enumeration_t ENUMERATION>
+void solver_dp::SolveRolling()
+{
+	// Same recurrence as SolveIterative, keeping only the values of the previous and the current layer.
+	const coalition_value_table& Values = _UtilityValues->get_data();
+	Values.advise_task(file_access_t::WILL_NEED, 0);
+	Values.advise_task(file_access_t::WILL_NEED, 1);
+
+	const uint64_t nNumberOfPossibleCoalitions = 1ull << _nAgents;
+	const uint32_t nAllAgentsMask = static_cast<uint32_t>(nNumberOfPossibleCoalitions - 1);
+	AllocateRollingLayers(_MemoryMode != dp_memory_t::RECOMPUTE && _nTasks > 2 ? _nTasks - 2 : 0u);
+	_TaskBestCoalitions.assign(_nTasks, 0u);
+
+	// The out of core mode always works on tiles, which also keeps the loops within 32 bits for 32 agents.
+	const bool bOutOfCore = _MemoryMode == dp_memory_t::OUT_OF_CORE;
+	const uint32_t nTileBits = bOutOfCore
+		? std::min({ _nTileBits > 0 ? _nTileBits : OUT_OF_CORE_TILE_BITS, _nAgents, 31u })
+		: (_nTileBits < _nAgents ? _nTileBits : 0u);
+	const bool bTiled = bOutOfCore || nTileBits > 0;
+
+	if (bTiled)
+	{
+		ForEachBlockOfLayer(nTileBits, [&](const uint32_t nTile)
+		{
+			for (uint32_t nLowMask = 0u; nLowMask < (1u << nTileBits); ++nLowMask)
+			{
+				const uint32_t nUnassignedAgentsMask = (nTile << nTileBits) | nLowMask;
+				_pPreviousLayerValues[nUnassignedAgentsMask] = GetUtilityValueFor(0, nUnassignedAgentsMask);
+			}
+		});
+	}
+	else
+	{
+		ForEachMaskOfLayer([&](const uint32_t nUnassignedAgentsMask)
+		{
+			_pPreviousLayerValues[nUnassignedAgentsMask] = GetUtilityValueFor(0, nUnassignedAgentsMask);
+		});
+	}
+	Values.advise_task(file_access_t::DONT_NEED, 0);
+
+	for (uint32_t nTaskIndex = 1u; nTaskIndex + 1 < _nTasks; ++nTaskIndex)
+	{
+		Values.advise_task(file_access_t::WILL_NEED, nTaskIndex + 1);
+		uint32_t* pBestCoalitions = _pLayerBestCoalitions == nullptr ? nullptr : _pLayerBestCoalitions + (nTaskIndex - 1) * nNumberOfPossibleCoalitions;
+		if (bOutOfCore)
+		{
+			// The reader follows the order in which the tiles are handed out.
+			const uint32_t nThreads = utility::parallel::get_n_threads(_nThreads);
+			if (nThreads > 1 && _BlockOrder.size() != (1u << (_nAgents - nTileBits)))
+			{
+				SortBlocksByWork(nTileBits);
+			}
+			utility::parallel::lookahead_gate Gate{ static_cast<uint64_t>(READ_AHEAD_PAIRS) * nThreads };
+			std::thread Reader([&]() { ReadAheadLayer(nTaskIndex, nTileBits, Gate); });
+			_pReadAheadGate = &Gate;
+			try
+			{
+				ForEachBlockOfLayer(nTileBits, [&](const uint32_t nTile)
+				{
+					SolveRollingTile<ENUMERATION>(nTaskIndex, nTile, nTileBits, pBestCoalitions);
+				});
+			}
+			catch (...)
+			{
+				Gate.close();
+				Reader.join();
+				_pReadAheadGate = nullptr;
+				throw;
+			}
+			Gate.close();
+			Reader.join();
+			_pReadAheadGate = nullptr;
+		}
+		else if (bTiled)
+		{
+			ForEachBlockOfLayer(nTileBits, [&](const uint32_t nTile)
+			{
+				SolveRollingTile<ENUMERATION>(nTaskIndex, nTile, nTileBits, pBestCoalitions);
+			});
+		}
+		else
+		{
+			ForEachMaskOfLayer([&](const uint32_t nUnassignedAgentsMask)
+			{
+				uint32_t nBestCoalition;
+				SolveRollingMask<ENUMERATION>(nTaskIndex, nUnassignedAgentsMask, _pCurrentLayerValues[nUnassignedAgentsMask], nBestCoalition);
+				if (pBestCoalitions != nullptr)
+				{
+					pBestCoalitions[nUnassignedAgentsMask] = nBestCoalition;
+				}
+			});
+		}
+		SwapRollingLayers();
+		Values.advise_task(file_access_t::DONT_NEED, nTaskIndex);
+	}
+
+	// Only the state with all agents unassigned is needed from the last layer.
+	uint32_t nUnassignedAgentsMask = nAllAgentsMask;
+	if (_nTasks > 1)
+	{
+		float vBestSolutionUtility;
+		SolveRollingMask<ENUMERATION>(_nTasks - 1, nAllAgentsMask, vBestSolutionUtility, _TaskBestCoalitions[_nTasks - 1]);
+		nUnassignedAgentsMask &= ~_TaskBestCoalitions[_nTasks - 1];
+	}
+
+	// Reconstruct the optimal solution from the last task down.
+	for (uint32_t nTaskIndex = _nTasks > 1 ? _nTasks - 2 : 0u; nTaskIndex > 0; --nTaskIndex)
+	{
+		if (_MemoryMode != dp_memory_t::RECOMPUTE)
+		{
+			_TaskBestCoalitions[nTaskIndex] = _pLayerBestCoalitions[(nTaskIndex - 1) * nNumberOfPossibleCoalitions + nUnassignedAgentsMask];
+		}
+		else
+		{
+			// The values of the layers below only depend on the states reachable from the unassigned agents, so they
+			// are solved again for the submasks of these, with the exact same operations as in the first pass.
+			SolveRollingLayers<ENUMERATION>(nTaskIndex - 1, nUnassignedAgentsMask);
+			float vBestSolutionUtility;
+			SolveRollingMask<ENUMERATION>(nTaskIndex, nUnassignedAgentsMask, vBestSolutionUtility, _TaskBestCoalitions[nTaskIndex]);
+		}
+		nUnassignedAgentsMask &= ~_TaskBestCoalitions[nTaskIndex];
+	}
+	_TaskBestCoalitions[0] = nUnassignedAgentsMask;
+}
+
+template<utility::bits::subset_enumeration_t ENUMERATION>
+inline void solver_dp::SolveRollingMask(const uint32_t nTaskIndex, const uint32_t nUnassignedAgentsMask, float& vBestSolutionUtility, uint32_t& nBestCoalition) const
+{
+	// Evaluates the coalitions in the same order and keeps the first best one, like SolveMask.
+	if (_EvaluateMaxPlus != nullptr)
+	{
+		const max_plus_result_t Best = _EvaluateMaxPlus(nUnassignedAgentsMask, _pFirstTaskValues + nTaskIndex * _nTaskStride, _nCoalitionStride,
+			_pPreviousLayerValues, 1);
+		vBestSolutionUtility = Best.value;
+		nBestCoalition = Best.coalition_mask;
+		return;
+	}
+	vBestSolutionUtility = std::numeric_limits<float>::lowest();
+	nBestCoalition = 0u;
+	utility::bits::for_each_submask_32bit<ENUMERATION>(nUnassignedAgentsMask, [&](const uint32_t nRealCoalitionMask)
+	{
+		const float vNewSolutionUtility =
+			_UtilityValues->get_value_of(nRealCoalitionMask, nTaskIndex) +
+			_pPreviousLayerValues[nUnassignedAgentsMask & (~nRealCoalitionMask)];
+
+		if (vNewSolutionUtility > vBestSolutionUtility)
+		{
+			vBestSolutionUtility = vNewSolutionUtility;
+			nBestCoalition = nRealCoalitionMask;
+		}
+	});
+}
+
+template<utility::bits::subset_enumeration_t ENUMERATION>
+void solver_dp::SolveRollingLayers(const uint32_t nLastTaskIndex, const uint32_t nUnassignedAgentsMask)
+{
+	// Leaves the values of layer nLastTaskIndex for all submasks of nUnassignedAgentsMask in _pPreviousLayerValues.
+	utility::bits::for_each_submask_32bit<ENUMERATION>(nUnassignedAgentsMask, [&](const uint32_t nMask)
+	{
+		_pPreviousLayerValues[nMask] = GetUtilityValueFor(0, nMask);
+	});
+	for (uint32_t nTaskIndex = 1u; nTaskIndex <= nLastTaskIndex; ++nTaskIndex)
+	{
+		utility::bits::for_each_submask_32bit<ENUMERATION>(nUnassignedAgentsMask, [&](const uint32_t nMask)
+		{
+			uint32_t nBestCoalition;
+			SolveRollingMask<ENUMERATION>(nTaskIndex, nMask, _pCurrentLayerValues[nMask], nBestCoalition);
+		});
+		SwapRollingLayers();
+	}
+}
+
+template<utility::bits::subset_enumeration_t ENUMERATION>
+void solver_dp::SolveRollingTile(const uint32_t nTaskIndex, const uint32_t nTile, const uint32_t nTileBits, uint32_t* pBestCoalitions)
+{
+	// The rolling counterpart of SolveTile, which finds the same values and coalitions as SolveRollingMask.
+	const uint32_t nStatesPerTile = 1u << nTileBits;
+	float* pCurrentTile = _pCurrentLayerValues + (static_cast<uint64_t>(nTile) << nTileBits);
+	uint32_t* pBestTile = pBestCoalitions == nullptr ? nullptr : pBestCoalitions + (static_cast<uint64_t>(nTile) << nTileBits);
+	std::fill_n(pCurrentTile, nStatesPerTile, std::numeric_limits<float>::lowest());
+	if (pBestTile != nullptr)
+	{
+		std::fill_n(pBestTile, nStatesPerTile, 0u);
+	}
+
+	utility::bits::for_each_submask_32bit<ENUMERATION>(nTile, [&](const uint32_t nHighCoalition)
+	{
+		const uint32_t nCoalitionOffset = nHighCoalition << nTileBits;
+		const float* pPreviousTile = _pPreviousLayerValues + (static_cast<uint64_t>(nTile & ~nHighCoalition) << nTileBits);
+		for (uint32_t nLowMask = 0u; nLowMask < nStatesPerTile; ++nLowMask)
+		{
+			float& vBestSolutionUtility = pCurrentTile[nLowMask];
+			if (_EvaluateMaxPlus != nullptr)
+			{
+				const max_plus_result_t Best = _EvaluateMaxPlus(nLowMask,
+					_pFirstTaskValues + nTaskIndex * _nTaskStride + static_cast<uint64_t>(nCoalitionOffset) * _nCoalitionStride, _nCoalitionStride,
+					pPreviousTile, 1);
+				if (Best.value > vBestSolutionUtility)
+				{
+					vBestSolutionUtility = Best.value;
+					if (pBestTile != nullptr)
+					{
+						pBestTile[nLowMask] = nCoalitionOffset | Best.coalition_mask;
+					}
+				}
+				continue;
+			}
+			utility::bits::for_each_submask_32bit<ENUMERATION>(nLowMask, [&](const uint32_t nLowCoalition)
+			{
 				const float vNewSolutionUtility =
-					GetUtilityValueFor(nTaskIndex, nRealCoalitionMask) +
-					_MemoizationTable[nTaskIndex - 1][nNewUnassignedAgentsMask]._vUtilityValue;
+					_UtilityValues->get_value_of(nCoalitionOffset | nLowCoalition, nTaskIndex) +
+					pPreviousTile[nLowMask & (~nLowCoalition)];
 
-				if (vNewSolutionUtility > _MemoizationTable[nTaskIndex][nUnassignedAgentsMask]._vUtilityValue)
+				if (vNewSolutionUtility > vBestSolutionUtility)
 				{
-					// Found a better assignment than before.
-					_MemoizationTable[nTaskIndex][nUnassignedAgentsMask]._vUtilityValue = vNewSolutionUtility;
-					_MemoizationTable[nTaskIndex][nUnassignedAgentsMask]._nBestCoalition = nRealCoalitionMask;
+					vBestSolutionUtility = vNewSolutionUtility;
+					if (pBestTile != nullptr)
+					{
+						pBestTile[nLowMask] = nCoalitionOffset | nLowCoalition;
+					}
 				}
+			});
+		}
+		if (_pReadAheadGate != nullptr)
+		{
+			_pReadAheadGate->finish_item();
+		}
+	});
+}
+
+void solver_dp::AllocateRollingLayers(const uint32_t nBestCoalitionLayers)
+{
+	const uint64_t nNumberOfPossibleCoalitions = 1ull << _nAgents;
+	RemoveOutOfCoreFiles();
+	if (_MemoryMode != dp_memory_t::OUT_OF_CORE)
+	{
+		_PreviousLayerValues.resize(nNumberOfPossibleCoalitions);
+		_CurrentLayerValues.resize(nNumberOfPossibleCoalitions);
+		_LayerBestCoalitions.resize(nBestCoalitionLayers * nNumberOfPossibleCoalitions);
+		_pPreviousLayerValues = _PreviousLayerValues.data();
+		_pCurrentLayerValues = _CurrentLayerValues.data();
+		_pLayerBestCoalitions = nBestCoalitionLayers > 0 ? _LayerBestCoalitions.data() : nullptr;
+		return;
+	}
+
+	std::vector<float>().swap(_PreviousLayerValues);
+	std::vector<float>().swap(_CurrentLayerValues);
+	std::vector<uint32_t>().swap(_LayerBestCoalitions);
+
+	// The files of solvers running at the same time must not collide.
+	std::random_device RandomDevice;
+	const uint64_t nFileKey = (static_cast<uint64_t>(RandomDevice()) << 32) | RandomDevice();
+	std::ostringstream FileNamePrefix;
+	FileNamePrefix << "scsga_dp_" << std::hex << std::setw(16) << std::setfill('0') << nFileKey;
+	const std::filesystem::path Directory = _OutOfCoreDirectory.empty() ? std::filesystem::temp_directory_path() : std::filesystem::path(_OutOfCoreDirectory);
+	_sPreviousLayerFileName = (Directory / (FileNamePrefix.str() + "_previous.bin")).string();
+	_sCurrentLayerFileName = (Directory / (FileNamePrefix.str() + "_current.bin")).string();
+	_sBestCoalitionsFileName = (Directory / (FileNamePrefix.str() + "_coalitions.bin")).string();
+
+	_PreviousLayerFile.create(_sPreviousLayerFileName, nNumberOfPossibleCoalitions * sizeof(float));
+	_CurrentLayerFile.create(_sCurrentLayerFileName, nNumberOfPossibleCoalitions * sizeof(float));
+	_pPreviousLayerValues = reinterpret_cast<float*>(_PreviousLayerFile.data());
+	_pCurrentLayerValues = reinterpret_cast<float*>(_CurrentLayerFile.data());
+	_pLayerBestCoalitions = nullptr;
+	if (nBestCoalitionLayers > 0)
+	{
+		_BestCoalitionsFile.create(_sBestCoalitionsFileName, nBestCoalitionLayers * nNumberOfPossibleCoalitions * sizeof(uint32_t));
+		_pLayerBestCoalitions = reinterpret_cast<uint32_t*>(_BestCoalitionsFile.data());
+	}
+}
+
+void solver_dp::SwapRollingLayers()
+{
+	std::swap(_pPreviousLayerValues, _pCurrentLayerValues);
+	if (_CurrentLayerFile.is_open())
+	{
+		// Recreating the file of the old previous layer drops its pages, so writing the next layer does not read them from disk again.
+		std::swap(_PreviousLayerFile, _CurrentLayerFile);
+		std::swap(_sPreviousLayerFileName, _sCurrentLayerFileName);
+		_CurrentLayerFile.create(_sCurrentLayerFileName, _PreviousLayerFile.size());
+		_pCurrentLayerValues = reinterpret_cast<float*>(_CurrentLayerFile.data());
+	}
+}
+
+void solver_dp::RemoveOutOfCoreFiles()
+{
+	_PreviousLayerFile.close();
+	_CurrentLayerFile.close();
+	_BestCoalitionsFile.close();
+	for (std::string* pFileName : { &_sPreviousLayerFileName, &_sCurrentLayerFileName, &_sBestCoalitionsFileName })
+	{
+		if (!pFileName->empty())
+		{
+			std::error_code Error;
+			std::filesystem::remove(*pFileName, Error);
+			pFileName->clear();
+		}
+	}
+	_pPreviousLayerValues = nullptr;
+	_pCurrentLayerValues = nullptr;
+	_pLayerBestCoalitions = nullptr;
+}
+
+void solver_dp::ReadAheadLayer(const uint32_t nTaskIndex, const uint32_t nTileBits, utility::parallel::lookahead_gate& Gate) const
+{
+	// Visits the pairs of a tile and a high part of its coalitions in the order of SolveRollingTile, and touches the tile of
+	// values and the tile of the previous layer each pair reads, unless the pair was already solved.
+	const bool bSerial = utility::parallel::get_n_threads(_nThreads) == 1;
+	const uint32_t nTiles = 1u << (_nAgents - nTileBits);
+	const uint64_t nStatesPerTile = 1ull << nTileBits;
+	uint64_t nPair = 0;
+	bool bOpen = true;
+	for (uint32_t nTileIndex = 0u; nTileIndex < nTiles && bOpen; ++nTileIndex)
+	{
+		const uint32_t nTile = bSerial ? nTileIndex : _BlockOrder[nTileIndex];
+		utility::bits::for_each_submask_32bit<utility::bits::subset_enumeration_t::SUBMASK>(nTile, [&](const uint32_t nHighCoalition)
+		{
+			bOpen = bOpen && Gate.wait_for_item(nPair);
+			if (bOpen && nPair >= Gate.get_n_finished())
+			{
+				TouchPages(_pFirstTaskValues + nTaskIndex * _nTaskStride + (static_cast<uint64_t>(nHighCoalition) << nTileBits) * _nCoalitionStride,
+					((nStatesPerTile - 1) * _nCoalitionStride + 1) * sizeof(float));
+				TouchPages(_pPreviousLayerValues + (static_cast<uint64_t>(nTile & ~nHighCoalition) << nTileBits), nStatesPerTile * sizeof(float));
 			}
+			++nPair;
+		});
+	}
+}
+
+void solver_dp::TouchPages(const void* pData, const uint64_t nBytes)
+{
+	// Reading one byte of every page makes the operating system read the pages of a mapped file from disk now.
+	constexpr uint64_t PAGE_SIZE = 4096;
+	const volatile uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+	for (uint64_t nByte = 0; nByte < nBytes; nByte += PAGE_SIZE)
+	{
+		pBytes[nByte];
+	}
+}
+
+template<typename Function>
+void solver_dp::ForEachMaskOfLayer(Function&& function)
+{
+	// The entries of a layer only depend on the previous layer, so a layer may be split across threads, each entry
+	// being evaluated exactly as in the serial loop.
+	if (utility::parallel::get_n_threads(_nThreads) == 1)
+	{
+		// 64 bits, so that all 2^32 masks of 32 agents are visited.
+		const uint64_t nNumberOfPossibleCoalitions = 1ull << _nAgents;
+		for (uint64_t nUnassignedAgentsMask = 0u; nUnassignedAgentsMask < nNumberOfPossibleCoalitions; ++nUnassignedAgentsMask)
+		{
+			function(static_cast<uint32_t>(nUnassignedAgentsMask));
+		}
+		return;
+	}
+
+	const uint32_t nBlockBits = std::min(BLOCK_BITS, _nAgents);
+	ForEachBlockOfLayer(nBlockBits, [&](const uint32_t nBlock)
+	{
+		const uint32_t nFirstMask = nBlock << nBlockBits;
+		for (uint32_t nMaskIndex = 0u; nMaskIndex < (1u << nBlockBits); ++nMaskIndex)
+		{
+			function(nFirstMask | nMaskIndex);
+		}
+	});
+}
+
+template<typename Function>
+void solver_dp::ForEachBlockOfLayer(const uint32_t nBlockBits, Function&& function)
+{
+	// Calls function for the high bits of every block of 2^nBlockBits consecutive masks, in increasing order when serial.
+	// The work of a mask grows as 2^popcount, and so does the work of a block of masks with the popcount of its high
+	// bits. Blocks are therefore handed out largest first, so that the small blocks at the end even out the load of the threads.
+	const uint32_t nThreads = utility::parallel::get_n_threads(_nThreads);
+	const uint32_t nBlocks = 1u << (_nAgents - nBlockBits);
+	if (nThreads == 1)
+	{
+		for (uint32_t nBlock = 0u; nBlock < nBlocks; ++nBlock)
+		{
+			function(nBlock);
 		}
+		return;
+	}
+
+	if (_BlockOrder.size() != nBlocks)
+	{
+		SortBlocksByWork(nBlockBits);
+	}
+	utility::parallel::for_each_index(nBlocks, nThreads, [&](const uint64_t nBlockIndex)
+	{
+		function(_BlockOrder[nBlockIndex]);
+	});
+}
+
+void solver_dp::SortBlocksByWork(const uint32_t nBlockBits)
+{
+	_BlockOrder.resize(1u << (_nAgents - nBlockBits));
+	for (uint32_t nBlock = 0u; nBlock < _BlockOrder.size(); ++nBlock)
+	{
+		_BlockOrder[nBlock] = nBlock;
 	}
+	std::stable_sort(_BlockOrder.begin(), _BlockOrder.end(), [](const uint32_t nBlockA, const uint32_t nBlockB)
+	{
+		return utility::bits::bit_count_32bit(nBlockA) > utility::bits::bit_count_32bit(nBlockB);
+	});
 }
 
+template<utility::bits::subset_enumeration_t ENUMERATION>
 float solver_dp::SolveRecursive(const uint32_t nTaskIndex, const uint32_t nUnassignedAgentsMask)
 {
 	MemoizationEntry& _CurrentMemoizationEntry = _MemoizationTable[nTaskIndex][nUnassignedAgentsMask];
@@ -66,23 +614,22 @@ float solver_dp::SolveRecursive(const uint32_t nTaskIndex, const uint32_t nUnass
 	uint32_t& nBestSolutionMembers = _CurrentMemoizationEntry._nBestCoalition;
 
 	// Initialize the best possible utility we can achieve as assigning zero agents to this task.
-	vBestSolutionUtility = GetUtilityValueFor(nTaskIndex, 0) + SolveRecursive(nTaskIndex - 1, nUnassignedAgentsMask);
+	vBestSolutionUtility = GetUtilityValueFor(nTaskIndex, 0) + SolveRecursive<ENUMERATION>(nTaskIndex - 1, nUnassignedAgentsMask);
 	nBestSolutionMembers = 0;
 
 #if _USE_PDEP
 	// Try all other possible ways of assigning agents to this task, and improve the current best solution utility.
-	const int nNumberOfUnassignedAgents = utility::bits::bit_count_32bit(nUnassignedAgentsMask);
-	const uint32_t nNumberOfPossibleCoalitions = (1 << nNumberOfUnassignedAgents);
-
-	for (uint32_t nSkewedCoalitionMask = 1; nSkewedCoalitionMask < nNumberOfPossibleCoalitions; ++nSkewedCoalitionMask)
+	utility::bits::for_each_submask_32bit<ENUMERATION>(nUnassignedAgentsMask, [&](const uint32_t nRealCoalitionMask)
 	{
-		// Calculate a mask that represents the current coalition we want to try.
-		const uint32_t nRealCoalitionMask = utility::bits::calc_parallel_bits_deposit_32bit(nSkewedCoalitionMask, nUnassignedAgentsMask);
+		if (nRealCoalitionMask == 0)
+		{
+			return; // Already evaluated above.
+		}
 		const uint32_t nNewUnassignedAgentsMask = nUnassignedAgentsMask & (~nRealCoalitionMask);
 
 		// Calculate the utility value for assigning that mask to this task.
 		const float vNewSolutionUtility
-			= GetUtilityValueFor(nTaskIndex, nRealCoalitionMask) + SolveRecursive(nTaskIndex - 1, nNewUnassignedAgentsMask);
+			= GetUtilityValueFor(nTaskIndex, nRealCoalitionMask) + SolveRecursive<ENUMERATION>(nTaskIndex - 1, nNewUnassignedAgentsMask);
 
 		if (vNewSolutionUtility > vBestSolutionUtility)
 		{
@@ -90,7 +637,7 @@ float solver_dp::SolveRecursive(const uint32_t nTaskIndex, const uint32_t nUnass
 			vBestSolutionUtility = vNewSolutionUtility;
 			nBestSolutionMembers = nRealCoalitionMask;
 		}
-	}
+	});
 #else
 	for (uint32_t nCoalitionMask = 1; nCoalitionMask < _UtilityValues->get_n_coalitions(); ++nCoalitionMask)
 	{
@@ -101,7 +648,7 @@ float solver_dp::SolveRecursive(const uint32_t nTaskIndex, const uint32_t nUnass
 
 			// Calculate the utility value for assigning that mask to this task.
 			const float vNewSolutionUtility
-				= GetUtilityValueFor(nTaskIndex, nCoalitionMask) + SolveRecursive(nTaskIndex - 1, nNewUnassignedAgentsMask);
+				= GetUtilityValueFor(nTaskIndex, nCoalitionMask) + SolveRecursive<ENUMERATION>(nTaskIndex - 1, nNewUnassignedAgentsMask);
 
 			if (vNewSolutionUtility > vBestSolutionUtility)
 			{
@@ -120,6 +667,25 @@ float solver_dp::SolveRecursive(const uint32_t nTaskIndex, const uint32_t nUnass
 instance_solution solver_dp::solve(coalitional_values_generator* problem)
 {
 	_UtilityValues = problem, _nAgents = problem->get_n_agents(), _nTasks = problem->get_n_tasks();
+	_EvaluateMaxPlus = _UseMaxPlusKernel ? max_plus::get_kernel(_MaxPlusKernel) : nullptr;
+	_pFirstTaskValues = problem->get_data().data();
+	_nCoalitionStride = static_cast<uint32_t>(problem->get_data().get_coalition_stride());
+	_nTaskStride = problem->get_data().get_task_stride();
+
+	instance_solution Solution;
+	if (_MemoryMode != dp_memory_t::FULL)
+	{
+		std::vector<std::vector<MemoizationEntry>>().swap(_MemoizationTable);
+		SolveRolling();
+		for (const uint32_t nBestCoalition : _TaskBestCoalitions)
+		{
+			coalition::coalition_t current_coalition(_nAgents);
+			current_coalition.set_value(nBestCoalition);
+			Solution.ordered_coalition_structure.push_back(current_coalition);
+		}
+		Solution.recalculate_value(problem);
+		return Solution;
+	}
 
 	// Initialize memoization table.
 	const uint32_t nNumberOfPossibleCoalitions = 1 << _nAgents;
@@ -132,7 +698,6 @@ instance_solution solver_dp::solve(coalitional_values_generator* problem)
 		nAllAgentBits |= (1 << i);
 	}
 
-	instance_solution Solution;
 #if _USE_RECV
 	SolveRecursive(_nTasks - 1, nAllAgentBits);
 #else 
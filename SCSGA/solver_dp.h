@@ -1,10 +1,42 @@
 #pragma once
 #include "solver.h"
 #include "utility.h"
+#include "max_plus.h"
+#include "mapped_file.h"
 
 #define _USE_PDEP true
 #define _USE_RECV false
 
+/*
+	How much of the DP table solver_dp keeps, for n agents and m tasks.
+
+	FULL		The value and best coalition of every state of every task layer,
+				8 * m * 2^n bytes.
+	ROLLING		The values of the previous and the current layer only, and the best
+				coalition of every state of the layers 1 to m - 2, which is all the
+				reconstruction needs, 4 * m * 2^n bytes.
+	RECOMPUTE	The values of the previous and the current layer only, 8 * 2^n bytes.
+				The best coalitions are recomputed during the reconstruction, by
+				solving the layers below each task again for the submasks of the
+				agents still unassigned. Takes up to m / 2 times as long as FULL when
+				the first tasks get most agents, typically less than twice as long.
+	OUT_OF_CORE	As ROLLING, but the layers and the best coalitions are memory-mapped
+				files in _OutOfCoreDirectory, 4 * m * 2^n bytes of disk, which are
+				removed when done. The layers are solved in tiles (_nTileBits, or
+				OUT_OF_CORE_TILE_BITS if 0), and a reader thread reads the tiles needed
+				next from disk while the current ones are solved, so only a few tiles
+				need to fit in memory. With a mapped value table, i.e. a binary problem
+				file or a value table directory, problems of up to 32 agents fit a
+				large disk.
+
+	The lean modes only evaluate the state with all agents unassigned in the last
+	layer. All modes find the same solution.
+*/
+enum class dp_memory_t
+{
+	FULL, ROLLING, RECOMPUTE, OUT_OF_CORE
+};
+
 class solver_dp :
 	public solver
 {
@@ -18,11 +50,77 @@ public:
 	uint32_t _nAgents = 0, _nTasks = 0;
 	coalitional_values_generator* _UtilityValues = nullptr; // Utiliy values (performances measures) of coalition-to-task/goal assignments.
 	std::vector<std::vector<MemoizationEntry>> _MemoizationTable; // DP table used to store intermediate solutions.
+	utility::bits::subset_enumeration_t _SubsetEnumeration = utility::bits::subset_enumeration_t::SUBMASK; // How coalitions of the unassigned agents are enumerated.
+	uint32_t _nThreads = 1; // Threads each task layer is split across, 0 for one per hardware thread. The result does not depend on it.
+	dp_memory_t _MemoryMode = dp_memory_t::FULL;
+	/*
+		Traversal order of the task layers of SolveIterative. 0 visits the states in numeric order. Otherwise the
+		states are split into tiles of 2^_nTileBits states sharing their high agents, and each tile is solved one
+		high part of the coalitions at a time, so that only one tile of the current layer, of the previous layer
+		and of the values is used at once. Each tile is visited 2^k times for its k high agents, so small tiles
+		add overhead; tiles of 2^15 to 2^17 states fit a 2 MB L2 cache. The solution is the same.
+	*/
+	uint32_t _nTileBits = 0;
+	// Evaluate each state with a max-plus kernel instead of the loop over _SubsetEnumeration. The solution is the same.
+	bool _UseMaxPlusKernel = false;
+	max_plus_kernel_t _MaxPlusKernel = max_plus::get_best_kernel();
+	std::vector<float> _PreviousLayerValues, _CurrentLayerValues; // Rolling value layers of the ROLLING and RECOMPUTE modes.
+	std::vector<uint32_t> _LayerBestCoalitions; // Best coalition of every state of the layers 1 to m - 2 in ROLLING mode, one layer after the other.
+	std::vector<uint32_t> _TaskBestCoalitions; // Coalition of every task in the optimal solution, found by SolveRolling.
+	std::string _OutOfCoreDirectory; // Directory of the files of the OUT_OF_CORE mode, the temporary directory if empty.
 
 	inline float GetUtilityValueFor(const uint32_t nTaskIndex, const uint32_t nCoalitionMask);
 
 	void SolveIterative();
+	void SolveRolling();
 	float SolveRecursive(const uint32_t nTaskIndex, const uint32_t nUnassignedAgentsMask);
 
 	instance_solution solve(coalitional_values_generator* problem);
+
+private:
+	static constexpr uint32_t BLOCK_BITS = 10; // A parallel work item covers 2^BLOCK_BITS consecutive masks of a layer.
+	static constexpr uint32_t OUT_OF_CORE_TILE_BITS = 16;
+	static constexpr uint32_t READ_AHEAD_PAIRS = 4; // Pairs of tiles the reader of the OUT_OF_CORE mode reads ahead of each thread.
+
+	// Blocks of masks in the order they are handed out to threads, see SolveIterative.
+	std::vector<uint32_t> _BlockOrder;
+	max_plus::kernel_function_t _EvaluateMaxPlus = nullptr; // Set by solve if _UseMaxPlusKernel.
+	const float* _pFirstTaskValues = nullptr; // Values of task 0 and the strides between values, in floats, for _EvaluateMaxPlus.
+	uint32_t _nCoalitionStride = 0;
+	uint64_t _nTaskStride = 0;
+
+	// Layers of the rolling modes, in the vectors above or in the files of the OUT_OF_CORE mode.
+	float* _pPreviousLayerValues = nullptr;
+	float* _pCurrentLayerValues = nullptr;
+	uint32_t* _pLayerBestCoalitions = nullptr;
+	mapped_file _PreviousLayerFile, _CurrentLayerFile, _BestCoalitionsFile;
+	std::string _sPreviousLayerFileName, _sCurrentLayerFileName, _sBestCoalitionsFileName;
+	utility::parallel::lookahead_gate* _pReadAheadGate = nullptr; // Told about every solved pair of tiles in OUT_OF_CORE mode.
+
+	template<utility::bits::subset_enumeration_t ENUMERATION>
+	void SolveIterative();
+	template<utility::bits::subset_enumeration_t ENUMERATION>
+	void SolveMask(const uint32_t nTaskIndex, const uint32_t nUnassignedAgentsMask);
+	template<utility::bits::subset_enumeration_t ENUMERATION>
+	void SolveRolling();
+	template<utility::bits::subset_enumeration_t ENUMERATION>
+	void SolveRollingMask(const uint32_t nTaskIndex, const uint32_t nUnassignedAgentsMask, float& vBestSolutionUtility, uint32_t& nBestCoalition) const;
+	template<utility::bits::subset_enumeration_t ENUMERATION>
+	void SolveRollingLayers(const uint32_t nLastTaskIndex, const uint32_t nUnassignedAgentsMask);
+	template<utility::bits::subset_enumeration_t ENUMERATION>
+	void SolveRollingTile(const uint32_t nTaskIndex, const uint32_t nTile, const uint32_t nTileBits, uint32_t* pBestCoalitions);
+	void AllocateRollingLayers(const uint32_t nBestCoalitionLayers);
+	void SwapRollingLayers();
+	void RemoveOutOfCoreFiles();
+	void ReadAheadLayer(const uint32_t nTaskIndex, const uint32_t nTileBits, utility::parallel::lookahead_gate& Gate) const;
+	static void TouchPages(const void* pData, const uint64_t nBytes);
+	template<utility::bits::subset_enumeration_t ENUMERATION>
+	void SolveTile(const uint32_t nTaskIndex, const uint32_t nTile, const uint32_t nTileBits);
+	template<typename Function>
+	void ForEachMaskOfLayer(Function&& function);
+	template<typename Function>
+	void ForEachBlockOfLayer(const uint32_t nBlockBits, Function&& function);
+	void SortBlocksByWork(const uint32_t nBlockBits);
+	template<utility::bits::subset_enumeration_t ENUMERATION>
+	float SolveRecursive(const uint32_t nTaskIndex, const uint32_t nUnassignedAgentsMask);
 };
\ No newline at end of file
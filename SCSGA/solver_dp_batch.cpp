@@ -0,0 +1,117 @@
+#include "solver_dp_batch.h"
+
+#include <stdexcept>
+#include <string>
+
+std::vector<instance_solution> solver_dp_batch::solve(const std::vector<coalitional_values_generator*>& Problems) const
+{
+	std::vector<instance_solution> Solutions(Problems.size());
+	if (Problems.empty())
+	{
+		return Solutions;
+	}
+	const uint32_t nAgents = Problems[0]->get_n_agents(), nTasks = Problems[0]->get_n_tasks();
+	for (const coalitional_values_generator* pProblem : Problems)
+	{
+		if (pProblem->get_n_agents() != nAgents || pProblem->get_n_tasks() != nTasks)
+		{
+			throw std::invalid_argument("All problems of a batch must have the same number of agents and tasks, "
+				+ std::to_string(nAgents) + " and " + std::to_string(nTasks) + " as the first one.");
+		}
+	}
+	if (nAgents > 32)
+	{
+		throw std::invalid_argument("Batched problems can have at most 32 agents.");
+	}
+	if (nTasks == 0)
+	{
+		// Without tasks there is no coalition to assign, and every solution is empty with value zero.
+		return Solutions;
+	}
+
+	const max_plus::batch_kernel_function_t EvaluateBatch = max_plus::get_batch_kernel(_MaxPlusKernel);
+	const uint64_t nBatches = (Problems.size() + max_plus::BATCH_LANES - 1) / max_plus::BATCH_LANES;
+	utility::parallel::for_each_index(nBatches, _nThreads, [&](const uint64_t nBatch)
+	{
+		SolveBatch(Problems, nBatch * max_plus::BATCH_LANES, EvaluateBatch, Solutions);
+	});
+	return Solutions;
+}
+
+void solver_dp_batch::SolveBatch(const std::vector<coalitional_values_generator*>& Problems, const size_t nFirstProblem,
+	const max_plus::batch_kernel_function_t EvaluateBatch, std::vector<instance_solution>& Solutions) const
+{
+	constexpr uint32_t LANES = max_plus::BATCH_LANES;
+	const uint32_t nAgents = Problems[0]->get_n_agents(), nTasks = Problems[0]->get_n_tasks();
+	const uint32_t nProblems = static_cast<uint32_t>(std::min<size_t>(LANES, Problems.size() - nFirstProblem));
+	const uint64_t nNumberOfPossibleCoalitions = 1ull << nAgents;
+	const uint32_t nAllAgentsMask = static_cast<uint32_t>(nNumberOfPossibleCoalitions - 1);
+
+	// Value i of problem l of the batch is at i * LANES + l. Unused lanes solve a problem of zeros.
+	std::vector<float> Values(nTasks * nNumberOfPossibleCoalitions * LANES, 0.0f);
+	for (uint32_t nLane = 0u; nLane < nProblems; ++nLane)
+	{
+		const coalition_value_table& Table = Problems[nFirstProblem + nLane]->get_data();
+		for (uint32_t nTaskIndex = 0u; nTaskIndex < nTasks; ++nTaskIndex)
+		{
+			float* pTaskValues = Values.data() + nTaskIndex * nNumberOfPossibleCoalitions * LANES + nLane;
+			for (uint64_t nCoalitionMask = 0u; nCoalitionMask < nNumberOfPossibleCoalitions; ++nCoalitionMask)
+			{
+				pTaskValues[nCoalitionMask * LANES] = Table.get_value_of(static_cast<uint32_t>(nCoalitionMask), nTaskIndex);
+			}
+		}
+	}
+
+	// The recurrence of the ROLLING mode of solver_dp: the values of the previous and the current layer,
+	// the best coalitions of the layers 1 to m - 2 and only the state with all agents unassigned in the last layer.
+	std::vector<float> PreviousLayerValues(Values.begin(), Values.begin() + nNumberOfPossibleCoalitions * LANES);
+	std::vector<float> CurrentLayerValues(nNumberOfPossibleCoalitions * LANES);
+	std::vector<uint32_t> LayerBestCoalitions((nTasks > 2 ? nTasks - 2 : 0u) * nNumberOfPossibleCoalitions * LANES);
+	for (uint32_t nTaskIndex = 1u; nTaskIndex + 1 < nTasks; ++nTaskIndex)
+	{
+		const float* pTaskValues = Values.data() + nTaskIndex * nNumberOfPossibleCoalitions * LANES;
+		uint32_t* pBestCoalitions = LayerBestCoalitions.data() + (nTaskIndex - 1) * nNumberOfPossibleCoalitions * LANES;
+		for (uint64_t nUnassignedAgentsMask = 0u; nUnassignedAgentsMask < nNumberOfPossibleCoalitions; ++nUnassignedAgentsMask)
+		{
+			EvaluateBatch(static_cast<uint32_t>(nUnassignedAgentsMask), pTaskValues, PreviousLayerValues.data(),
+				CurrentLayerValues.data() + nUnassignedAgentsMask * LANES, pBestCoalitions + nUnassignedAgentsMask * LANES);
+		}
+		PreviousLayerValues.swap(CurrentLayerValues);
+	}
+
+	float LastValues[LANES];
+	uint32_t LastBestCoalitions[LANES]{};
+	if (nTasks > 1)
+	{
+		EvaluateBatch(nAllAgentsMask, Values.data() + (nTasks - 1) * nNumberOfPossibleCoalitions * LANES, PreviousLayerValues.data(),
+			LastValues, LastBestCoalitions);
+	}
+
+	// Reconstruct the optimal solution of every problem from the last task down.
+	std::vector<uint32_t> TaskBestCoalitions(nTasks);
+	for (uint32_t nLane = 0u; nLane < nProblems; ++nLane)
+	{
+		uint32_t nUnassignedAgentsMask = nAllAgentsMask;
+		if (nTasks > 1)
+		{
+			TaskBestCoalitions[nTasks - 1] = LastBestCoalitions[nLane];
+			nUnassignedAgentsMask &= ~LastBestCoalitions[nLane];
+		}
+		for (uint32_t nTaskIndex = nTasks > 1 ? nTasks - 2 : 0u; nTaskIndex > 0; --nTaskIndex)
+		{
+			TaskBestCoalitions[nTaskIndex] =
+				LayerBestCoalitions[((nTaskIndex - 1) * nNumberOfPossibleCoalitions + nUnassignedAgentsMask) * LANES + nLane];
+			nUnassignedAgentsMask &= ~TaskBestCoalitions[nTaskIndex];
+		}
+		TaskBestCoalitions[0] = nUnassignedAgentsMask;
+
+		instance_solution& Solution = Solutions[nFirstProblem + nLane];
+		for (const uint32_t nBestCoalition : TaskBestCoalitions)
+		{
+			coalition::coalition_t current_coalition(nAgents);
+			current_coalition.set_value(nBestCoalition);
+			Solution.ordered_coalition_structure.push_back(current_coalition);
+		}
+		Solution.recalculate_value(Problems[nFirstProblem + nLane]);
+	}
+}
@@ -91,9 +91,11 @@ void solver_genetic::MutatePopulationPool()
 	std::vector<instance_solution> Children = RecombineAndBreed(ParentIndices);
 	for (const auto& Child : Children)
 	{
+		++_nGeneratedSolutions;
 		if (Child.value > _BestSolution.value)
 		{
 			_BestSolution = Child;
+			report_incumbent(_BestSolution.value, _nGeneratedSolutions);
 		}
 	}
 	// Select the best new solutions and keep them (i.e., merge with population pool).
@@ -112,6 +114,7 @@ void solver_genetic::MutatePopulationPool()
 void solver_genetic::InitializePopulationPool()
 {
 	_BestSolution.value = std::numeric_limits<coalition::value_t>().lowest();
+	_nGeneratedSolutions = 0;
 	_PopulationPool.reserve(uint64_t(_nPopulationPoolSize) + uint64_t(_nNewChildrenPerMutation));
 	_PopulationPool.resize(_nPopulationPoolSize);
 	for (unsigned nIndex = 0; nIndex < _nPopulationPoolSize; ++nIndex)
@@ -128,11 +131,13 @@ void solver_genetic::InitializePopulationPool()
 		}
 
 		_PopulationPool[nIndex].recalculate_value(_pProblem);
+		++_nGeneratedSolutions;
 
 		// Keep track of the best solution found so far.
 		if (_PopulationPool[nIndex].value > _BestSolution.value)
 		{
 			_BestSolution = _PopulationPool[nIndex];
+			report_incumbent(_BestSolution.value, _nGeneratedSolutions);
 		}
 	}
 }
@@ -155,29 +160,21 @@ instance_solution solver_genetic::solve(coalitional_values_generator* problem)
 		ShuffledCoalitionIndices.push_back(nCoalitionIndex);
 	}
 
+	// Started before the initial population, so that the times of its incumbents are measured from the start of the solve too.
+	const deadline_token::guard deadline_guard{ deadline, vTimeLimit };
+
 	InitializePopulationPool();
 
 	unsigned long long nMaxIterations = std::max<unsigned long long>(1ULL, _nMaxMutations);
 
-	std::chrono::high_resolution_clock::time_point t1, t2;
-	if (vTimeLimit >= 0) {
-		t1 = std::chrono::high_resolution_clock::now();
-	}
-
 	unsigned nIteration = 0;
 	for (nIteration = 0; nIteration < nMaxIterations; ++nIteration)
 	{
 		MutatePopulationPool();
 
-		if (vTimeLimit >= 0)
+		if (deadline.expired())
 		{
-			t2 = std::chrono::high_resolution_clock::now();
-			auto elapsed_time = std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1).count();
-			// std::cout << "elapsed: " << elapsed_time << std::endl;
-			if (elapsed_time >= vTimeLimit)
-			{
-				break;
-			}
+			break;
 		}
 	}
 	std::cout << nIteration << std::endl;
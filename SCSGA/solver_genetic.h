@@ -17,6 +17,7 @@ class solver_genetic : public solver
 
 	std::vector<instance_solution> _PopulationPool; // Contains the current population pool.
 	instance_solution _BestSolution; // The best solution found so far.
+	uint64_t _nGeneratedSolutions = 0; // The initial and child solutions generated so far.
 
 	coalitional_values_generator* _pProblem = nullptr;
 public:
@@ -74,11 +74,12 @@ coalition::value_t solver_mcts::brute_force(const uint32_t current_agent)
 					coalitional_values,
 					agent_order,
 					generator,
-					timer,
+					deadline,
 					false,
 					25
 				);
 			}
+			report_incumbent(best_solution.get_value(), evaluated_solutions);
 		}
 		return temp_solution.get_value();
 	}
@@ -209,7 +210,7 @@ void solver_mcts::do_one_mcts_pass()
 		for (uint32_t simulation{ 0 }; simulation < SIMULATIONS_BEFORE_RESTART_AT_NEXT_DEPTH; ++simulation)
 		{
 			tree_policy(current_node, current_agent);
-			if (timer.countdown_reached()) break;
+			if (deadline.expired()) break;
 		}
 
 #ifdef MCTS_DEBUG
@@ -255,7 +256,8 @@ instance_solution solver_mcts::solve(coalitional_values_generator* _coalitional_
 		agent_order[i] = i;
 	}
 
-	timer.start_countdown(vTimeLimit);
+	const deadline_token::guard deadline_guard{ deadline, vTimeLimit };
+	report_incumbent(best_solution.get_value(), evaluated_solutions);
 
 	if (vTimeLimit < 0) {
 		do_one_mcts_pass();
@@ -272,7 +274,7 @@ instance_solution solver_mcts::solve(coalitional_values_generator* _coalitional_
 			do_one_mcts_pass();
 			++passes;
 			//std::cout << "One pass. " << " Best value is now: " << best_solution.value << std::endl;
-		} while (!timer.countdown_reached());
+		} while (!deadline.expired());
 		//std::cout << "Did " << passes << " passes." << std::endl;
 	}
 	//std::cout << "MCTS evaluated solutions: " << evaluated_solutions << std::endl;
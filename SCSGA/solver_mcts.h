@@ -98,9 +98,6 @@ private:
 	std::uniform_int_distribution<uint32_t> uniform_action_distribution;
 	std::default_random_engine generator;
 
-	// Timestamps.
-	utility::date_and_time::timer timer{};
-
 	void print_node(const uint32_t parent_node, const uint32_t child_task,
 		const uint32_t current_depth, const std::string arm);
 
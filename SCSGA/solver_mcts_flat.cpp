@@ -43,13 +43,6 @@ instance_solution solver_mcts_flat::do_one_mcts_pass(coalitional_values_generato
 	return solution;
 }
 
-inline bool solver_mcts_flat::time_limit_reached(const std::chrono::high_resolution_clock::time_point& start) const
-{
-	const std::chrono::high_resolution_clock::time_point current_time{ std::chrono::high_resolution_clock::now() };
-	const auto passed_time{ std::chrono::duration_cast<std::chrono::duration<double>>(current_time - start).count() };
-	return passed_time >= vTimeLimit;
-}
-
 instance_solution solver_mcts_flat::solve(coalitional_values_generator* coalitional_values)
 {
 	uniform_distribution = std::uniform_int_distribution<uint32_t>(0, coalitional_values->get_n_tasks() - 1);
@@ -60,22 +53,25 @@ instance_solution solver_mcts_flat::solve(coalitional_values_generator* coalitio
 
 	SPMCTSSelectionPolicy selection_policy{ coalitional_values->get_n_tasks(), exploration_weight, variance_weight, estimation_weight };
 	instance_solution best_solution;
+	const deadline_token::guard deadline_guard{ deadline, vTimeLimit };
 	if (vTimeLimit < 0) {
 		best_solution = do_one_mcts_pass(coalitional_values, SIMULATIONS_PER_ACTION_NO_TIME_LIMIT, selection_policy);
+		report_incumbent(best_solution.value, 1);
 	}
 	else
 	{
 		uint32_t passes{ 1 };
-		std::chrono::high_resolution_clock::time_point start_time{ std::chrono::high_resolution_clock::now() };
 		best_solution = do_one_mcts_pass(coalitional_values, coalitional_values->get_n_tasks() * SIMULATIONS_PER_ACTION_TIME_LIMIT, selection_policy);
-		while (!time_limit_reached(start_time))
+		report_incumbent(best_solution.value, passes);
+		while (!deadline.expired())
 		{
 			instance_solution current_solution{ do_one_mcts_pass(coalitional_values, coalitional_values->get_n_tasks() * SIMULATIONS_PER_ACTION_TIME_LIMIT, selection_policy) };
+			++passes;
 			if (current_solution.value > best_solution.value)
 			{
 				best_solution = current_solution;
+				report_incumbent(best_solution.value, passes);
 			}
-			++passes;
 		}
 		std::cout << "Did " << passes << " passes." << std::endl;
 	}
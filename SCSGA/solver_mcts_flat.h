@@ -27,7 +27,5 @@ public:
 		const uint32_t simulations_per_level,
 		SelectionPolicy& selection_policy);
 
-	inline bool time_limit_reached(const std::chrono::high_resolution_clock::time_point& start) const;
-
 	instance_solution solve(coalitional_values_generator* coalitional_values) override;
 };
@@ -2,7 +2,9 @@
 
 instance_solution solver_mp_AGI::solve(coalitional_values_generator* problem)
 {
+	const deadline_token::guard deadline_guard{ deadline, vTimeLimit };
 	auto initial_solution = solver_agent_greed().solve(problem);
 	MPAnytime::CAnytimeSearcher generator(problem, problem->get_n_agents(), problem->get_n_tasks(), problem->get_data());
-	return generator.FindOptimalCoalitionStructure(&initial_solution, bUseAGIForSubspaceLowerBounds, vTimeLimit);
+	generator.SetIncumbentCallback([this](const float vValue, const uint64_t nPoppedSubspaces) { report_incumbent(vValue, nPoppedSubspaces); });
+	return generator.FindOptimalCoalitionStructure(&initial_solution, bUseAGIForSubspaceLowerBounds, &deadline, _nThreads);
 }
\ No newline at end of file
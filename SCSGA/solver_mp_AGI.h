@@ -9,6 +9,7 @@ class solver_mp_AGI : public solver
 {
 public:
 	bool bUseAGIForSubspaceLowerBounds = true;
+	uint32_t _nThreads = 1; // Threads searching the subspaces, 0 for one per hardware thread.
 
 	instance_solution solve(coalitional_values_generator* problem) override;
 };
\ No newline at end of file
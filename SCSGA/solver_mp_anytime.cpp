@@ -73,7 +73,7 @@ namespace MPAnytime
 		coalitional_values_generator* problem,
 		const size_t nAgents,
 		const size_t nTasks,
-		const std::vector<std::vector<float>>& UtilityValues
+		const coalition_value_table& UtilityValues
 	)
 		: _pProblem(problem), _nAgents(nAgents), _nTasks(nTasks), _UtilityValues(UtilityValues) { }
 
@@ -82,16 +82,7 @@ namespace MPAnytime
 		if (!_bHasFoundSolution)
 			return false;
 
-		if (_vTimeLimit >= 0)
-		{
-			std::chrono::high_resolution_clock::time_point TimeNowPoint = std::chrono::high_resolution_clock::now();
-			auto vElapsedTime = std::chrono::duration_cast<std::chrono::duration<double>>(TimeNowPoint - _TimeStartPoint).count();
-			if (vElapsedTime >= _vTimeLimit)
-			{
-				return true;
-			}
-		}
-		return false;
+		return _pDeadline != nullptr && _pDeadline->expired();
 	}
 
 	inline bool CAnytimeSearcher::IsBetterThanCurrentBest(const float vValue) const
@@ -105,63 +96,45 @@ namespace MPAnytime
 		if (vValue - _vLowestBoundTolerance < _vMaximumLowestBound)
 			return false;
 
+		if (vValue + _vLowestBoundTolerance < _vMaximumSubspaceLowerBound)
+			return false;
+
 		return true;
 	}
 
-	void CAnytimeSearcher::CalculatePartitionData()
+	void CAnytimeSearcher::SetIncumbentCallback(std::function<void(const float, const uint64_t)> Callback)
 	{
-		const uint32_t nNumberOfPossibleCoalitions = (1 << _nAgents);
-
-		// --------------------------------------------------------------------
-		// Generate and compute coalition values for all possible coalitions.	
-		// --------------------------------------------------------------------
-
-		_CardinalValuesCount.assign(_nAgents + 1, 0u);
-		_CardinalValuesLowerBound.assign(_nAgents + 1, 0.0f);
-		_CardinalValuesUpperBound.assign(_nAgents + 1, std::numeric_limits<float>::lowest());
-
-		_TaskCardinalValuesLowerBound.assign(_nTasks, std::vector<float>(_nAgents + 1, 0.0f));
-		_TaskCardinalValuesUpperBound.assign(_nTasks, std::vector<float>(_nAgents + 1, std::numeric_limits<float>::lowest()));
-		_TaskCardinalValuesCount.assign(_nTasks, std::vector<uint32_t>(_nAgents + 1, 0u));
+		_IncumbentCallback = std::move(Callback);
+	}
 
-		for (uint32_t nCoalitionMask = 0; nCoalitionMask < nNumberOfPossibleCoalitions; ++nCoalitionMask)
+	void CAnytimeSearcher::ReportIncumbent(const float vValue) const
+	{
+		if (_IncumbentCallback)
 		{
-			// Compute starting bounds.
-			const uint32_t nCoalitionMembers = utility::bits::bit_count_32bit(nCoalitionMask);
-
-			float& CurrentCardinalValuesLowerBound = _CardinalValuesLowerBound[nCoalitionMembers];
-			float& CurrentCardinalValuesUpperBound = _CardinalValuesUpperBound[nCoalitionMembers];
-			uint32_t& CurrentCardinalValueCount = _CardinalValuesCount[nCoalitionMembers];
-
-			for (uint32_t nTaskIndex = 0; nTaskIndex < _nTasks; ++nTaskIndex)
-			{
-				const auto Value = _UtilityValues[nTaskIndex][nCoalitionMask];
-
-				float& CurrentTaskCardinalValuesUpperBound = _TaskCardinalValuesUpperBound[nTaskIndex][nCoalitionMembers];
-				float& CurrentTaskCardinalValuesLowerBound = _TaskCardinalValuesLowerBound[nTaskIndex][nCoalitionMembers];
-				uint32_t& CurrentTaskCardinalValuesCount = _TaskCardinalValuesCount[nTaskIndex][nCoalitionMembers];
-
-				// Update upper bound (max) for cardinal value.
-				if (Value > CurrentCardinalValuesUpperBound)
-					CurrentCardinalValuesUpperBound = Value;
-
-				// Update upper bound (max) for cardinal-task value.
-				if (Value > CurrentTaskCardinalValuesUpperBound)
-					CurrentTaskCardinalValuesUpperBound = Value;
+			_IncumbentCallback(vValue, _nPoppedSubspaces);
+		}
+	}
 
-				// Update lower bound (avg) for cardinal value.
-				CurrentCardinalValuesLowerBound = CurrentCardinalValuesLowerBound * CurrentCardinalValueCount + Value;
-				CurrentCardinalValuesLowerBound /= static_cast<float>(CurrentCardinalValueCount + 1.0f);
+	void CAnytimeSearcher::RaiseMaximumLowestBound(const float vValue)
+	{
+		float vMaximumLowestBound = _vMaximumLowestBound.load();
+		while (vValue > vMaximumLowestBound && !_vMaximumLowestBound.compare_exchange_weak(vMaximumLowestBound, vValue))
+		{
+		}
+	}
 
-				// Update lower bound (avg) for cardinal-task value;
-				CurrentTaskCardinalValuesLowerBound = CurrentTaskCardinalValuesLowerBound * CurrentTaskCardinalValuesCount + Value;
-				CurrentTaskCardinalValuesLowerBound /= static_cast<float>(CurrentTaskCardinalValuesCount + 1.0f);
+	void CAnytimeSearcher::CalculatePartitionData()
+	{
+		// --------------------------------------------------------------------
+		// Bounds of each coalition size, shared with other solvers of the problem.
+		// --------------------------------------------------------------------
 
-				// Update counts.
-				++CurrentCardinalValueCount;
-				++CurrentTaskCardinalValuesCount;
-			}
-		}
+		// The maximum bounds the value of a coalition from above and the mean is the expected value of a random one.
+		const value_statistics_t& Statistics = _pProblem->get_value_statistics(_nThreads);
+		_CardinalValuesUpperBound = Statistics.max_value_of_size_any_task;
+		_CardinalValuesLowerBound = Statistics.mean_value_of_size_any_task;
+		_TaskCardinalValuesUpperBound = Statistics.max_value_of_size;
+		_TaskCardinalValuesLowerBound = Statistics.mean_value_of_size;
 
 		// -------------------------------------------------------
 		// Compute partition lower and upper bounds.
@@ -177,10 +150,6 @@ namespace MPAnytime
 				_PartitionsLowerBound[i] += _CardinalValuesLowerBound[nCardinality];
 				_PartitionsUpperBound[i] += _CardinalValuesUpperBound[nCardinality];
 			}
-			if (_PartitionsLowerBound[i] > _vMaximumLowestBound)
-			{
-				_vMaximumLowestBound = _PartitionsLowerBound[i];
-			}
 		}
 	}
 
@@ -191,18 +160,23 @@ namespace MPAnytime
 
 	void CAnytimeSearcher::InitializePartitionSearch()
 	{
-		_CurrentSolution.reset(_nTasks, _nAgents);
-		_PSPartitionToTaskIndex.resize(_nTasks);
-		_PSCurrentPartition.reserve(_nTasks);
+		_SearchStates.resize(utility::parallel::get_n_threads(_nThreads));
+		for (SPartitionSearchState& State : _SearchStates)
+		{
+			State._CurrentSolution.reset(_nTasks, _nAgents);
+			State._PSPartitionToTaskIndex.resize(_nTasks);
+			State._PSCurrentPartition.reserve(_nTasks);
+		}
 	}
 
 	void CAnytimeSearcher::StartPartitionSearch
 	(
+		SPartitionSearchState& State,
 		const std::vector<uint32_t>& CurrentPartition
 	)
 	{
-		_PSOriginalPartition = CurrentPartition;
-		_PSCurrentPartition.clear();
+		State._PSOriginalPartition = CurrentPartition;
+		State._PSCurrentPartition.clear();
 		float vStartValue = 0, vUpperBound = 0;
 
 		// Evaluate all tasks that have 0 members, and only keep non-zero coalitions.
@@ -214,23 +188,24 @@ namespace MPAnytime
 			if (nCoalitionSize != 0)
 			{
 				vUpperBound += _TaskCardinalValuesUpperBound[nIndex][nCoalitionSize];
-				_PSPartitionToTaskIndex[nSkewedIndex++] = nIndex;
-				_PSCurrentPartition.push_back(nCoalitionSize);
+				State._PSPartitionToTaskIndex[nSkewedIndex++] = nIndex;
+				State._PSCurrentPartition.push_back(nCoalitionSize);
 			}
 			else
 			{
-				vStartValue += _UtilityValues[nIndex][0];
+				vStartValue += _UtilityValues.get_value_of(0, nIndex);
 			}
 		}
 
 		if (!IsBetterThanCurrentBest(vUpperBound + vStartValue))
 			return;
 
-		__SearchPartition(vUpperBound, vStartValue);
+		__SearchPartition(State, vUpperBound, vStartValue);
 	}
 
 	void CAnytimeSearcher::__SearchPartition
 	(
+		SPartitionSearchState& State,
 		const float UpperBoundRemaining, // The highest value we can achieve from the coalitions that are not filled yet.
 		const float CurrentValue, // The value we have got from the coalitions that have already been filled.
 		const uint32_t nAgentIndex
@@ -240,37 +215,42 @@ namespace MPAnytime
 		{
 			if (IsBetterThanCurrentBest(CurrentValue))
 			{
-				_bHasFoundSolution = true;
-				_vBestSolutionValue = CurrentValue;
-				_BestSolution = _CurrentSolution; // Copy new result.
-				_vMaximumLowestBound = _vBestSolutionValue;
+				std::lock_guard<std::mutex> Lock(_BestSolutionMutex);
+				if (IsBetterThanCurrentBest(CurrentValue)) // Another thread may have found a better solution meanwhile.
+				{
+					_BestSolution = State._CurrentSolution; // Copy new result.
+					_vBestSolutionValue = CurrentValue;
+					_bHasFoundSolution = true;
+					RaiseMaximumLowestBound(CurrentValue);
+					ReportIncumbent(CurrentValue);
+				}
 			}
 
 			return;
 		}
 
 		// Attempt to add this agent to every task and evaluate the value it'd give.
-		for (uint32_t nSkewedTaskIndex = 0; nSkewedTaskIndex < _PSCurrentPartition.size(); ++nSkewedTaskIndex)
+		for (uint32_t nSkewedTaskIndex = 0; nSkewedTaskIndex < State._PSCurrentPartition.size(); ++nSkewedTaskIndex)
 		{
 			if (HasTimeElapsed())
 			{
 				return;
 			}
 
-			auto& nCoalitionSize = _PSCurrentPartition[nSkewedTaskIndex]; // The number of "empty" spots left in this coalition.
+			auto& nCoalitionSize = State._PSCurrentPartition[nSkewedTaskIndex]; // The number of "empty" spots left in this coalition.
 			if (nCoalitionSize == 0)
 			{
 				continue; // Already full coalition.
 			}
 
-			const int nTaskIndex = _PSPartitionToTaskIndex[nSkewedTaskIndex];
+			const int nTaskIndex = State._PSPartitionToTaskIndex[nSkewedTaskIndex];
 
 			// In order for us to calculate the value very quickly, we can simply use the mask of this coalition
 			// to retrieve its value from the pre-calculated table.
 
 			// Remove one spot from this partition, and add the agent to the coalition mask.
 			--nCoalitionSize;
-			_CurrentSolution.add_agent_to_coalition(nAgentIndex, nTaskIndex);
+			State._CurrentSolution.add_agent_to_coalition(nAgentIndex, nTaskIndex);
 
 			// Calculate what value we get from adding this agent this way.
 			float vValue = CurrentValue;
@@ -279,62 +259,91 @@ namespace MPAnytime
 			if (nCoalitionSize == 0)
 			{
 				// If the coalition is now full, we retrieve its value by using its mask.
-				vValue += _pProblem->get_value_of(_CurrentSolution.get_coalition(nTaskIndex), nTaskIndex);
+				vValue += _pProblem->get_value_of(State._CurrentSolution.get_coalition(nTaskIndex), nTaskIndex);
 
 				// Also update upper bound, so we can cancel searches that are unneccessary.
-				const int nSizeOfOriginalPartition = _PSOriginalPartition[nTaskIndex];
+				const int nSizeOfOriginalPartition = State._PSOriginalPartition[nTaskIndex];
 				vNewUpperBoundRemaining -= _TaskCardinalValuesUpperBound[nTaskIndex][nSizeOfOriginalPartition];
 			}
 
 			// Add next agent if this assignment can lead to an optimal solution.
 			if (IsBetterThanCurrentBest(vNewUpperBoundRemaining + vValue))
 			{
-				__SearchPartition(vNewUpperBoundRemaining, vValue, nAgentIndex + 1);
+				__SearchPartition(State, vNewUpperBoundRemaining, vValue, nAgentIndex + 1);
 			}
 
 			// Reset state back to what it was.
-			_CurrentSolution.remove_agent_from_coalition(nAgentIndex, nTaskIndex);
+			State._CurrentSolution.remove_agent_from_coalition(nAgentIndex, nTaskIndex);
 			++nCoalitionSize;
 		}
 
 		return;
 	}
 
-	void CAnytimeSearcher::SearchCurrentPermutations()
+	bool CAnytimeSearcher::PopPermutation(solver_agent_greed* pGreedySolver, std::vector<uint32_t>& Permutation, float& vUpperBound)
 	{
-		std::sort(PermutationOrder.begin(), PermutationOrder.end(), [&](const uint32_t lhs, const uint32_t rhs)
+		float vLowerBound;
+		while (true)
+		{
 			{
-				if (std::abs(Permutations[lhs]._vUpperBound - Permutations[rhs]._vUpperBound) < _vOptimalityTolerance)
+				std::lock_guard<std::mutex> Lock(_SubspacesMutex);
+				const bool bPopped = !HasTimeElapsed() && _Subspaces.pop([&](const float vBound) { return IsBetterThanCurrentBest(vBound); }, Permutation, vUpperBound, vLowerBound);
+				// Subspaces that are still waiting are searched unless a better solution prunes them, so their lower bounds
+				// hold. The popped one is not counted, so that its own lower bound never prunes it.
+				_vMaximumSubspaceLowerBound = _Subspaces.get_max_waiting_lower_bound();
+				if (!bPopped)
 				{
-					return Permutations[lhs]._vLowerBound > Permutations[rhs]._vLowerBound;
+					return false;
 				}
-				return Permutations[lhs]._vUpperBound > Permutations[rhs]._vUpperBound;
-			});
+				++_nPoppedSubspaces;
+			}
 
-		for (const uint32_t PermutationIndex : PermutationOrder)
-		{
-			if (HasTimeElapsed())
+			// The greedy solve runs without holding _SubspacesMutex, so that the other threads keep popping meanwhile.
+			if (pGreedySolver != nullptr)
 			{
-				return;
+				auto GreedySolution = pGreedySolver->solve(_pProblem, &Permutation);
+				std::lock_guard<std::mutex> BestLock(_BestSolutionMutex);
+				if (IsBetterThanCurrentBest(GreedySolution.value))
+				{
+					_BestSolution = GreedySolution;
+					_vBestSolutionValue = GreedySolution.value;
+					RaiseMaximumLowestBound(GreedySolution.value);
+					ReportIncumbent(GreedySolution.value);
+				}
 			}
 
-			if (IsBetterThanCurrentBest(Permutations[PermutationIndex]._vUpperBound))
+			if (IsBetterThanCurrentBest(vUpperBound))
 			{
-				StartPartitionSearch(Permutations[PermutationIndex]._Permutation);
+				return true;
 			}
-			else
+		}
+	}
+
+	void CAnytimeSearcher::SearchPermutations(solver_agent_greed* pGreedySolver)
+	{
+		// Greedy solves change the state of the solver, so every thread solves with its own copy.
+		std::vector<solver_agent_greed> GreedySolvers(pGreedySolver != nullptr ? _SearchStates.size() : 0u, pGreedySolver != nullptr ? *pGreedySolver : solver_agent_greed());
+
+		// Every thread pops the next best permutation when it is done with its last one. Permutations are generated
+		// on demand, so those that the best solution found by then prunes are never generated at all.
+		utility::parallel::for_each_index_of_worker(_SearchStates.size(), uint32_t(_SearchStates.size()), [&](const uint64_t, const uint32_t nWorker)
+		{
+			solver_agent_greed* pWorkerGreedySolver = GreedySolvers.empty() ? nullptr : &GreedySolvers[nWorker];
+			std::vector<uint32_t> Permutation;
+			float vUpperBound;
+			while (PopPermutation(pWorkerGreedySolver, Permutation, vUpperBound))
 			{
-				break; // We can discard the rest (since the search queue is sorted on upper bound first).
+				StartPartitionSearch(_SearchStates[nWorker], Permutation);
 			}
-		}
+		});
 	}
 
 	instance_solution CAnytimeSearcher::FindOptimalCoalitionStructure
 	(
 		const instance_solution* pInitialSolution,
 		const bool bTryUseAGIAsLowerBound,
-		const float vTimeLimit,
-		const uint32_t nPermutationsPerBlock
+		const deadline_token* pDeadline,
+		const uint32_t nThreads
 	)
 	{
 		instance_solution Result; // Result.
@@ -357,8 +366,9 @@ namespace MPAnytime
 			}
 		}
 
-		_TimeStartPoint = std::chrono::high_resolution_clock::now();
-		_vTimeLimit = vTimeLimit;
+		_pDeadline = pDeadline;
+		_nThreads = nThreads;
+		_nPoppedSubspaces = 0;
 
 		// ----------------------------------------------------------------------------
 		// Find an initial solution to use as baseline.
@@ -377,6 +387,7 @@ namespace MPAnytime
 			_bHasFoundSolution = true;
 			_vBestSolutionValue = pInitialSolution->value;
 			_BestSolution = *pInitialSolution;
+			ReportIncumbent(pInitialSolution->value);
 		}
 
 		// ----------------------------------------------------------------------------
@@ -404,115 +415,19 @@ namespace MPAnytime
 				{
 					_BestSolution = GreedySolution;
 					_vBestSolutionValue = GreedySolution.value;
-					_vMaximumLowestBound = _vBestSolutionValue;
+					_vMaximumLowestBound = GreedySolution.value;
+					ReportIncumbent(GreedySolution.value);
 				}
 			}
 		}
 
-		// ----------------------------------------------------------------------------
-		// Decide on the order for which we expand partitions.
-		// ----------------------------------------------------------------------------
-
-		std::vector<uint32_t> ExpansionOrder;
-		ExpansionOrder.reserve(_Partitions.size());
-		for (uint32_t nPartitionIndex = 0; nPartitionIndex < _Partitions.size(); ++nPartitionIndex)
-		{
-			if (IsBetterThanCurrentBest(_PartitionsUpperBound[nPartitionIndex]))
-			{
-				ExpansionOrder.push_back(nPartitionIndex);
-			}
-		}
-
-		// ----------------------------------------------------------------------------
-		// Decide on ExpansionOrderFunction.
-		// ----------------------------------------------------------------------------
-
-		const auto ExpansionOrderFunction = [&](const uint32_t lhs, const uint32_t rhs)
-		{
-			if (std::abs(_PartitionsUpperBound[lhs] - _PartitionsUpperBound[rhs]) < _vOptimalityTolerance)
-				return _PartitionsLowerBound[lhs] > _PartitionsLowerBound[rhs];
-			return _PartitionsUpperBound[lhs] > _PartitionsUpperBound[rhs];
-		};
-
-		std::sort(ExpansionOrder.begin(), ExpansionOrder.end(), ExpansionOrderFunction);
-
-		// ----------------------------------------------------------------------------
-		// Initialize search.
-		// ----------------------------------------------------------------------------
-
-		InitializePartitionSearch(); // Initialize search.
-
-		PermutationOrder.clear();
-		Permutations.clear();
-
-		PermutationOrder.reserve(nPermutationsPerBlock);
-		Permutations.reserve(nPermutationsPerBlock);
-
 		// ----------------------------------------------------------------------------
 		// Start search (branch-and-bound).
 		// ----------------------------------------------------------------------------
-		for (uint32_t i = 0; i < ExpansionOrder.size() && !HasTimeElapsed(); ++i)
-		{
-			const int nPartitionIndex = ExpansionOrder[i];
-			auto& CurrentPartition = _Partitions[nPartitionIndex];
-			const auto vSubspaceUpperBound = _PartitionsUpperBound[nPartitionIndex];
-
-			if (!IsBetterThanCurrentBest(vSubspaceUpperBound))
-			{
-				break;
-			}
-
-			// Non-increasing order for next_permutation.
-			std::sort(CurrentPartition.begin(), CurrentPartition.end());
-
-			do
-			{
-				// Calculate a tighter (better) upper bound.
-				float vPermutationUpperBound = 0.0f, vPermutationLowerBound = 0.0f;
-				for (uint32_t nTaskIndex = 0; nTaskIndex < CurrentPartition.size(); ++nTaskIndex)
-				{
-					const uint32_t P = CurrentPartition[nTaskIndex];
-					vPermutationLowerBound += _TaskCardinalValuesLowerBound[nTaskIndex][P];
-					vPermutationUpperBound += _TaskCardinalValuesUpperBound[nTaskIndex][P];
-				}
-
-				// Update maximum lowest bound if possible.
-				if (vPermutationLowerBound > _vMaximumLowestBound)
-				{
-					_vMaximumLowestBound = vPermutationLowerBound;
-				}
-
-				if (IsBetterThanCurrentBest(vPermutationUpperBound))
-				{
-					if (bTryUseAGIAsLowerBound)
-					{
-						auto GreedySolution = GreedySolver.solve(_pProblem, &CurrentPartition);
-						if (IsBetterThanCurrentBest(GreedySolution.value))
-						{
-							_BestSolution = GreedySolution;
-							_vBestSolutionValue = GreedySolution.value;
-							_vMaximumLowestBound = _vBestSolutionValue;
-						}
-					}
-
-					// Add permutation to search queue.
-					PermutationOrder.push_back(uint32_t(PermutationOrder.size()));
-					Permutations.emplace_back(CurrentPartition, vPermutationLowerBound, vPermutationUpperBound);
-
-					if (Permutations.size() >= nPermutationsPerBlock)
-					{
-						SearchCurrentPermutations();
-						Permutations.clear();
-						PermutationOrder.clear();
-					}
-				}
-			} while (std::next_permutation(CurrentPartition.begin(), CurrentPartition.end()) && !HasTimeElapsed());
-		}
 
-		if (Permutations.size() > 0 && !HasTimeElapsed())
-		{
-			SearchCurrentPermutations();
-		}
+		_Subspaces.reset(_Partitions, _PartitionsUpperBound, _TaskCardinalValuesUpperBound, _TaskCardinalValuesLowerBound);
+		InitializePartitionSearch(); // Initialize search.
+		SearchPermutations(bTryUseAGIAsLowerBound ? &GreedySolver : nullptr);
 
 		// ----------------------------------------------------------------------------
 		// Construct best solution.
@@ -529,8 +444,10 @@ namespace MPAnytime
 
 instance_solution solver_mp_anytime::solve(coalitional_values_generator* problem, const instance_solution* initial_solution)
 {
+	const deadline_token::guard deadline_guard{ deadline, vTimeLimit };
 	MPAnytime::CAnytimeSearcher generator(problem, problem->get_n_agents(), problem->get_n_tasks(), problem->get_data());
-	return generator.FindOptimalCoalitionStructure(initial_solution, false, vTimeLimit);
+	generator.SetIncumbentCallback([this](const float vValue, const uint64_t nPoppedSubspaces) { report_incumbent(vValue, nPoppedSubspaces); });
+	return generator.FindOptimalCoalitionStructure(initial_solution, false, &deadline, _nThreads);
 }
 
 instance_solution solver_mp_anytime::solve(coalitional_values_generator* problem)
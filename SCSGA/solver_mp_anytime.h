@@ -2,7 +2,9 @@
 #include "solver.h"
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
+#include <mutex>
 #include <vector>
 #include <chrono>
 #include <limits>
@@ -13,6 +15,7 @@
 #include "solver_agent_greed.h"
 #include "solver_task_greed.h"
 
+#include "subspace_queue.h"
 #include "utility.h"
 
 // #define NDEBUG // If this is defined, all assert-code is prevented from running (is not needed when runnig in VS via Release).
@@ -63,15 +66,13 @@ namespace MPAnytime
 		std::vector<float> _PartitionsLowerBound; // Partition lower bound.
 		std::vector<float> _PartitionsUpperBound; // Partition upper bound.
 
-		const std::vector<std::vector<float>>& _UtilityValues; // Utility values for all coalitions assigned to tasks.
+		const coalition_value_table& _UtilityValues; // Utility values for all coalitions assigned to tasks.
 
 		std::vector<float> _CardinalValuesUpperBound; // Mask upper bound.
 		std::vector<float> _CardinalValuesLowerBound; // Mask lower bound.
-		std::vector<uint32_t> _CardinalValuesCount;	  // The number of values for a specific agent count (bitcount in mask).
 
 		std::vector<std::vector<float>> _TaskCardinalValuesUpperBound;	// Mask to task upper bound.
 		std::vector<std::vector<float>> _TaskCardinalValuesLowerBound;	// Mask to task lower bound.
-		std::vector<std::vector<uint32_t>> _TaskCardinalValuesCount;	// The number of values for a specific agent count of a task (bitcount in mask).
 
 		const size_t _nAgents;
 		const size_t _nTasks;
@@ -80,9 +81,13 @@ namespace MPAnytime
 		const float _vLowestBoundTolerance = 0.001f;	// Must be a number larger than 0.0f.
 		const float _vOptimalityTolerance = 0.001f;		// A large tolerance makes it possible to cut branches earlier, but might miss optimal solution.
 		
-		float _vTimeLimit = -1.0f;
+		const deadline_token* _pDeadline = nullptr;
 
-		std::chrono::high_resolution_clock::time_point _TimeStartPoint;
+		std::function<void(const float, const uint64_t)> _IncumbentCallback;
+		std::atomic<uint64_t> _nPoppedSubspaces{ 0 }; // Since the search started.
+
+		// Must be called while holding _BestSolutionMutex, or before the threads start, so that the callback is never run concurrently.
+		void ReportIncumbent(const float vValue) const;
 
 	public:
 		// Searcher constructor.
@@ -91,9 +96,12 @@ namespace MPAnytime
 			coalitional_values_generator* problem,
 			const size_t nAgents,
 			const size_t nTasks,
-			const std::vector<std::vector<float>>& UtilityValues
+			const coalition_value_table& UtilityValues
 		);
 
+		// Callback is called with the value of every new best solution and the number of subspaces popped by then.
+		void SetIncumbentCallback(std::function<void(const float, const uint64_t)> Callback);
+
 		struct SPartitionSearchResult
 		{
 			std::vector<uint32_t> _CollaborationStructure;
@@ -127,22 +135,39 @@ namespace MPAnytime
 		// ------------------------------------------------------------------------------
 		// ------------------------------------------------------------------------------
 
+		// The best solution and the bounds are shared by the threads searching permutations. The values
+		// only increase, except for _vMaximumSubspaceLowerBound, and _BestSolution is only changed while holding _BestSolutionMutex.
 		instance_solution _BestSolution; // Represents the best solution found so far. 
-		bool _bHasFoundSolution = false; // Is true if we have found a solution.
-		float _vBestSolutionValue = std::numeric_limits<float>::lowest(); // The value of the best solution found so far.
-		float _vMaximumLowestBound = std::numeric_limits<float>::lowest(); // The maximum lower bound for all solutions.
+		std::mutex _BestSolutionMutex;
+		std::atomic<bool> _bHasFoundSolution{ false }; // Is true if we have found a solution.
+		std::atomic<float> _vBestSolutionValue{ std::numeric_limits<float>::lowest() }; // The value of the best solution found so far.
+		std::atomic<float> _vMaximumLowestBound{ std::numeric_limits<float>::lowest() }; // The largest value reached by a solution.
+		// The largest lower bound, from the mean values, of a subspace still waiting in _Subspaces, which is set after
+		// every pop and may thus decrease. No solution may reach it yet, so it only prunes bounds below it by more than
+		// the tolerance, which never prunes the best solution of the subspace itself.
+		std::atomic<float> _vMaximumSubspaceLowerBound{ std::numeric_limits<float>::lowest() };
+
+		void RaiseMaximumLowestBound(const float vValue);
+
+		// The state of a search of a single permutation. Every thread has its own.
+		struct SPartitionSearchState
+		{
+			instance_solution _CurrentSolution; // Represents an intermediary solution (is constructed while searching).
 
-		instance_solution _CurrentSolution; // Represents an intermediary solution (is constructed while searching).
+			std::vector<uint32_t> _PSOriginalPartition; // Contains the original data for the current partition's permutation.
+			std::vector<uint32_t> _PSCurrentPartition;// Contains the temporary intermediary data for the original current partition's permutation.
+			std::vector<uint32_t> _PSPartitionToTaskIndex; // Order can be wrong due to removing zeroes; this vector maps back to correct values.
+		};
 
-		std::vector<uint32_t> _PSOriginalPartition; // Contains the original data for the current partition's permutation.
-		std::vector<uint32_t> _PSCurrentPartition;// Contains the temporary intermediary data for the original current partition's permutation.
-		std::vector<uint32_t> _PSPartitionToTaskIndex; // Order can be wrong due to removing zeroes; this vector maps back to correct values.
+		uint32_t _nThreads = 1; // Threads searching the permutations.
+		std::vector<SPartitionSearchState> _SearchStates;
 
 		// Must be called before first time StartPartitionSearch is called.
 		void InitializePartitionSearch();
 
 		void StartPartitionSearch
 		(
+			SPartitionSearchState& State,
 			const std::vector<uint32_t>& CurrentPartition
 		);
 
@@ -152,6 +177,7 @@ namespace MPAnytime
 		// Do _NOT_ call this function explicitly, call this implicitly via StartPartitionSearch instead.
 		void __SearchPartition
 		(
+			SPartitionSearchState& State,
 			const float UpperBoundRemaining, // The highest value we can achieve from the coalitions that are not filled yet.
 			const float CurrentValue, // The value we have got from the coalitions that have already been filled.
 			const uint32_t nAgentIndex = 0
@@ -163,19 +189,15 @@ namespace MPAnytime
 		// ------------------------------------------------------------------------------
 		// ------------------------------------------------------------------------------
 
-		struct SPartitionPermutation
-		{
-			std::vector<uint32_t> _Permutation;
-			const float _vLowerBound = std::numeric_limits<float>::lowest(), _vUpperBound = std::numeric_limits<float>::max();
-			SPartitionPermutation(const std::vector<uint32_t>& Permutation, const float vLowerBound, const float vUpperBound)
-				: _Permutation(Permutation), _vLowerBound(vLowerBound), _vUpperBound(vUpperBound)
-			{}
-		};
+		subspace_queue _Subspaces; // The permutations left to search, generated best first by upper bound.
+		std::mutex _SubspacesMutex;
 
-		std::vector<SPartitionPermutation> Permutations;
-		std::vector<uint32_t> PermutationOrder, SortedPermutationOrder;
+		// Pops the next permutation worth searching. If pGreedySolver is set, its solution of every popped permutation is
+		// used in an attempt to improve the best solution first, without holding _SubspacesMutex, so it must be the thread's own.
+		bool PopPermutation(solver_agent_greed* pGreedySolver, std::vector<uint32_t>& Permutation, float& vUpperBound);
 
-		void SearchCurrentPermutations();
+		// Searches the permutations in upper bound order, on _nThreads threads that prune against the shared best solution.
+		void SearchPermutations(solver_agent_greed* pGreedySolver);
 
 	public:
 
@@ -194,13 +216,13 @@ namespace MPAnytime
 			// that is used in an attempt to improve that subspace's lower bound.
 			const bool bTryUseAGIAsLowerBound = false,
 
-			// If this is > 0.0f, a time limit is used to interrupt the algorithm's
-			// search procedure.
-			const float vTimeLimit = -1.0f,
+			// If this is set, the search is interrupted once it expires, as soon as a solution is found.
+			const deadline_token* pDeadline = nullptr,
 
-			// Number of permutations that are stored per block.
-			// Increasing this number => increases performancd and memory usage.
-			const uint32_t nPermutationsPerBlock = 100000u
+			// Number of threads that search the permutations, 0 for one per hardware thread.
+			// Threads may search the permutations in a slightly different order, so the value of the solution
+			// is only the same as with a single thread up to the pruning tolerances.
+			const uint32_t nThreads = 1u
 		);
 	};
 }
@@ -208,6 +230,7 @@ namespace MPAnytime
 class solver_mp_anytime : public solver
 {
 public:
+	uint32_t _nThreads = 1; // Threads searching the subspaces, 0 for one per hardware thread.
 
 	instance_solution solve(coalitional_values_generator* problem, const instance_solution* initial_solution);
 	instance_solution solve(coalitional_values_generator* problem) override;
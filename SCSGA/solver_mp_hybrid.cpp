@@ -69,6 +69,112 @@ namespace MPHybrid
 		}
 	}
 
+	// ------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------
+	// Memoization table.
+	// ------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------
+
+	void CMemoizationTable::StartEpoch()
+	{
+		if (++_nEpoch == EXACT_EPOCH)
+		{
+			Clear(); // The epochs wrapped around, so old results could look current.
+		}
+	}
+
+	void CMemoizationTable::Clear()
+	{
+		_Slots.assign(MINIMUM_CAPACITY, SSlot());
+		_nOccupiedSlots = 0;
+		_nEpoch = EXACT_EPOCH + 1;
+	}
+
+	inline bool CMemoizationTable::IsLive(const SSlot& Slot) const
+	{
+		return Slot._nEpoch == EXACT_EPOCH || Slot._nEpoch == _nEpoch;
+	}
+
+	inline size_t CMemoizationTable::FindSlot(const uint64_t nKey) const
+	{
+		const size_t nMask = _Slots.size() - 1;
+		size_t nSlot = size_t(utility::random::splitmix64(nKey)) & nMask;
+		while (_Slots[nSlot]._nKey != nKey && _Slots[nSlot]._nKey != EMPTY_KEY)
+		{
+			nSlot = (nSlot + 1) & nMask;
+		}
+		return nSlot;
+	}
+
+	inline const SMemoizationEntry* CMemoizationTable::Find(const uint64_t nKey, bool& bExact, bool& bShared) const
+	{
+		if (_Slots.empty())
+		{
+			return nullptr;
+		}
+		const SSlot& Slot = _Slots[FindSlot(nKey)];
+		if (Slot._nKey != nKey || !IsLive(Slot))
+		{
+			return nullptr;
+		}
+		bExact = Slot._nEpoch == EXACT_EPOCH;
+		bShared = Slot._nCreationEpoch != _nEpoch;
+		return &Slot._Entry;
+	}
+
+	void CMemoizationTable::Insert(const uint64_t nKey, const SMemoizationEntry& Entry, const bool bExact)
+	{
+		if (_Slots.empty())
+		{
+			Clear();
+		}
+		SSlot& Slot = _Slots[FindSlot(nKey)];
+		if (Slot._nKey == EMPTY_KEY)
+		{
+			++_nOccupiedSlots;
+		}
+		Slot._nKey = nKey;
+		Slot._Entry = Entry;
+		Slot._nEpoch = bExact ? EXACT_EPOCH : _nEpoch;
+		Slot._nCreationEpoch = _nEpoch;
+
+		if (2 * _nOccupiedSlots > _Slots.size())
+		{
+			// Drop the results of earlier epochs, and grow if the live results still fill a quarter of the table.
+			size_t nLiveSlots = 0;
+			for (const SSlot& OtherSlot : _Slots)
+			{
+				nLiveSlots += OtherSlot._nKey != EMPTY_KEY && IsLive(OtherSlot);
+			}
+			size_t nCapacity = MINIMUM_CAPACITY;
+			while (nCapacity < 4 * nLiveSlots)
+			{
+				nCapacity *= 2;
+			}
+			Rehash(nCapacity);
+		}
+	}
+
+	void CMemoizationTable::Rehash(const size_t nCapacity)
+	{
+		std::vector<SSlot> OldSlots(nCapacity);
+		std::swap(OldSlots, _Slots);
+		_nOccupiedSlots = 0;
+		for (const SSlot& Slot : OldSlots)
+		{
+			if (Slot._nKey != EMPTY_KEY && IsLive(Slot))
+			{
+				_Slots[FindSlot(Slot._nKey)] = Slot;
+				++_nOccupiedSlots;
+			}
+		}
+	}
+
+	size_t CMemoizationTable::GetMemoryUsage() const
+	{
+		return _Slots.size() * sizeof(SSlot);
+	}
+
 	// ------------------------------------------------------------------------------
 	// ------------------------------------------------------------------------------
 	// Coalition formation generator.
@@ -80,7 +186,7 @@ namespace MPHybrid
 		coalitional_values_generator* problem,
 		const size_t nAgents,
 		const size_t nTasks,
-		const std::vector<std::vector<float>>& UtilityValues
+		const coalition_value_table& UtilityValues
 	)
 		: _pProblem(problem), _nAgents(nAgents), _nTasks(nTasks), _UtilityValues(UtilityValues) { }
 
@@ -89,16 +195,7 @@ namespace MPHybrid
 		if (!_bHasFoundSolution)
 			return false;
 
-		if (_vTimeLimit >= 0)
-		{
-			std::chrono::high_resolution_clock::time_point TimeNowPoint = std::chrono::high_resolution_clock::now();
-			auto vElapsedTime = std::chrono::duration_cast<std::chrono::duration<double>>(TimeNowPoint - _TimeStartPoint).count();
-			if (vElapsedTime >= _vTimeLimit)
-			{
-				return true;
-			}
-		}
-		return false;
+		return _pDeadline != nullptr && _pDeadline->expired();
 	}
 
 	inline bool CHybridSearcher::IsBetterThanCurrentBest(const float vValue, const bool bCheckMaximumLowestBound) const
@@ -112,9 +209,33 @@ namespace MPHybrid
 		if (bCheckMaximumLowestBound && vValue - _vLowestBoundTolerance < _vMaximumLowestBound)
 			return false;
 
+		if (bCheckMaximumLowestBound && vValue + _vLowestBoundTolerance < _vMaximumSubspaceLowerBound)
+			return false;
+
 		return true;
 	}
 
+	void CHybridSearcher::SetIncumbentCallback(std::function<void(const float, const uint64_t)> Callback)
+	{
+		_IncumbentCallback = std::move(Callback);
+	}
+
+	void CHybridSearcher::ReportIncumbent(const float vValue) const
+	{
+		if (_IncumbentCallback)
+		{
+			_IncumbentCallback(vValue, _nPoppedSubspaces);
+		}
+	}
+
+	void CHybridSearcher::RaiseMaximumLowestBound(const float vValue)
+	{
+		float vMaximumLowestBound = _vMaximumLowestBound.load();
+		while (vValue > vMaximumLowestBound && !_vMaximumLowestBound.compare_exchange_weak(vMaximumLowestBound, vValue))
+		{
+		}
+	}
+
 		// ------------------------------------------------------------------------------
 		// ------------------------------------------------------------------------------
 		// Partition data calculator.
@@ -123,62 +244,16 @@ namespace MPHybrid
 
 	void CHybridSearcher::CalculatePartitionData()
 	{
-		const uint32_t nNumberOfPossibleCoalitions = (1 << _nAgents);
-
 		// --------------------------------------------------------------------
-		// Generate and calculate coalition values for all possible coalitions.	
+		// Bounds of each coalition size, shared with other solvers of the problem.
 		// --------------------------------------------------------------------
 
-		_CardinalValuesCount.assign(_nAgents + 1, 0u);
-		_CardinalValuesLowerBound.assign(_nAgents + 1, 0.0f);
-		_CardinalValuesUpperBound.assign(_nAgents + 1, std::numeric_limits<float>::lowest());
-
-		_TaskCardinalValuesLowerBound.assign(_nTasks, std::vector<float>(_nAgents + 1, 0.0f));
-		_TaskCardinalValuesUpperBound.assign(_nTasks, std::vector<float>(_nAgents + 1, std::numeric_limits<float>::lowest()));
-		_TaskCardinalValuesCount.assign(_nTasks, std::vector<uint32_t>(_nAgents + 1, 0u));
-
-		_CoalitionsOfSize.assign(_nAgents + 1, std::vector<uint32_t>());
-
-		for (uint32_t nCoalitionMask = 0u; nCoalitionMask < nNumberOfPossibleCoalitions; ++nCoalitionMask)
-		{
-			// Calculate starting bounds.
-			const uint32_t nCoalitionMembers = utility::bits::bit_count_32bit(nCoalitionMask);
-
-			_CoalitionsOfSize[nCoalitionMembers].push_back(nCoalitionMask);
-
-			float& CurrentCardinalValuesLowerBound = _CardinalValuesLowerBound[nCoalitionMembers];
-			float& CurrentCardinalValuesUpperBound = _CardinalValuesUpperBound[nCoalitionMembers];
-			uint32_t& CurrentCardinalValueCount = _CardinalValuesCount[nCoalitionMembers];
-
-			for (uint32_t nTaskIndex = 0; nTaskIndex < _nTasks; ++nTaskIndex)
-			{
-				const auto Value = _UtilityValues[nTaskIndex][nCoalitionMask];
-
-				float& CurrentTaskCardinalValuesUpperBound = _TaskCardinalValuesUpperBound[nTaskIndex][nCoalitionMembers];
-				float& CurrentTaskCardinalValuesLowerBound = _TaskCardinalValuesLowerBound[nTaskIndex][nCoalitionMembers];
-				uint32_t& CurrentTaskCardinalValuesCount = _TaskCardinalValuesCount[nTaskIndex][nCoalitionMembers];
-
-				// Update upper bound (max) for cardinal value.
-				if (Value > CurrentCardinalValuesUpperBound)
-					CurrentCardinalValuesUpperBound = Value;
-
-				// Update upper bound (max) for cardinal-task value.
-				if (Value > CurrentTaskCardinalValuesUpperBound)
-					CurrentTaskCardinalValuesUpperBound = Value;
-
-				// Update lower bound (avg) for cardinal value.
-				CurrentCardinalValuesLowerBound = CurrentCardinalValuesLowerBound * CurrentCardinalValueCount + Value;
-				CurrentCardinalValuesLowerBound /= static_cast<float>(CurrentCardinalValueCount + 1.0f);
-
-				// Update lower bound (avg) for cardinal-task value;
-				CurrentTaskCardinalValuesLowerBound = CurrentTaskCardinalValuesLowerBound * CurrentTaskCardinalValuesCount + Value;
-				CurrentTaskCardinalValuesLowerBound /= static_cast<float>(CurrentTaskCardinalValuesCount + 1.0f);
-
-				// Update counts.
-				++CurrentCardinalValueCount;
-				++CurrentTaskCardinalValuesCount;
-			}
-		}
+		// The maximum bounds the value of a coalition from above and the mean is the expected value of a random one.
+		const value_statistics_t& Statistics = _pProblem->get_value_statistics(_nThreads);
+		_CardinalValuesUpperBound = Statistics.max_value_of_size_any_task;
+		_CardinalValuesLowerBound = Statistics.mean_value_of_size_any_task;
+		_TaskCardinalValuesUpperBound = Statistics.max_value_of_size;
+		_TaskCardinalValuesLowerBound = Statistics.mean_value_of_size;
 
 		// -------------------------------------------------------
 		// Calculate partition lower and upper bounds.
@@ -194,10 +269,6 @@ namespace MPHybrid
 				_PartitionsLowerBound[i] += _CardinalValuesLowerBound[nCardinality];
 				_PartitionsUpperBound[i] += _CardinalValuesUpperBound[nCardinality];
 			}
-			if (_PartitionsLowerBound[i] > _vMaximumLowestBound)
-			{
-				_vMaximumLowestBound = _PartitionsLowerBound[i];
-			}
 		}
 	}
 
@@ -220,36 +291,61 @@ namespace MPHybrid
 
 	void CHybridSearcher::StartPartitionSearch
 	(
+		SPartitionSearchState& State,
 		const std::vector<uint32_t>& CurrentPartition,
 		const float vUpperBound
 	)
 	{
-		_CurrentPartition = &CurrentPartition;
+		State._CurrentPartition = &CurrentPartition;
+		++State._Statistics._nSubspaces;
+
+		// Drop the results of the previous permutation, and the exact ones too if they take too much memory.
+		if (State._MemoizationTable.GetMemoryUsage() > MEMOIZATION_BUDGET)
+		{
+			State._MemoizationTable.Clear();
+			State._SizePrefixIds.clear();
+		}
+		State._MemoizationTable.StartEpoch();
+
+		// Tasks are filled from the last to the first, so the result for some unassigned agents only depends on the sizes of the first tasks.
+		State._TaskSizePrefixIds.resize(_nTasks);
+		for (uint32_t nTaskIndex = 0; nTaskIndex < _nTasks; ++nTaskIndex)
+		{
+			const uint64_t nParentId = nTaskIndex == 0 ? 0u : State._TaskSizePrefixIds[nTaskIndex - 1];
+			const auto Inserted = State._SizePrefixIds.emplace((nParentId << 8) | CurrentPartition[nTaskIndex], uint32_t(State._SizePrefixIds.size() + 1));
+			State._TaskSizePrefixIds[nTaskIndex] = Inserted.first->second;
+		}
 
-		_MemoizationMap.clear();
 		const uint32_t nAllAgentBits = (~0u) >> (32u - _nAgents);
 
-		_bPartitionSearchFoundBetterSolution = false;
+		State._bPartitionSearchFoundBetterSolution = false;
 
-		float vWorth = __SearchPartition(vUpperBound, 0.f, nAllAgentBits, uint32_t(_nTasks - 1));
+		float vWorth = __SearchPartition(State, vUpperBound, 0.f, nAllAgentBits, uint32_t(_nTasks - 1));
 
 		// Reconstruct solution found by __SearchPartition.
-		if (_bPartitionSearchFoundBetterSolution && IsBetterThanCurrentBest(vWorth, false))
+		if (!State._bPartitionSearchFoundBetterSolution || !IsBetterThanCurrentBest(vWorth, false))
+		{
+			return;
+		}
+		std::lock_guard<std::mutex> Lock(_BestSolutionMutex);
+		if (IsBetterThanCurrentBest(vWorth, false)) // Another thread may have found a better solution meanwhile.
 		{
 			_vBestSolutionValue = vWorth;
-			_vMaximumLowestBound = std::max(_vBestSolutionValue, _vMaximumLowestBound);
+			RaiseMaximumLowestBound(vWorth);
+			ReportIncumbent(vWorth);
 			uint32_t nUnassignedAgentsMask = nAllAgentBits;
 			for (int nTaskIndex = int(_nTasks) - 1; nTaskIndex >= 1; --nTaskIndex)
 			{
-				uint64_t nMemoizationKey = CalculateMemoizationHashKey(nUnassignedAgentsMask, nTaskIndex);
-				auto pMemoizationPointer = _MemoizationMap.find(nMemoizationKey);
-				if (pMemoizationPointer == _MemoizationMap.end())
+				uint64_t nMemoizationKey = CalculateMemoizationHashKey(State, nUnassignedAgentsMask, nTaskIndex);
+				bool bExact, bShared;
+				const SMemoizationEntry* pMemoizationPointer = State._MemoizationTable.Find(nMemoizationKey, bExact, bShared);
+				if (pMemoizationPointer == nullptr)
 				{
 					_BestSolution[nTaskIndex].set_value(0u); // We get here for tasks that have 0 agents assigned to them.
 				}
 				else
 				{
-					_BestSolution[nTaskIndex].set_value(pMemoizationPointer->second._nBestCoalition);
+					_BestSolution[nTaskIndex].set_value(pMemoizationPointer->_nBestCoalition);
 					nUnassignedAgentsMask &= (~_BestSolution[nTaskIndex].get_agent_mask());
 				}
 			}
@@ -258,13 +354,14 @@ namespace MPHybrid
 		}
 	}
 
-	inline const uint64_t CHybridSearcher::CalculateMemoizationHashKey(const uint32_t nUnassignedAgentsMask, const uint32_t nTaskIndex)
+	inline const uint64_t CHybridSearcher::CalculateMemoizationHashKey(const SPartitionSearchState& State, const uint32_t nUnassignedAgentsMask, const uint32_t nTaskIndex)
 	{
-		return uint64_t(nUnassignedAgentsMask) | (uint64_t(nTaskIndex) << 32ULL);
+		return uint64_t(nUnassignedAgentsMask) | (uint64_t(State._TaskSizePrefixIds[nTaskIndex]) << 32ULL);
 	}
 
 	float CHybridSearcher::__SearchPartition
 	(
+		SPartitionSearchState& State,
 		const float vUpperBoundRemaining,
 		const float vCurrentValue,
 		const uint32_t nUnassignedAgentsMask,
@@ -274,68 +371,80 @@ namespace MPHybrid
 		if (nTaskIndex == 0)
 		{
 			// Assign all agents to the only remaining task.
-			_bPartitionSearchFoundBetterSolution = true;
-			if (_UtilityValues[nTaskIndex][nUnassignedAgentsMask] + vCurrentValue > _vMaximumLowestBound)
-			{
-				_vMaximumLowestBound = _UtilityValues[nTaskIndex][nUnassignedAgentsMask] + vCurrentValue;
-			}
-			return _UtilityValues[nTaskIndex][nUnassignedAgentsMask];
+			State._bPartitionSearchFoundBetterSolution = true;
+			RaiseMaximumLowestBound(_UtilityValues.get_value_of(nUnassignedAgentsMask, nTaskIndex) + vCurrentValue);
+			return _UtilityValues.get_value_of(nUnassignedAgentsMask, nTaskIndex);
 		}
 
 		if (!IsBetterThanCurrentBest(vCurrentValue + vUpperBoundRemaining))
 		{
 			// This does NOT generate an optimal solution, since vCurrentValue can be different when evaluating the 
 			// search tree different paths.
+			++State._nInexactResults;
 			return NEG_INF;
 		}
 
-		const uint64_t nMemoizationKey = CalculateMemoizationHashKey(nUnassignedAgentsMask, nTaskIndex);
+		const uint64_t nMemoizationKey = CalculateMemoizationHashKey(State, nUnassignedAgentsMask, nTaskIndex);
 
-		auto pMemoizationPointer = _MemoizationMap.find(nMemoizationKey);
-		if (pMemoizationPointer != _MemoizationMap.end())
+		++State._Statistics._nLookups;
+		bool bExact, bShared;
+		const SMemoizationEntry* pMemoizationPointer = State._MemoizationTable.Find(nMemoizationKey, bExact, bShared);
+		// A branch pruned with a lower current value could have been kept now, so then the entry is searched again.
+		if (pMemoizationPointer != nullptr && (bExact || vCurrentValue <= pMemoizationPointer->_vCurrentValue))
 		{
-			// Already evaluated this branch.
-			return pMemoizationPointer->second._vUtilityValue;
+			// Already evaluated this branch, in this permutation or exactly in an earlier one.
+			++State._Statistics._nHits;
+			State._Statistics._nSharedHits += bShared;
+			if (!bExact)
+			{
+				++State._nInexactResults;
+			}
+			State._bPartitionSearchFoundBetterSolution = true;
+			return pMemoizationPointer->_vUtilityValue;
 		}
 
-		const uint32_t nCoalitionSize = (*_CurrentPartition)[nTaskIndex];
+		const uint64_t nInexactResultsBefore = State._nInexactResults;
+
+		const uint32_t nCoalitionSize = (*State._CurrentPartition)[nTaskIndex];
 
 		uint32_t nBestMask = 0u;
 		float vBestValue = NEG_INF;
 
-		for (const uint32_t nCoalitionMask : _CoalitionsOfSize[nCoalitionSize])
-		{
-			if (HasTimeElapsed())
+		// Only coalitions of unassigned agents are generated, in the same increasing mask order as a scan over all masks.
+		const bool bCompleted = utility::bits::for_each_submask_of_size_32bit(nUnassignedAgentsMask, nCoalitionSize, [&](const uint32_t nCoalitionMask)
 			{
-				return NEG_INF;
-			}
+				if (HasTimeElapsed())
+				{
+					return false;
+				}
 
-			if ((nUnassignedAgentsMask & nCoalitionMask) == nCoalitionMask)
-			{
 				// These two values are only used for branch-and-bound techniques.
-				const float vValue = vCurrentValue + _UtilityValues[nTaskIndex][nCoalitionMask];
+				const float vValue = vCurrentValue + _UtilityValues.get_value_of(nCoalitionMask, nTaskIndex);
 				const float vNewUpperBoundRemaining = vUpperBoundRemaining - _TaskCardinalValuesUpperBound[nTaskIndex][nCoalitionSize];
 
-				float vWorth = __SearchPartition(vNewUpperBoundRemaining, vValue, nUnassignedAgentsMask & (~nCoalitionMask), nTaskIndex - 1);
+				float vWorth = __SearchPartition(State, vNewUpperBoundRemaining, vValue, nUnassignedAgentsMask & (~nCoalitionMask), nTaskIndex - 1);
 				if (vWorth > NEG_INF) // Prevent storing DP-solution when there is no end-path.
 				{
-					vWorth += _UtilityValues[nTaskIndex][nCoalitionMask];
+					vWorth += _UtilityValues.get_value_of(nCoalitionMask, nTaskIndex);
 					if (vWorth > vBestValue)
 					{
 						vBestValue = vWorth;
 						nBestMask = nCoalitionMask;
 					}
 				}
-			}
+				return true;
+			});
+
+		if (!bCompleted)
+		{
+			++State._nInexactResults;
+			return NEG_INF;
 		}
 
 		if (vBestValue > NEG_INF) // Only store DP solution if we found an end-path.
 		{
-			_MemoizationMap.emplace(nMemoizationKey, SMemoizationEntry(vBestValue, nBestMask));
-			if (vCurrentValue + vBestValue > _vMaximumLowestBound)
-			{
-				_vMaximumLowestBound = vCurrentValue + vBestValue;
-			}
+			State._MemoizationTable.Insert(nMemoizationKey, SMemoizationEntry(vBestValue, nBestMask, vCurrentValue), State._nInexactResults == nInexactResultsBefore);
+			RaiseMaximumLowestBound(vCurrentValue + vBestValue);
 		}
 
 		return vBestValue;
@@ -347,33 +456,68 @@ namespace MPHybrid
 	// ------------------------------------------------------------------------------
 	// ------------------------------------------------------------------------------
 
-	void CHybridSearcher::SearchCurrentPermutations()
+	bool CHybridSearcher::PopPermutation(solver_agent_greed* pGreedySolver, std::vector<uint32_t>& Permutation, float& vUpperBound)
 	{
-		std::sort(PermutationOrder.begin(), PermutationOrder.end(), [&](const uint32_t lhs, const uint32_t rhs)
+		float vLowerBound;
+		while (true)
+		{
 			{
-				if (std::abs(Permutations[lhs]._vUpperBound - Permutations[rhs]._vUpperBound) < _vOptimalityTolerance)
+				std::lock_guard<std::mutex> Lock(_SubspacesMutex);
+				const bool bPopped = !HasTimeElapsed() && _Subspaces.pop([&](const float vBound) { return IsBetterThanCurrentBest(vBound); }, Permutation, vUpperBound, vLowerBound);
+				// Subspaces that are still waiting are searched unless a better solution prunes them, so their lower bounds
+				// hold. The popped one is not counted, so that its own lower bound never prunes it.
+				_vMaximumSubspaceLowerBound = _Subspaces.get_max_waiting_lower_bound();
+				if (!bPopped)
 				{
-					return Permutations[lhs]._vLowerBound > Permutations[rhs]._vLowerBound;
+					return false;
 				}
-				return Permutations[lhs]._vUpperBound > Permutations[rhs]._vUpperBound;
-			});
+				++_nPoppedSubspaces;
+			}
 
-		for (const uint32_t PermutationIndex : PermutationOrder)
-		{
-			if (HasTimeElapsed())
+			// The greedy solve runs without holding _SubspacesMutex, so that the other threads keep popping meanwhile.
+			if (pGreedySolver != nullptr)
 			{
-				return;
+				auto GreedySolution = pGreedySolver->solve(_pProblem, &Permutation);
+				std::lock_guard<std::mutex> BestLock(_BestSolutionMutex);
+				if (IsBetterThanCurrentBest(GreedySolution.value, false))
+				{
+					_BestSolution = GreedySolution.ordered_coalition_structure;
+					_vBestSolutionValue = GreedySolution.value;
+					RaiseMaximumLowestBound(GreedySolution.value);
+					ReportIncumbent(GreedySolution.value);
+				}
 			}
 
-			if (IsBetterThanCurrentBest(Permutations[PermutationIndex]._vUpperBound))
+			if (IsBetterThanCurrentBest(vUpperBound))
 			{
-				StartPartitionSearch(Permutations[PermutationIndex]._Permutation, Permutations[PermutationIndex]._vUpperBound);
+				return true;
 			}
-			else
+		}
+	}
+
+	void CHybridSearcher::SearchPermutations(solver_agent_greed* pGreedySolver)
+	{
+		// Greedy solves change the state of the solver, so every thread solves with its own copy.
+		std::vector<solver_agent_greed> GreedySolvers(pGreedySolver != nullptr ? _SearchStates.size() : 0u, pGreedySolver != nullptr ? *pGreedySolver : solver_agent_greed());
+
+		// Every thread pops the next best permutation when it is done with its last one. Permutations are generated
+		// on demand, so those that the best solution found by then prunes are never generated at all.
+		utility::parallel::for_each_index_of_worker(_SearchStates.size(), uint32_t(_SearchStates.size()), [&](const uint64_t, const uint32_t nWorker)
+		{
+			solver_agent_greed* pWorkerGreedySolver = GreedySolvers.empty() ? nullptr : &GreedySolvers[nWorker];
+			std::vector<uint32_t> Permutation;
+			float vUpperBound;
+			SMemoizationStatistics& Statistics = _SearchStates[nWorker]._Statistics;
+			utility::date_and_time::timer SubspaceTimer;
+			while (PopPermutation(pWorkerGreedySolver, Permutation, vUpperBound))
 			{
-				break; // We can discard the rest (since the search queue is sorted on upper bound first).
+				SubspaceTimer.start();
+				StartPartitionSearch(_SearchStates[nWorker], Permutation, vUpperBound);
+				const double vSeconds = SubspaceTimer.stop();
+				Statistics._vSubspaceSeconds += vSeconds;
+				Statistics._vLongestSubspaceSeconds = std::max(Statistics._vLongestSubspaceSeconds, vSeconds);
 			}
-		}
+		});
 	}
 
 	// ------------------------------------------------------------------------------
@@ -382,12 +526,27 @@ namespace MPHybrid
 	// ------------------------------------------------------------------------------
 	// ------------------------------------------------------------------------------
 
+	SMemoizationStatistics CHybridSearcher::GetMemoizationStatistics() const
+	{
+		SMemoizationStatistics Statistics;
+		for (const SPartitionSearchState& State : _SearchStates)
+		{
+			Statistics._nSubspaces += State._Statistics._nSubspaces;
+			Statistics._nLookups += State._Statistics._nLookups;
+			Statistics._nHits += State._Statistics._nHits;
+			Statistics._nSharedHits += State._Statistics._nSharedHits;
+			Statistics._vSubspaceSeconds += State._Statistics._vSubspaceSeconds;
+			Statistics._vLongestSubspaceSeconds = std::max(Statistics._vLongestSubspaceSeconds, State._Statistics._vLongestSubspaceSeconds);
+		}
+		return Statistics;
+	}
+
 	instance_solution CHybridSearcher::FindOptimalCoalitionStructure
 	(
 		const instance_solution* pInitialSolution,
 		const bool bTryUseAGIAsLowerBound,
-		const float vTimeLimit,
-		const uint32_t nPermutationsPerBlock
+		const deadline_token* pDeadline,
+		const uint32_t nThreads
 	)
 	{
 		instance_solution Result; // Result.
@@ -403,8 +562,9 @@ namespace MPHybrid
 			}
 		}
 
-		_TimeStartPoint = std::chrono::high_resolution_clock::now();
-		_vTimeLimit = vTimeLimit;
+		_pDeadline = pDeadline;
+		_nThreads = nThreads;
+		_nPoppedSubspaces = 0;
 
 		// ----------------------------------------------------------------------------
 		// Find an initial solution to use as baseline.
@@ -424,6 +584,7 @@ namespace MPHybrid
 			_bHasFoundSolution = true;
 			_vBestSolutionValue = pInitialSolution->value;
 			_BestSolution = pInitialSolution->ordered_coalition_structure;
+			ReportIncumbent(pInitialSolution->value);
 		}
 
 		// ----------------------------------------------------------------------------
@@ -439,6 +600,7 @@ namespace MPHybrid
 
 		solver_agent_greed GreedySolver;
 		GreedySolver._RunHillClimbToPolish = true;
+		GreedySolver._pParentDeadline = _pDeadline;
 		if (bTryUseAGIAsLowerBound)
 		{
 			auto GreedyGlobalSolution = GreedySolver.solve(_pProblem);
@@ -448,7 +610,8 @@ namespace MPHybrid
 				_bHasFoundSolution = true;
 				_BestSolution = GreedyGlobalSolution.ordered_coalition_structure;
 				_vBestSolutionValue = GreedyGlobalSolution.value;
-				_vMaximumLowestBound = std::max(_vBestSolutionValue, _vMaximumLowestBound);;
+				RaiseMaximumLowestBound(GreedyGlobalSolution.value);
+				ReportIncumbent(GreedyGlobalSolution.value);
 			}
 
 			for (uint32_t nPartitionIndex = 0; nPartitionIndex < _Partitions.size(); ++nPartitionIndex)
@@ -464,114 +627,19 @@ namespace MPHybrid
 					_bHasFoundSolution = true;
 					_BestSolution = GreedySolution.ordered_coalition_structure;
 					_vBestSolutionValue = GreedySolution.value;
-					_vMaximumLowestBound = std::max(_vBestSolutionValue, _vMaximumLowestBound);;
+					RaiseMaximumLowestBound(GreedySolution.value);
+					ReportIncumbent(GreedySolution.value);
 				}
 			}
 		}
 
-		// ----------------------------------------------------------------------------
-		// Decide on the order for which we expand partitions.
-		// ----------------------------------------------------------------------------
-
-		std::vector<uint32_t> ExpansionOrder;
-		ExpansionOrder.reserve(_Partitions.size());
-		for (uint32_t nPartitionIndex = 0; nPartitionIndex < _Partitions.size(); ++nPartitionIndex)
-		{
-			if (IsBetterThanCurrentBest(_PartitionsUpperBound[nPartitionIndex]))
-			{
-				ExpansionOrder.push_back(nPartitionIndex);
-			}
-		}
-
-		// ----------------------------------------------------------------------------
-		// Decide on ExpansionOrderFunction.
-		// ----------------------------------------------------------------------------
-
-		const auto ExpansionOrderFunction = [&](const uint32_t lhs, const uint32_t rhs)
-		{
-			if (std::abs(_PartitionsUpperBound[lhs] - _PartitionsUpperBound[rhs]) < _vOptimalityTolerance)
-				return _PartitionsLowerBound[lhs] > _PartitionsLowerBound[rhs];
-			return _PartitionsUpperBound[lhs] > _PartitionsUpperBound[rhs];
-		};
-
-		std::sort(ExpansionOrder.begin(), ExpansionOrder.end(), ExpansionOrderFunction);
-
-		// ----------------------------------------------------------------------------
-		// Initialize search.
-		// ----------------------------------------------------------------------------
-
-		PermutationOrder.clear();
-		Permutations.clear();
-
-		PermutationOrder.reserve(nPermutationsPerBlock);
-		Permutations.reserve(nPermutationsPerBlock);
-
 		// ----------------------------------------------------------------------------
 		// Start search (branch-and-bound).
 		// ----------------------------------------------------------------------------
-		for (uint32_t i = 0; i < ExpansionOrder.size() && !HasTimeElapsed(); ++i)
-		{
-			const int nPartitionIndex = ExpansionOrder[i];
-			auto& CurrentPartition = _Partitions[nPartitionIndex];
-			const auto vSubspaceUpperBound = _PartitionsUpperBound[nPartitionIndex];
 
-			// Can this subspace improve best solution value?
-			if (!IsBetterThanCurrentBest(vSubspaceUpperBound))
-			{
-				break;
-			}
-
-			// Non-increasing order for next_permutation.
-			std::sort(CurrentPartition.begin(), CurrentPartition.end());
-
-			do
-			{
-				// Calculate tighter (better) bounds.
-				float vPermutationUpperBound = 0.0f, vPermutationLowerBound = 0.0f;
-				for (uint32_t nTaskIndex = 0; nTaskIndex < CurrentPartition.size(); ++nTaskIndex)
-				{
-					const uint32_t P = CurrentPartition[nTaskIndex];
-					vPermutationLowerBound += _TaskCardinalValuesLowerBound[nTaskIndex][P];
-					vPermutationUpperBound += _TaskCardinalValuesUpperBound[nTaskIndex][P];
-				}
-
-				// Update maximum lowest bound if possible.
-				if (vPermutationLowerBound > _vMaximumLowestBound)
-				{
-					_vMaximumLowestBound = vPermutationLowerBound;
-				}
-
-				if (IsBetterThanCurrentBest(vPermutationUpperBound))
-				{
-					if (bTryUseAGIAsLowerBound)
-					{
-						auto GreedySolution = GreedySolver.solve(_pProblem, &CurrentPartition);
-						if (IsBetterThanCurrentBest(GreedySolution.value, false))
-						{
-							_BestSolution = GreedySolution.ordered_coalition_structure;
-							_vBestSolutionValue = GreedySolution.value;
-							_vMaximumLowestBound = std::max(_vMaximumLowestBound, _vBestSolutionValue);
-						}
-					}
-
-					// Add permutation to search queue.
-					PermutationOrder.push_back(uint32_t(PermutationOrder.size()));
-					Permutations.emplace_back(CurrentPartition, vPermutationLowerBound, vPermutationUpperBound);
-
-					if (Permutations.size() >= nPermutationsPerBlock)
-					{
-						SearchCurrentPermutations();
-						Permutations.clear();
-						PermutationOrder.clear();
-					}
-				}
-			} while (std::next_permutation(CurrentPartition.begin(), CurrentPartition.end()) && !HasTimeElapsed());
-		}
-
-		if (Permutations.size() > 0 && !HasTimeElapsed())
-		{
-			SearchCurrentPermutations();
-		}
+		_Subspaces.reset(_Partitions, _PartitionsUpperBound, _TaskCardinalValuesUpperBound, _TaskCardinalValuesLowerBound);
+		_SearchStates.resize(utility::parallel::get_n_threads(_nThreads));
+		SearchPermutations(bTryUseAGIAsLowerBound ? &GreedySolver : nullptr);
 
 		// ----------------------------------------------------------------------------
 		// Construct best solution.
@@ -589,8 +657,12 @@ namespace MPHybrid
 
 instance_solution solver_mp_hybrid::solve(coalitional_values_generator* problem, const instance_solution* initial_solution)
 {
+	const deadline_token::guard deadline_guard{ deadline, vTimeLimit };
 	MPHybrid::CHybridSearcher generator(problem, problem->get_n_agents(), problem->get_n_tasks(), problem->get_data());
-	return generator.FindOptimalCoalitionStructure(initial_solution, true, vTimeLimit);
+	generator.SetIncumbentCallback([this](const float vValue, const uint64_t nPoppedSubspaces) { report_incumbent(vValue, nPoppedSubspaces); });
+	instance_solution solution = generator.FindOptimalCoalitionStructure(initial_solution, true, &deadline, _nThreads);
+	_MemoizationStatistics = generator.GetMemoizationStatistics();
+	return solution;
 }
 
 instance_solution solver_mp_hybrid::solve(coalitional_values_generator* problem)
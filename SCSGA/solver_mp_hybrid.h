@@ -2,7 +2,9 @@
 #include "solver.h"
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
+#include <mutex>
 #include <vector>
 #include <chrono>
 #include <limits>
@@ -14,6 +16,7 @@
 #include "solver_agent_greed.h"
 #include "solver_task_greed.h"
 
+#include "subspace_queue.h"
 #include "utility.h"
 
 
@@ -59,24 +62,84 @@ namespace MPHybrid
 	// ------------------------------------------------------------------------------
 	// ------------------------------------------------------------------------------
 
+	struct SMemoizationEntry
+	{
+		float _vUtilityValue = std::numeric_limits<float>::lowest();
+		uint32_t _nBestCoalition = 0u;
+		float _vCurrentValue = 0.f; // Of the tasks assigned when the entry was found, which limits where an inexact entry can be reused.
+		SMemoizationEntry(){}
+		SMemoizationEntry(float vUtilityValue, uint32_t nBestCoalition, float vCurrentValue)
+		{
+			_vUtilityValue = vUtilityValue;
+			_nBestCoalition = nBestCoalition;
+			_vCurrentValue = vCurrentValue;
+		}
+	};
+
+	// Counts of the memoization of the partition DP, summed over all threads.
+	struct SMemoizationStatistics
+	{
+		uint64_t _nSubspaces = 0; // Permutations searched.
+		uint64_t _nLookups = 0;
+		uint64_t _nHits = 0;
+		uint64_t _nSharedHits = 0; // Hits on exact results of earlier permutations.
+		double _vSubspaceSeconds = 0.0; // Time spent searching permutations, so that shared hits can be weighed against it.
+		double _vLongestSubspaceSeconds = 0.0; // Of the single permutation that took longest to search.
+	};
+
+	/*
+		Open-addressing table of the results of the partition DP, keyed by the unassigned agents and an id
+		of the coalition sizes of the tasks they are assigned to. A result that was found while pruning is
+		only valid within the search of one permutation, and StartEpoch invalidates all of them in O(1). An
+		exact result stays valid, so later permutations with the same sizes of these tasks reuse it.
+	*/
+	class CMemoizationTable
+	{
+	public:
+		void StartEpoch();
+		void Clear();
+		// nullptr unless the entry is exact or from the current epoch. bShared is true for exact entries of earlier epochs.
+		const SMemoizationEntry* Find(const uint64_t nKey, bool& bExact, bool& bShared) const;
+		void Insert(const uint64_t nKey, const SMemoizationEntry& Entry, const bool bExact);
+		size_t GetMemoryUsage() const; // In bytes.
+
+	private:
+		static constexpr uint64_t EMPTY_KEY = ~0ULL;
+		static constexpr uint32_t EXACT_EPOCH = 0u;
+		static constexpr size_t MINIMUM_CAPACITY = size_t(1) << 12;
+
+		struct SSlot
+		{
+			uint64_t _nKey = EMPTY_KEY;
+			SMemoizationEntry _Entry;
+			uint32_t _nEpoch = EXACT_EPOCH;
+			uint32_t _nCreationEpoch = EXACT_EPOCH;
+		};
+
+		std::vector<SSlot> _Slots;
+		size_t _nOccupiedSlots = 0; // Including slots of earlier epochs, which are only dropped when rehashing.
+		uint32_t _nEpoch = EXACT_EPOCH + 1;
+
+		size_t FindSlot(const uint64_t nKey) const; // The slot of the key, or the empty slot where it would be.
+		bool IsLive(const SSlot& Slot) const;
+		void Rehash(const size_t nCapacity);
+	};
+
 	class CHybridSearcher
 	{
 	private:
 		std::vector<std::vector<uint32_t>> _Partitions; // Contains all partitions.
-		std::vector<std::vector<uint32_t>> _CoalitionsOfSize; // _CoalitionsOfSize[k] contains all coalitions with k members. 
 
 		std::vector<float> _PartitionsLowerBound; // Partition lower bound.
 		std::vector<float> _PartitionsUpperBound; // Partition upper bound.
 
-		const std::vector<std::vector<float>>& _UtilityValues; // Utility values for all coalitions assigned to tasks.
+		const coalition_value_table& _UtilityValues; // Utility values for all coalitions assigned to tasks.
 
 		std::vector<float> _CardinalValuesUpperBound; // Mask upper bound.
 		std::vector<float> _CardinalValuesLowerBound; // Mask lower bound.
-		std::vector<uint32_t> _CardinalValuesCount;	  // The number of values for a specific agent count (bitcount in mask).
 
 		std::vector<std::vector<float>> _TaskCardinalValuesUpperBound;	// Mask to task upper bound.
 		std::vector<std::vector<float>> _TaskCardinalValuesLowerBound;	// Mask to task lower bound.
-		std::vector<std::vector<uint32_t>> _TaskCardinalValuesCount;	// The number of values for a specific agent count of a task (bitcount in mask).
 
 		const size_t _nAgents;
 		const size_t _nTasks;
@@ -85,9 +148,13 @@ namespace MPHybrid
 		const float _vLowestBoundTolerance = 0.001f;	// Must be a number larger than 0.0ff.
 		const float _vOptimalityTolerance = 0.001f; // A large tolerance makes it possible to cut branches earlier, but might miss optimal solution.
 
-		float _vTimeLimit = -1.0f;
+		const deadline_token* _pDeadline = nullptr;
+
+		std::function<void(const float, const uint64_t)> _IncumbentCallback;
+		std::atomic<uint64_t> _nPoppedSubspaces{ 0 }; // Since the search started.
 
-		std::chrono::high_resolution_clock::time_point _TimeStartPoint;
+		// Must be called while holding _BestSolutionMutex, or before the threads start, so that the callback is never run concurrently.
+		void ReportIncumbent(const float vValue) const;
 
 	public:
 		// Searcher constructor.
@@ -96,9 +163,12 @@ namespace MPHybrid
 			coalitional_values_generator* problem,
 			const size_t nAgents,
 			const size_t nTasks,
-			const std::vector<std::vector<float>>& UtilityValues
+			const coalition_value_table& UtilityValues
 		);
 
+		// Callback is called with the value of every new best solution and the number of subspaces popped by then.
+		void SetIncumbentCallback(std::function<void(const float, const uint64_t)> Callback);
+
 		struct SPartitionSearchResult
 		{
 			std::vector<uint32_t> _CollaborationStructure;
@@ -132,37 +202,50 @@ namespace MPHybrid
 		// ------------------------------------------------------------------------------
 		// ------------------------------------------------------------------------------
 
+		// The best solution and the bounds are shared by the threads searching permutations. The values
+		// only increase, except for _vMaximumSubspaceLowerBound, and _BestSolution is only changed while holding _BestSolutionMutex.
 		coalition::ordered_coalition_structure_t _BestSolution; // Represents the best solution found so far. 
-		bool _bPartitionSearchFoundBetterSolution = false;
-		bool _bHasFoundSolution = false; // Is true if we have found a solution.
-		float _vBestSolutionValue = std::numeric_limits<float>::lowest(); // The value of the best solution found so far.
-		float _vMaximumLowestBound = std::numeric_limits<float>::lowest(); // The maximum lower bound for all solutions.
+		std::mutex _BestSolutionMutex;
+		std::atomic<bool> _bHasFoundSolution{ false }; // Is true if we have found a solution.
+		std::atomic<float> _vBestSolutionValue{ std::numeric_limits<float>::lowest() }; // The value of the best solution found so far.
+		std::atomic<float> _vMaximumLowestBound{ std::numeric_limits<float>::lowest() }; // The largest value reached by a solution.
+		// The largest lower bound, from the mean values, of a subspace still waiting in _Subspaces, which is set after
+		// every pop and may thus decrease. No solution may reach it yet, so it only prunes bounds below it by more than
+		// the tolerance, which never prunes the best solution of the subspace itself.
+		std::atomic<float> _vMaximumSubspaceLowerBound{ std::numeric_limits<float>::lowest() };
+
+		void RaiseMaximumLowestBound(const float vValue);
+
+		static constexpr size_t MEMOIZATION_BUDGET = size_t(256) << 20; // Bytes of a memoization table before its exact results are dropped.
+
+		// The state of a search of a single permutation. Every thread has its own, and its memoization table
+		// keeps the exact results of the permutations the thread searched before.
+		struct SPartitionSearchState
+		{
+			bool _bPartitionSearchFoundBetterSolution = false;
+			std::vector<uint32_t> const * _CurrentPartition = nullptr; // Contains the original data for the current partition's permutation.
+			CMemoizationTable _MemoizationTable;
+			std::unordered_map<uint64_t, uint32_t> _SizePrefixIds; // Id of the sizes of tasks 0..t, keyed by the id of tasks 0..t-1 and the size of t.
+			std::vector<uint32_t> _TaskSizePrefixIds; // Id of the sizes of tasks 0..t of the current permutation.
+			uint64_t _nInexactResults = 0; // Results that depended on pruning, a subtree is exact if this does not change.
+			SMemoizationStatistics _Statistics;
+		};
+
+		uint32_t _nThreads = 1; // Threads searching the permutations.
+		std::vector<SPartitionSearchState> _SearchStates;
 
-		std::vector<uint32_t> const * _CurrentPartition = nullptr; // Contains the original data for the current partition's permutation.
+		inline const uint64_t CalculateMemoizationHashKey(const SPartitionSearchState& State, const uint32_t nUnassignedAgentsMask, const uint32_t nTaskIndex);
 
 		void StartPartitionSearch
 		(
+			SPartitionSearchState& State,
 			const std::vector<uint32_t>& CurrentPartition,
 			const float vUpperBound
 		);
 
-		struct SMemoizationEntry
-		{
-			float _vUtilityValue = std::numeric_limits<float>::lowest();
-			uint32_t _nBestCoalition = 0u;
-			SMemoizationEntry(){}
-			SMemoizationEntry(float vUtilityValue, uint32_t nBestCoalition)
-			{
-				_vUtilityValue = vUtilityValue;
-				_nBestCoalition = nBestCoalition;
-			}
-		};
-
-		std::unordered_map<uint64_t, SMemoizationEntry> _MemoizationMap;
-		inline const uint64_t CalculateMemoizationHashKey(const uint32_t nUnassignedAgentsMask, const uint32_t nTaskIndex);
-
 		float __SearchPartition
 		(
+			SPartitionSearchState& State,
 			const float vUpperBoundRemaining,
 			const float vCurrentValue,
 			const uint32_t nUnassignedAgentsMask,
@@ -175,19 +258,15 @@ namespace MPHybrid
 		// ------------------------------------------------------------------------------
 		// ------------------------------------------------------------------------------
 
-		struct SPartitionPermutation
-		{
-			std::vector<uint32_t> _Permutation;
-			const float _vLowerBound = std::numeric_limits<float>::lowest(), _vUpperBound = std::numeric_limits<float>::max();
-			SPartitionPermutation(const std::vector<uint32_t>& Permutation, const float vLowerBound, const float vUpperBound)
-				: _Permutation(Permutation), _vLowerBound(vLowerBound), _vUpperBound(vUpperBound)
-			{}
-		};
+		subspace_queue _Subspaces; // The permutations left to search, generated best first by upper bound.
+		std::mutex _SubspacesMutex;
 
-		std::vector<SPartitionPermutation> Permutations;
-		std::vector<uint32_t> PermutationOrder, SortedPermutationOrder;
+		// Pops the next permutation worth searching. If pGreedySolver is set, its solution of every popped permutation is
+		// used in an attempt to improve the best solution first, without holding _SubspacesMutex, so it must be the thread's own.
+		bool PopPermutation(solver_agent_greed* pGreedySolver, std::vector<uint32_t>& Permutation, float& vUpperBound);
 
-		void SearchCurrentPermutations();
+		// Searches the permutations in upper bound order, on _nThreads threads that prune against the shared best solution.
+		void SearchPermutations(solver_agent_greed* pGreedySolver);
 
 	public:
 
@@ -197,6 +276,8 @@ namespace MPHybrid
 		// ------------------------------------------------------------------------------
 		// ------------------------------------------------------------------------------
 
+		SMemoizationStatistics GetMemoizationStatistics() const;
+
 		instance_solution FindOptimalCoalitionStructure
 		(
 			// An initial solution can be used to provide a better starting global lower bound.
@@ -206,13 +287,13 @@ namespace MPHybrid
 			// that is used in an attempt to improve that subspace's lower bound.
 			const bool bTryUseAGIAsLowerBound = false,
 
-			// If this is > 0.0f, a time limit is used to interrupt the algorithm's
-			// search procedure.
-			const float vTimeLimit = -1.0f,
+			// If this is set, the search is interrupted once it expires, as soon as a solution is found.
+			const deadline_token* pDeadline = nullptr,
 
-			// Number of permutations that are stored per block.
-			// Increasing this number => increases performance and memory usage.
-			const uint32_t nPermutationsPerBlock = 100000u
+			// Number of threads that search the permutations, 0 for one per hardware thread.
+			// Threads may search the permutations in a slightly different order, so the value of the solution
+			// is only the same as with a single thread up to the pruning tolerances.
+			const uint32_t nThreads = 1u
 		);
 	};
 }
@@ -220,6 +301,8 @@ namespace MPHybrid
 class solver_mp_hybrid : public solver
 {
 public:
+	uint32_t _nThreads = 1; // Threads searching the subspaces, 0 for one per hardware thread.
+	MPHybrid::SMemoizationStatistics _MemoizationStatistics; // Of the last solve.
 
 	instance_solution solve(coalitional_values_generator* problem, const instance_solution* initial_solution);
 	instance_solution solve(coalitional_values_generator* problem) override;
@@ -11,8 +11,7 @@ instance_solution solver_pure_random_search::solve(coalitional_values_generator*
 	upd_generator = std::uniform_int_distribution<uint32_t>(0, problem->get_n_tasks() - 1);
 	unsigned long long nMaxIterations = std::max<unsigned long long>(1ULL, nIterations);
 
-	utility::date_and_time::timer timer{};
-	timer.start_countdown(vTimeLimit);
+	const deadline_token::guard deadline_guard{ deadline, vTimeLimit };
 
 	std::vector<unsigned int> agent_order(problem->get_n_agents());
 	for (int i = 0; i < agent_order.size(); ++i)
@@ -36,16 +35,17 @@ instance_solution solver_pure_random_search::solve(coalitional_values_generator*
 		current_solution.recalculate_value(problem);
 		if (_RunHillClimbToPolish)
 		{
-			solver_agent_greed::HillClimb(current_solution, problem, agent_order, generator, timer);
+			solver_agent_greed::HillClimb(current_solution, problem, agent_order, generator, deadline);
 		}
 
 		// Evaluate solution.
 		if (current_solution.value > best_solution.value)
 		{
 			best_solution = current_solution;
+			report_incumbent(best_solution.value, nIteration + 1);
 		}
 
-		if (vTimeLimit < 0 || timer.countdown_reached()) {
+		if (vTimeLimit < 0 || deadline.expired()) {
 			break;
 		}
 	}
@@ -12,10 +12,7 @@ instance_solution solver_swap_random_search::solve(coalitional_values_generator*
 	AgentIndexUniformGenerator = std::uniform_int_distribution<uint32_t>(0, problem->get_n_agents() - 1);
 	const unsigned long long nMaxIterations = std::max<unsigned long long>(1ULL, nIterations);
 
-	std::chrono::high_resolution_clock::time_point t1, t2;
-	if (vTimeLimit >= 0) {
-		t1 = std::chrono::high_resolution_clock::now();
-	}
+	const deadline_token::guard deadline_guard{ deadline, vTimeLimit };
 
 	std::vector<uint32_t> nAgentAssignments(problem->get_n_agents(), 0);
 	current_solution = instance_solution();
@@ -33,6 +30,7 @@ instance_solution solver_swap_random_search::solve(coalitional_values_generator*
 
 	current_solution.recalculate_value(problem);
 	best_solution = current_solution;
+	report_incumbent(best_solution.value, 0);
 
 	for (unsigned nIteration = 0; nIteration < nMaxIterations; ++nIteration)
 	{
@@ -58,20 +56,15 @@ instance_solution solver_swap_random_search::solve(coalitional_values_generator*
 				if (current_solution.value > best_solution.value)
 				{
 					best_solution = current_solution;
+					report_incumbent(best_solution.value, nIteration + 1);
 				}
 				break;
 			}
 		}
 
-		if (vTimeLimit >= 0)
+		if (deadline.expired())
 		{
-			t2 = std::chrono::high_resolution_clock::now();
-			auto elapsed_time = std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1).count();
-			// std::cout << "elapsed: " << elapsed_time << std::endl;
-			if (elapsed_time >= vTimeLimit)
-			{
-				break;
-			}
+			break;
 		}
 	}
 
@@ -1,5 +1,19 @@
 #include "solver_task_greed.h"
 
+instance_solution solver_task_greed::solve(coalitional_values_generator* pProblem, std::vector<uint32_t> const* coalition_size_bounds)
+{
+	switch (_SubsetEnumeration)
+	{
+	case utility::bits::subset_enumeration_t::SOFTWARE_PDEP:
+		return solve<utility::bits::subset_enumeration_t::SOFTWARE_PDEP>(pProblem, coalition_size_bounds);
+	case utility::bits::subset_enumeration_t::PDEP:
+		return solve<utility::bits::subset_enumeration_t::PDEP>(pProblem, coalition_size_bounds);
+	default:
+		return solve<utility::bits::subset_enumeration_t::SUBMASK>(pProblem, coalition_size_bounds);
+	}
+}
+
+template<utility::bits::subset_enumeration_t ENUMERATION>
 instance_solution solver_task_greed::solve(coalitional_values_generator* pProblem, std::vector<uint32_t> const* coalition_size_bounds)
 {
 	assert(pProblem->get_n_agents() < 32);
@@ -42,15 +56,10 @@ instance_solution solver_task_greed::solve(coalitional_values_generator* pProble
 		uint32_t nBestTaskIndex = 0;
 		float vBestValue = std::numeric_limits<float>().lowest();
 
-		// Helper variables.
-		const uint32_t nNumberOfUnassignedAgents = utility::bits::calc_number_of_bits_set_32bit(nUnassignedAgentsMask);
-		const uint32_t nNumberOfPossibleCoalitions = (1 << nNumberOfUnassignedAgents);
-
 		// Try all possible coalitions that can be created with the unassigned agents.
-		for (uint32_t nSkewedCoalitionMask = 0; nSkewedCoalitionMask < nNumberOfPossibleCoalitions; ++nSkewedCoalitionMask)
+		utility::bits::for_each_submask_32bit<ENUMERATION>(nUnassignedAgentsMask, [&](const uint32_t nRealCoalitionMask)
 		{
-			const uint32_t nRealCoalitionMask = utility::bits::calc_parallel_bits_deposit_32bit(nSkewedCoalitionMask, nUnassignedAgentsMask);
-			const uint32_t nCoalitionAgentCount = utility::bits::calc_number_of_bits_set_32bit(nRealCoalitionMask);
+			const uint32_t nCoalitionAgentCount = utility::bits::bit_count_32bit(nRealCoalitionMask);
 
 			for (uint32_t nTaskIndex = 0; nTaskIndex < UnassignedTasks.size(); ++nTaskIndex)
 			{
@@ -71,7 +80,7 @@ instance_solution solver_task_greed::solve(coalitional_values_generator* pProble
 					vBestValue = vNewValue - vPreviousValue;
 				}
 			}
-		}
+		});
 
 		nUnassignedAgentsMask &= (~nBestCoalitionMask);
 
@@ -11,6 +11,12 @@
 class solver_task_greed : public solver
 {
 public:
+	utility::bits::subset_enumeration_t _SubsetEnumeration = utility::bits::subset_enumeration_t::SUBMASK; // How coalitions of the unassigned agents are enumerated.
+
 	instance_solution solve(coalitional_values_generator* pProblem, std::vector<uint32_t> const* coalition_size_bounds);
 	instance_solution solve(coalitional_values_generator* problem) override;
+
+private:
+	template<utility::bits::subset_enumeration_t ENUMERATION>
+	instance_solution solve(coalitional_values_generator* pProblem, std::vector<uint32_t> const* coalition_size_bounds);
 };
\ No newline at end of file
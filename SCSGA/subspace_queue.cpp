@@ -0,0 +1,253 @@
+#include "subspace_queue.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+void subspace_queue::reset(const std::vector<std::vector<uint32_t>>& partitions, const std::vector<float>& partition_upper_bounds,
+	const std::vector<std::vector<float>>& task_upper_bounds, const std::vector<std::vector<float>>& task_lower_bounds)
+{
+	n_tasks = static_cast<uint32_t>(task_upper_bounds.size());
+	n_sizes = n_tasks > 0 ? static_cast<uint32_t>(task_upper_bounds[0].size()) : 0;
+	this->task_upper_bounds = task_upper_bounds;
+	this->task_lower_bounds = task_lower_bounds;
+
+	partition_sizes.clear();
+	for (const std::vector<uint32_t>& partition : partitions)
+	{
+		assert(partition.size() == n_tasks);
+		partition_sizes.insert(partition_sizes.end(), partition.begin(), partition.end());
+	}
+
+	nodes.clear();
+	node_sizes.clear();
+	free_nodes.clear();
+	heap.clear();
+	peak_size = 0;
+	clear_lower_bounds();
+	size_counts.assign(n_sizes, 0);
+	parent_size_counts.assign(n_sizes, 0);
+	parent_sizes.resize(n_tasks);
+
+	for (uint32_t partition{}; partition < partitions.size(); ++partition)
+	{
+		const uint32_t node{ allocate_node() };
+		nodes[node] = { 0.0f, partition, 0 };
+		push_node(node, partition_upper_bounds[partition], count_sizes_left(node), [](const float) { return true; });
+	}
+}
+
+bool subspace_queue::pop(const std::function<bool(const float)>& is_promising, std::vector<uint32_t>& sizes, float& upper_bound, float& lower_bound)
+{
+	while (!heap.empty())
+	{
+		const entry_t best{ heap.front() };
+		if (!is_promising(best.upper_bound))
+		{
+			// All other subspaces have lower bounds.
+			heap.clear();
+			free_nodes.clear();
+			nodes.clear();
+			node_sizes.clear();
+			clear_lower_bounds();
+			return false;
+		}
+		std::pop_heap(heap.begin(), heap.end(), is_worse);
+		heap.pop_back();
+
+		if (nodes[best.node].n_assigned_tasks == n_tasks)
+		{
+			const uint8_t* best_sizes{ node_sizes.data() + static_cast<size_t>(best.node) * n_tasks };
+			sizes.assign(best_sizes, best_sizes + n_tasks);
+			upper_bound = best.upper_bound;
+			lower_bound = best.lower_bound;
+			erase_lower_bound(best.lower_bound);
+			free_nodes.push_back(best.node);
+			return true;
+		}
+		expand(best.node, best.upper_bound, is_promising);
+		free_nodes.push_back(best.node);
+	}
+	return false;
+}
+
+size_t subspace_queue::size() const
+{
+	return heap.size();
+}
+
+size_t subspace_queue::get_peak_size() const
+{
+	return peak_size;
+}
+
+float subspace_queue::get_max_waiting_lower_bound() const
+{
+	return waiting_lower_bounds.empty() ? std::numeric_limits<float>::lowest() : waiting_lower_bounds.front();
+}
+
+bool subspace_queue::is_worse(const entry_t& lhs, const entry_t& rhs)
+{
+	if (lhs.upper_bound != rhs.upper_bound)
+	{
+		return lhs.upper_bound < rhs.upper_bound;
+	}
+	if (lhs.lower_bound != rhs.lower_bound)
+	{
+		return lhs.lower_bound < rhs.lower_bound;
+	}
+	if (lhs.n_assigned_tasks != rhs.n_assigned_tasks)
+	{
+		return lhs.n_assigned_tasks < rhs.n_assigned_tasks;
+	}
+	return lhs.node > rhs.node; // Only to make the order independent of the heap.
+}
+
+uint32_t subspace_queue::allocate_node()
+{
+	if (!free_nodes.empty())
+	{
+		const uint32_t node{ free_nodes.back() };
+		free_nodes.pop_back();
+		return node;
+	}
+	nodes.emplace_back();
+	node_sizes.resize(node_sizes.size() + n_tasks);
+	return static_cast<uint32_t>(nodes.size() - 1);
+}
+
+void subspace_queue::clear_lower_bounds()
+{
+	waiting_lower_bounds.clear();
+	popped_lower_bounds.clear();
+}
+
+void subspace_queue::erase_lower_bound(const float lower_bound)
+{
+	popped_lower_bounds.push_back(lower_bound);
+	std::push_heap(popped_lower_bounds.begin(), popped_lower_bounds.end());
+	// Equal bounds are interchangeable, so a popped one removes any waiting one of the same value.
+	while (!popped_lower_bounds.empty() && popped_lower_bounds.front() == waiting_lower_bounds.front())
+	{
+		std::pop_heap(popped_lower_bounds.begin(), popped_lower_bounds.end());
+		popped_lower_bounds.pop_back();
+		std::pop_heap(waiting_lower_bounds.begin(), waiting_lower_bounds.end());
+		waiting_lower_bounds.pop_back();
+	}
+}
+
+void subspace_queue::push(const uint32_t node, const float upper_bound, const float lower_bound)
+{
+	heap.push_back({ upper_bound, lower_bound, nodes[node].n_assigned_tasks, node });
+	std::push_heap(heap.begin(), heap.end(), is_worse);
+	peak_size = std::max(peak_size, heap.size());
+}
+
+uint32_t subspace_queue::count_sizes_left(const uint32_t node)
+{
+	const node_t& current{ nodes[node] };
+	const uint8_t* sizes{ partition_sizes.data() + static_cast<size_t>(current.partition) * n_tasks };
+	const uint8_t* assigned_sizes{ node_sizes.data() + static_cast<size_t>(node) * n_tasks };
+	std::fill(size_counts.begin(), size_counts.end(), 0);
+	for (uint32_t task{}; task < n_tasks; ++task)
+	{
+		++size_counts[sizes[task]];
+	}
+	for (uint32_t task{}; task < current.n_assigned_tasks; ++task)
+	{
+		--size_counts[assigned_sizes[task]];
+	}
+	return static_cast<uint32_t>(std::count_if(size_counts.begin(), size_counts.end(), [](const uint32_t n_count) { return n_count > 0; }));
+}
+
+void subspace_queue::push_node(const uint32_t node, const float parent_upper_bound, const uint32_t n_distinct_sizes_left, const std::function<bool(const float)>& is_promising)
+{
+	node_t& current{ nodes[node] };
+	uint8_t* sizes{ node_sizes.data() + static_cast<size_t>(node) * n_tasks };
+
+	if (n_distinct_sizes_left <= 1)
+	{
+		// The other tasks can only be assigned one way. The bounds are summed in task order, as the solvers did before.
+		const uint8_t size_left{ static_cast<uint8_t>(std::find_if(size_counts.begin(), size_counts.end(), [](const uint32_t n_count) { return n_count > 0; }) - size_counts.begin()) };
+		std::fill(sizes + current.n_assigned_tasks, sizes + n_tasks, size_left);
+		current.n_assigned_tasks = n_tasks;
+		float upper_bound{ 0.0f }, lower_bound{ 0.0f };
+		for (uint32_t task{}; task < n_tasks; ++task)
+		{
+			upper_bound += task_upper_bounds[task][sizes[task]];
+			lower_bound += task_lower_bounds[task][sizes[task]];
+		}
+		if (!is_promising(upper_bound))
+		{
+			free_nodes.push_back(node);
+			return;
+		}
+		waiting_lower_bounds.push_back(lower_bound);
+		std::push_heap(waiting_lower_bounds.begin(), waiting_lower_bounds.end());
+		push(node, upper_bound, lower_bound);
+		return;
+	}
+
+	// Every other task gets at most the best size left for it, and every size left goes to at most the best task left for it.
+	float task_upper_bound{ current.value };
+	for (uint32_t task{ current.n_assigned_tasks }; task < n_tasks; ++task)
+	{
+		float max_upper_bound{ std::numeric_limits<float>::lowest() };
+		for (uint32_t size{}; size < n_sizes; ++size)
+		{
+			if (size_counts[size] > 0)
+			{
+				max_upper_bound = std::max(max_upper_bound, task_upper_bounds[task][size]);
+			}
+		}
+		task_upper_bound += max_upper_bound;
+	}
+	float size_upper_bound{ current.value };
+	for (uint32_t size{}; size < n_sizes; ++size)
+	{
+		if (size_counts[size] == 0)
+		{
+			continue;
+		}
+		float max_upper_bound{ std::numeric_limits<float>::lowest() };
+		for (uint32_t task{ current.n_assigned_tasks }; task < n_tasks; ++task)
+		{
+			max_upper_bound = std::max(max_upper_bound, task_upper_bounds[task][size]);
+		}
+		size_upper_bound += size_counts[size] * max_upper_bound;
+	}
+	const float upper_bound{ std::min({ task_upper_bound, size_upper_bound, parent_upper_bound }) };
+	if (!is_promising(upper_bound))
+	{
+		free_nodes.push_back(node);
+		return;
+	}
+	push(node, upper_bound, std::numeric_limits<float>::lowest());
+}
+
+void subspace_queue::expand(const uint32_t node, const float upper_bound, const std::function<bool(const float)>& is_promising)
+{
+	// Allocating the children may move the sizes of the node, so those are copied first.
+	const node_t parent{ nodes[node] };
+	std::copy_n(node_sizes.data() + static_cast<size_t>(node) * n_tasks, parent.n_assigned_tasks, parent_sizes.data());
+	count_sizes_left(node);
+	parent_size_counts = size_counts;
+
+	for (uint32_t size{}; size < n_sizes; ++size)
+	{
+		if (parent_size_counts[size] == 0)
+		{
+			continue;
+		}
+		const uint32_t child{ allocate_node() };
+		nodes[child] = { parent.value + task_upper_bounds[parent.n_assigned_tasks][size], parent.partition, parent.n_assigned_tasks + 1 };
+		uint8_t* child_sizes{ node_sizes.data() + static_cast<size_t>(child) * n_tasks };
+		std::copy_n(parent_sizes.data(), parent.n_assigned_tasks, child_sizes);
+		child_sizes[parent.n_assigned_tasks] = static_cast<uint8_t>(size);
+
+		size_counts = parent_size_counts;
+		--size_counts[size];
+		const uint32_t n_distinct_sizes_left{ static_cast<uint32_t>(std::count_if(size_counts.begin(), size_counts.end(), [](const uint32_t n_count) { return n_count > 0; })) };
+		push_node(child, upper_bound, n_distinct_sizes_left, is_promising);
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/*
+	Lazily yields the subspaces searched by the MP solvers best first. A subspace assigns the sizes
+	of an integer partition of the agents to the tasks, and its upper bound is the sum over the tasks
+	t of task_upper_bounds[t][size of t].
+
+	The queue holds partial subspaces, in which only the sizes of the first tasks are assigned. Their
+	bound is the value of the assigned sizes plus the smaller of two sums, which are never below the
+	bound of a subspace they lead to: over the other tasks, of the largest bound of a size left for
+	the task, and over the sizes left, of the largest bound of the size for any other task. Thus the
+	subspaces are popped in order of their upper bound. Ties go to the higher lower bound, the sum
+	over the tasks t of task_lower_bounds[t][size of t]. A partial subspace is expanded on demand,
+	into one child for each distinct size left, and the sizes of all nodes are kept in one flat
+	array whose slots are reused, so that memory grows with the frontier rather than with the
+	number of subspaces.
+*/
+class subspace_queue
+{
+public:
+	// The partitions are zero padded to the number of tasks, and partition_upper_bounds bound all of their subspaces.
+	void reset(const std::vector<std::vector<uint32_t>>& partitions, const std::vector<float>& partition_upper_bounds,
+		const std::vector<std::vector<float>>& task_upper_bounds, const std::vector<std::vector<float>>& task_lower_bounds);
+
+	/*
+		Writes the sizes of the best subspace left and its bounds and returns true. Returns false
+		and drops all subspaces left if there are none or if is_promising is false for the bound of
+		the best one, so is_promising must be false for every bound below one it is false for, and
+		must stay false for a bound once it is. Subspaces expanded meanwhile are only kept if their
+		bound is promising.
+	*/
+	bool pop(const std::function<bool(const float)>& is_promising, std::vector<uint32_t>& sizes, float& upper_bound, float& lower_bound);
+
+	size_t size() const; // The partial and complete subspaces in the queue.
+	size_t get_peak_size() const; // The largest size since reset.
+	float get_max_waiting_lower_bound() const; // The largest lower bound of a complete subspace in the queue, lowest if none.
+
+private:
+	struct node_t
+	{
+		float value; // Of the assigned sizes.
+		uint32_t partition;
+		uint32_t n_assigned_tasks;
+	};
+
+	struct entry_t
+	{
+		float upper_bound;
+		float lower_bound; // Only used to break ties between complete subspaces, lowest for partial ones.
+		uint32_t n_assigned_tasks; // Ties between partial subspaces go to the deepest, which leads to a complete one soonest.
+		uint32_t node;
+	};
+
+	uint32_t n_tasks{};
+	uint32_t n_sizes{};
+	std::vector<uint8_t> partition_sizes; // The sizes of partition p at [p * n_tasks, (p + 1) * n_tasks).
+	std::vector<std::vector<float>> task_upper_bounds;
+	std::vector<std::vector<float>> task_lower_bounds;
+
+	std::vector<node_t> nodes;
+	std::vector<uint8_t> node_sizes; // The assigned sizes of node i at [i * n_tasks, (i + 1) * n_tasks).
+	std::vector<uint32_t> free_nodes;
+	std::vector<entry_t> heap;
+	size_t peak_size{};
+	// Max-heaps of the lower bounds of the complete subspaces pushed and of those popped since. Popped ones are
+	// only removed from the top, so the top of waiting_lower_bounds is always the bound of a subspace in the queue.
+	std::vector<float> waiting_lower_bounds;
+	std::vector<float> popped_lower_bounds;
+
+	std::vector<uint32_t> size_counts; // Of the sizes left in the partition of the node being pushed.
+	std::vector<uint32_t> parent_size_counts; // Of the sizes left in the partition of the node being expanded.
+	std::vector<uint8_t> parent_sizes;
+
+	static bool is_worse(const entry_t& lhs, const entry_t& rhs);
+	uint32_t allocate_node();
+	void clear_lower_bounds();
+	void erase_lower_bound(const float lower_bound);
+	void push(const uint32_t node, const float upper_bound, const float lower_bound);
+	// Counts the sizes of the partition of node that are not assigned yet, and returns how many distinct ones there are.
+	uint32_t count_sizes_left(const uint32_t node);
+	/*
+		Pushes node, whose sizes left are counted, bounded by the bound of its parent, or frees it if
+		its bound is not promising. It is completed first if only one size is left.
+	*/
+	void push_node(const uint32_t node, const float parent_upper_bound, const uint32_t n_distinct_sizes_left, const std::function<bool(const float)>& is_promising);
+	void expand(const uint32_t node, const float upper_bound, const std::function<bool(const float)>& is_promising);
+};
@@ -68,6 +68,65 @@ uint64_t utility::bits::calc_parallel_bits_deposit_64bit(uint64_t n_val, uint64_
 	return n_result;
 }
 
+namespace
+{
+#if defined(__GNUG__)
+	__attribute__((target("bmi2"))) uint32_t hardware_parallel_bits_deposit_32bit(uint32_t n_val, uint32_t n_mask)
+	{
+		return _pdep_u32(n_val, n_mask);
+	}
+
+	__attribute__((target("bmi2"))) uint64_t hardware_parallel_bits_deposit_64bit(uint64_t n_val, uint64_t n_mask)
+	{
+		return _pdep_u64(n_val, n_mask);
+	}
+
+	bool cpu_supports_bmi2()
+	{
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("bmi2");
+	}
+#elif defined(_MSC_VER)
+	uint32_t hardware_parallel_bits_deposit_32bit(uint32_t n_val, uint32_t n_mask)
+	{
+		return _pdep_u32(n_val, n_mask);
+	}
+
+	uint64_t hardware_parallel_bits_deposit_64bit(uint64_t n_val, uint64_t n_mask)
+	{
+		return _pdep_u64(n_val, n_mask);
+	}
+
+	bool cpu_supports_bmi2()
+	{
+		// BMI2 is reported in bit 8 of EBX for CPUID leaf 7, subleaf 0.
+		int cpu_info[4];
+		__cpuid(cpu_info, 0);
+		if (cpu_info[0] < 7)
+		{
+			return false;
+		}
+		__cpuidex(cpu_info, 7, 0);
+		return (cpu_info[1] & (1 << 8)) != 0;
+	}
+#endif
+
+	const bool has_bmi2{ cpu_supports_bmi2() };
+}
+
+uint32_t(* const utility::bits::parallel_bits_deposit_32bit)(uint32_t, uint32_t) {
+	has_bmi2 ? hardware_parallel_bits_deposit_32bit : calc_parallel_bits_deposit_32bit
+};
+
+uint64_t(* const utility::bits::parallel_bits_deposit_64bit)(uint64_t, uint64_t) {
+	has_bmi2 ? hardware_parallel_bits_deposit_64bit : calc_parallel_bits_deposit_64bit
+};
+
+bool utility::bits::has_hardware_parallel_bits_deposit()
+{
+	return has_bmi2;
+}
+
 std::string utility::date_and_time::get_current_time_and_date_as_string()
 {
 	/* Code from https://stackoverflow.com/questions/16357999/current-date-and-time-as-string */
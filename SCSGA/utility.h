@@ -6,6 +6,12 @@
 #include <iostream>
 #include <chrono>
 #include <cmath>
+#include <cstring>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 #include "coalition.h"
 
@@ -81,6 +87,88 @@ namespace utility
 		// *************************************************************************
 		uint64_t calc_parallel_bits_deposit_64bit(uint64_t n_val, uint64_t n_mask);
 
+		// *************************************************************************
+		// PDEP using the BMI2 instruction if the CPU supports it, and otherwise the
+		// software versions above. The implementation is selected once at startup.
+		// *************************************************************************
+		extern uint32_t(* const parallel_bits_deposit_32bit)(uint32_t n_val, uint32_t n_mask);
+		extern uint64_t(* const parallel_bits_deposit_64bit)(uint64_t n_val, uint64_t n_mask);
+		bool has_hardware_parallel_bits_deposit();
+
+		// Ways of enumerating all subsets (submasks) of a mask.
+		enum class subset_enumeration_t
+		{
+			SOFTWARE_PDEP,	// Deposit 0, 1, ..., 2^k - 1 into the mask with calc_parallel_bits_deposit_32bit.
+			PDEP,			// As above, but with parallel_bits_deposit_32bit.
+			SUBMASK			// Step directly from one submask to the next, without PDEP.
+		};
+
+		// Calls visitor(n_submask) for every submask of n_mask in increasing order, starting
+		// with 0. All enumerations visit the submasks in the same order. The PDEP enumerations
+		// require that fewer than 32 bits are set in n_mask.
+		template<subset_enumeration_t ENUMERATION, typename Visitor>
+		inline void for_each_submask_32bit(const uint32_t n_mask, Visitor&& visitor)
+		{
+			if constexpr (ENUMERATION == subset_enumeration_t::SUBMASK)
+			{
+				// (s - mask) & mask borrows through the bits outside the mask, which yields the next
+				// larger submask. It wraps around to 0 after the mask itself.
+				uint32_t n_submask = 0U;
+				do
+				{
+					visitor(n_submask);
+					n_submask = (n_submask - n_mask) & n_mask;
+				} while (n_submask != 0U);
+			}
+			else
+			{
+				const uint32_t n_number_of_submasks = 1U << bit_count_32bit(n_mask);
+				for (uint32_t n_skewed_submask = 0U; n_skewed_submask < n_number_of_submasks; ++n_skewed_submask)
+				{
+					if constexpr (ENUMERATION == subset_enumeration_t::PDEP)
+					{
+						visitor(parallel_bits_deposit_32bit(n_skewed_submask, n_mask));
+					}
+					else
+					{
+						visitor(calc_parallel_bits_deposit_32bit(n_skewed_submask, n_mask));
+					}
+				}
+			}
+		}
+
+		// Calls visitor(n_submask) for every submask of n_mask with exactly n_size bits set, in increasing
+		// order, until visitor returns false. Gosper's hack steps through the n_size-subsets of the low
+		// bit_count(n_mask) bits and PDEP spreads each of them onto the bits of n_mask, so the cost grows
+		// as C(bit_count(n_mask), n_size). Returns false if the visitor stopped the enumeration.
+		template<typename Visitor>
+		inline bool for_each_submask_of_size_32bit(const uint32_t n_mask, const uint32_t n_size, Visitor&& visitor)
+		{
+			const uint32_t n_bits = bit_count_32bit(n_mask);
+			if (n_size > n_bits)
+			{
+				return true;
+			}
+			if (n_size == 0U)
+			{
+				return visitor(0U);
+			}
+			const uint64_t n_end = 1ULL << n_bits;
+			uint64_t n_packed_submask = (1ULL << n_size) - 1ULL;
+			while (n_packed_submask < n_end)
+			{
+				if (!visitor(parallel_bits_deposit_32bit(uint32_t(n_packed_submask), n_mask)))
+				{
+					return false;
+				}
+				// Gosper's hack: the next larger integer with the same number of bits set.
+				const uint64_t n_lowest_bit = n_packed_submask & (~n_packed_submask + 1ULL);
+				const uint64_t n_ripple = n_packed_submask + n_lowest_bit;
+				n_packed_submask = (((n_ripple ^ n_packed_submask) >> 2ULL) / n_lowest_bit) | n_ripple;
+			}
+			return true;
+		}
+
 		// A simple wrapper for a 64bit mask.
 		struct SMask
 		{
@@ -90,6 +178,206 @@ namespace utility
 		};
 	}
 
+	namespace random
+	{
+		// SplitMix64 step (Steele, Lea & Flood 2014). Maps n_state to a well-mixed 64-bit value,
+		// which makes it suitable for deriving independent seeds from structured keys.
+		inline uint64_t splitmix64(uint64_t n_state)
+		{
+			n_state += 0x9E3779B97F4A7C15ULL;
+			n_state = (n_state ^ (n_state >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			n_state = (n_state ^ (n_state >> 27)) * 0x94D049BB133111EBULL;
+			return n_state ^ (n_state >> 31);
+		}
+
+		// The n_counter:th output of the SplitMix64 sequence seeded with n_key, computed directly
+		// from its coordinates. Used as a counter-based generator, where every draw is a pure
+		// function of (key, counter) and draws can hence be made in any order or in parallel.
+		inline uint64_t splitmix64(const uint64_t n_key, const uint64_t n_counter)
+		{
+			return splitmix64(n_key + n_counter * 0x9E3779B97F4A7C15ULL);
+		}
+
+		// Maps the upper 24 bits of n_bits to a float uniformly distributed in [0, 1). They are converted
+		// as a signed 32-bit integer, which is exact and, unlike an unsigned 64-bit one, vectorizes.
+		inline float to_unit_float(const uint64_t n_bits)
+		{
+			return static_cast<float>(static_cast<int32_t>(n_bits >> 40)) * 0x1.0p-24f;
+		}
+
+		// The natural logarithm of a positive normal float, to about one ulp (the single precision
+		// polynomial of Cephes). Branch-free and without calls, so that loops over it vectorize.
+		inline float approximate_log(const float v_value)
+		{
+			uint32_t n_bits;
+			std::memcpy(&n_bits, &v_value, sizeof(n_bits));
+			// v_value = m * 2^e with m in (sqrt(1/2), sqrt(2)], split in integers, as selects of floats
+			// become branches that keep the loops from vectorizing.
+			const uint32_t n_fraction_bits{ n_bits & 0x007FFFFFU };
+			const bool b_is_large{ n_fraction_bits > 0x003504F3U }; // The fraction of sqrt(2).
+			const uint32_t n_mantissa_bits{ n_fraction_bits | (b_is_large ? 0x3F000000U : 0x3F800000U) };
+			float m;
+			std::memcpy(&m, &n_mantissa_bits, sizeof(m));
+			const float e{ static_cast<float>(static_cast<int32_t>(n_bits >> 23) - 127 + (b_is_large ? 1 : 0)) };
+			const float x{ m - 1.0f };
+			const float z{ x * x };
+			float y{ 7.0376836292e-2f };
+			y = y * x - 1.1514610310e-1f;
+			y = y * x + 1.1676998740e-1f;
+			y = y * x - 1.2420140846e-1f;
+			y = y * x + 1.4249322787e-1f;
+			y = y * x - 1.6668057665e-1f;
+			y = y * x + 2.0000714765e-1f;
+			y = y * x - 2.4999993993e-1f;
+			y = y * x + 3.3333331174e-1f;
+			y = y * x * z - 2.12194440e-4f * e - 0.5f * z;
+			return x + y + 0.693359375f * e;
+		}
+
+		// cos(2 pi v_turns) for v_turns in [-1/2, 1/2], to about 1e-7, branch-free like approximate_log.
+		inline float approximate_cos_of_turns(const float v_turns)
+		{
+			// cos(2 pi t) = sin(2 pi (1/4 - |t|)), whose argument is in [-pi/2, pi/2].
+			const float x{ 6.28318530718f * (0.25f - std::fabs(v_turns)) };
+			const float z{ x * x };
+			float y{ -2.50521084e-8f };
+			y = y * z + 2.75573192e-6f;
+			y = y * z - 1.98412698e-4f;
+			y = y * z + 8.33333333e-3f;
+			y = y * z - 1.66666667e-1f;
+			return x + x * z * y;
+		}
+
+		// Maps two sets of random bits to a standard normally distributed float (Box-Muller).
+		inline float to_standard_normal(const uint64_t n_bits_1, const uint64_t n_bits_2)
+		{
+			const float u1{ static_cast<float>(static_cast<int32_t>(n_bits_1 >> 40) + 1) * 0x1.0p-24f }; // (0, 1], so that the log is finite.
+			// The angle of a uniform float in [0, 1) turns, moved to [-1/2, 1/2) in integers, where it is exact.
+			const int32_t n_turns{ static_cast<int32_t>(n_bits_2 >> 40) };
+			const float v_turns{ static_cast<float>(n_turns - ((n_turns >> 23) << 24)) * 0x1.0p-24f };
+			return std::sqrt(-2.0f * approximate_log(u1)) * approximate_cos_of_turns(v_turns);
+		}
+	}
+
+	namespace parallel
+	{
+		// The number of threads to use when n_threads are requested, where 0 requests one per hardware thread.
+		inline uint32_t get_n_threads(const uint32_t n_threads)
+		{
+			return n_threads > 0 ? n_threads : std::max(1U, std::thread::hardware_concurrency());
+		}
+
+		// Calls function(n_item, n_worker) for every item in [0, n_items) on n_threads threads (0 for one
+		// per hardware thread), handing out items one at a time as threads become free. n_worker is in
+		// [0, get_n_threads(n_threads)) and identifies the calling thread, e.g. to index buffers of each
+		// thread. The calling thread takes part as worker 0. The first exception thrown by function is
+		// rethrown once all threads are done.
+		template<typename Function>
+		void for_each_index_of_worker(const uint64_t n_items, const uint32_t n_threads, Function&& function)
+		{
+			const uint64_t n_workers{ std::min<uint64_t>(get_n_threads(n_threads), n_items) };
+			std::atomic<uint64_t> n_next_item{ 0 };
+			std::exception_ptr exception{};
+			std::atomic_flag has_exception = ATOMIC_FLAG_INIT;
+
+			const auto work = [&](const uint32_t n_worker)
+			{
+				try
+				{
+					for (uint64_t n_item{ n_next_item++ }; n_item < n_items; n_item = n_next_item++)
+					{
+						function(n_item, n_worker);
+					}
+				}
+				catch (...)
+				{
+					if (!has_exception.test_and_set())
+					{
+						exception = std::current_exception();
+					}
+					n_next_item = n_items;
+				}
+			};
+
+			std::vector<std::thread> workers;
+			for (uint64_t n_worker{ 1 }; n_worker < n_workers; ++n_worker)
+			{
+				workers.emplace_back(work, static_cast<uint32_t>(n_worker));
+			}
+			work(0);
+			for (std::thread& worker : workers)
+			{
+				worker.join();
+			}
+			if (exception)
+			{
+				std::rethrow_exception(exception);
+			}
+		}
+
+		// As for_each_index_of_worker, but calls function(n_item).
+		template<typename Function>
+		void for_each_index(const uint64_t n_items, const uint32_t n_threads, Function&& function)
+		{
+			for_each_index_of_worker(n_items, n_threads, [&](const uint64_t n_item, const uint32_t) { function(n_item); });
+		}
+
+		/*
+			Lets a reader thread run at most n_lookahead items ahead of the items finished by the
+			workers, e.g. to read the data of the next items from disk while the current ones are
+			computed.
+		*/
+		class lookahead_gate
+		{
+		public:
+			explicit lookahead_gate(const uint64_t n_lookahead)
+				: n_lookahead{ n_lookahead }
+			{
+			}
+
+			// Called by a worker when it has finished an item.
+			void finish_item()
+			{
+				{
+					std::lock_guard<std::mutex> lock{ mutex };
+					++n_finished;
+				}
+				condition.notify_all();
+			}
+
+			// Called by the reader before it starts on item n_item. Returns false once the gate is closed.
+			bool wait_for_item(const uint64_t n_item)
+			{
+				std::unique_lock<std::mutex> lock{ mutex };
+				condition.wait(lock, [&]() { return is_closed || n_item < n_finished + n_lookahead; });
+				return !is_closed;
+			}
+
+			uint64_t get_n_finished()
+			{
+				std::lock_guard<std::mutex> lock{ mutex };
+				return n_finished;
+			}
+
+			// Releases the reader, whose next wait_for_item returns false.
+			void close()
+			{
+				{
+					std::lock_guard<std::mutex> lock{ mutex };
+					is_closed = true;
+				}
+				condition.notify_all();
+			}
+
+		private:
+			const uint64_t n_lookahead;
+			uint64_t n_finished{};
+			bool is_closed{ false };
+			std::mutex mutex;
+			std::condition_variable condition;
+		};
+	}
+
 	namespace statistics
 	{
 		double calc_mean(const std::vector<float>& values);